@@ -2,7 +2,17 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <fstream>
+#include <chrono>
 #include <unistd.h>
+#include "OccupancyHeatmap.h"
+#include "FreeTimeFinder.h"
+#include "MemoryReport.h"
+#include "Stats.h"
+#include "TimetableBuilder.h"
+#include "Rebalancer.h"
+#include "IntegrityChecker.h"
+#include <sstream>
 
 using namespace std;
 
@@ -32,13 +42,14 @@ int App::optionsMenu() const {
                     << "6 Submit a request" << endl
                     << "7 Print pending requests" << endl
                     << "8 Process requests" << endl
-                    << "9 Exit" << endl << "\n"
+                    << "9 Tools" << endl
+                    << "10 Exit" << endl << "\n"
                     << "What would you like to do next? " ;
     cin >> option; cout << endl;
     if (cin.fail()) {
         throw invalid_argument(">> Invalid number");
     }
-    while(option < 1 || option > 9) {
+    while(option < 1 || option > 10) {
         cout << ">> Please choose a valid option: "; cin >> option; cout << endl;
     }
     return option;
@@ -51,6 +62,7 @@ int App::optionsMenu() const {
 int App::run() {
     system("clear");
     manager.readFiles();
+    persister.reset(new Persister(manager.getDataDir() + "students_classes.csv"));
 
     while (true) {
         system("clear");
@@ -97,6 +109,13 @@ int App::run() {
                 break;
             }
             case 9: {
+                int i = toolsMenu();
+                if(i != 10) {
+                    runTool(i);
+                }
+                break;
+            }
+            case 10: {
                 saveInformation();
                 return 0;
             }
@@ -117,6 +136,7 @@ void App::checkStudentSchedule() const {
     string upNumber;
     cout << "Please insert the student's UP number: ";
     cin >> upNumber;
+    system("clear");
     manager.printStudentSchedule(upNumber);
 }
 /**
@@ -128,6 +148,7 @@ void App::checkStudentSchedule() const {
 void App::checkClassSchedule() const{
     string classCode;
     cout << "Please insert the class code: "; cin >>classCode; cout<<endl;
+    system("clear");
     manager.printClassSchedule(classCode);
 }
 
@@ -162,7 +183,8 @@ void App::checkClassStudents() const {
     cout << "Please insert the class code: ";
     cin >> classCode;
     cout << endl;
-    UcClass ucClass = UcClass(ucCode, classCode);
+    system("clear");
+    UcClass ucClass = UcClass::lookup(ucCode, classCode);
     switch (option) {
         case 1:
             manager.printClassStudents(ucClass, "alphabetical");
@@ -190,6 +212,7 @@ void App::checkClassStudents() const {
 void App::checkUcSchedule() const {
     string ucCode;
     cout << "Insert the uc code: "; cin >> ucCode; cout << endl;
+    system("clear");
     manager.printUcSchedule(ucCode);
 }
 
@@ -216,6 +239,273 @@ int App::requestsMenu() const {
     return option;
 }
 
+/**
+ * @brief Asks the user to choose one of the tools
+ * @details Time complexity: O(1)
+ * @return the option chosen by the user, the last one goes back to the main menu
+ */
+int App::toolsMenu() const {
+    system("clear");
+    int option;
+    cout << "1 - Occupancy heatmap" << endl;
+    cout << "2 - Statistics" << endl;
+    cout << "3 - Import enrollment changes" << endl;
+    cout << "4 - Build a timetable" << endl;
+    cout << "5 - Rebalance classes" << endl;
+    cout << "6 - Check integrity" << endl;
+    cout << "7 - Classes in session" << endl;
+    cout << "8 - Common free time" << endl;
+    cout << "9 - Memory usage" << endl;
+    cout << "10 - Go back" << endl;
+    cout << "Which tool do you want to use? ";
+    cin >> option;
+    if (cin.fail()) {
+        throw invalid_argument(">> Invalid number");
+    }
+    while(option < 1 || option > 10) {
+        cout << ">> Please choose a valid option: "; cin >> option; cout << endl;
+    }
+    return option;
+}
+
+/**
+ * @brief Runs the tool chosen in the tools menu
+ * @param option option chosen in toolsMenu()
+ */
+void App::runTool(int option) {
+    switch (option) {
+        case 1:
+            occupancyHeatmap();
+            break;
+        case 2:
+            system("clear");
+            Stats::print();
+            break;
+        case 3:
+            importDelta();
+            break;
+        case 4:
+            buildTimetable();
+            break;
+        case 5:
+            rebalanceClasses();
+            break;
+        case 6:
+            checkIntegrity();
+            break;
+        case 7:
+            classesInSession();
+            break;
+        case 8:
+            commonFreeTime();
+            break;
+        case 9:
+            memoryUsage();
+            break;
+        default:
+            cout << ">> Invalid option." << endl;
+    }
+    waitForInput();
+}
+
+/**
+ * @brief Computes the occupancy heatmap of all the classes, prints the peaks and optionally exports it as CSV
+ * @details Time complexity: O(n*l*b) + O(k*c) @see OccupancyHeatmap::compute()
+ */
+void App::occupancyHeatmap() const {
+    string s;
+    cout << endl << "Do you want to include theoretical (T) classes? (y/n) "; cin >> s; cout << endl;
+    OccupancyHeatmap heatmap(s == "y" || s == "Y");
+    auto start = chrono::steady_clock::now();
+    heatmap.compute(manager.getSchedules());
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    heatmap.printPeaks();
+    cout << ">> Computed in " << ms << " ms" << endl << endl;
+    cout << "Insert the path of the CSV file to export it (or n to skip): "; cin >> s;
+    if (s == "n" || s == "N") return;
+    ofstream file(s);
+    if (!file) {
+        cout << ">> Could not open " << s << endl;
+        return;
+    }
+    heatmap.writeCsv(file);
+    cout << ">> Heatmap exported to " << s << endl;
+}
+
+/**
+ * @brief Asks the path of a file of enrollment changes (students_classes.csv format) and applies it
+ * @details Rows whose StudentCode starts with '-' are removals. Time complexity: @see ScheduleManager::applyDelta()
+ */
+void App::importDelta() {
+    string path;
+    cout << endl << "Insert the path of the file with the enrollment changes: "; cin >> path; cout << endl;
+    auto start = chrono::steady_clock::now();
+    if (!manager.applyDelta(path)) return;
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << ">> Applied in " << ms << " ms" << endl;
+    saveInBackground();
+}
+
+/**
+ * @brief Asks a student and the UCs he wants, prints the best timetables without collisions and optionally
+ * submits the requests of one of them
+ * @details A changing request is submitted for each UC the student is already enrolled in (if the class is
+ * different) and an enrollment request for each other UC. Time complexity: @see TimetableBuilder::build()
+ */
+void App::buildTimetable() {
+    string upNumber, line, ucCode;
+    cout << endl << "Please insert the student's UP number: "; cin >> upNumber;
+    Student *student = manager.findStudent(upNumber);
+    if (student == nullptr) {
+        cout << ">> Student not found." << endl;
+        return;
+    }
+    cout << "Please insert the codes of the desired ucs, separated by spaces: ";
+    cin >> ws;
+    getline(cin, line);
+    cout << endl;
+    vector<string> ucIds;
+    istringstream codes(line);
+    while (codes >> ucCode) ucIds.push_back(ucCode);
+    TimetableBuilder builder(manager);
+    auto start = chrono::steady_clock::now();
+    if (!builder.build(*student, ucIds)) return;
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    builder.printResults();
+    cout << ">> Computed in " << ms << " ms" << endl;
+    const vector<TimetableBuilder::Timetable> &results = builder.getResults();
+    if (results.empty()) return;
+    cout << endl << "Insert the number of the timetable to request (or n to skip): "; cin >> line;
+    size_t chosen = 0;
+    for (size_t i = 1; i <= results.size(); i++) if (line == to_string(i)) chosen = i;
+    if (chosen == 0) return;
+    for (const UcClass &ucClass : results[chosen - 1].classes) {
+        if (!student->isEnrolled(ucClass.getUcId())) manager.addEnrollmentRequest(*student, ucClass);
+        else if (!(student->findUcClass(ucClass.getUcId()) == ucClass)) manager.addChangingRequest(*student, ucClass);
+    }
+    cout << ">> Requests submitted successfully." << endl;
+}
+
+/**
+ * @brief Plans the moves that even out the classes of a uc (or of every uc), prints the plan and optionally applies it
+ * in a checkpoint
+ * @details Time complexity: @see Rebalancer::plan() and Rebalancer::apply()
+ */
+void App::rebalanceClasses() {
+    string ucCode, s;
+    cout << endl << "Please insert the uc code (or all): "; cin >> ucCode; cout << endl;
+    vector<string> ucIds;
+    if (ucCode != "all") {
+        if (manager.schedulesOfUc(ucCode).empty()) {
+            cout << ">> Uc not found." << endl;
+            return;
+        }
+        ucIds.push_back(ucCode);
+    }
+    Rebalancer rebalancer(manager);
+    auto start = chrono::steady_clock::now();
+    rebalancer.plan(ucIds);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    rebalancer.printPlan(cout, ucCode != "all");
+    cout << ">> Planned in " << ms << " ms" << endl;
+    if (rebalancer.getMoves().empty()) return;
+    cout << endl << "Do you want to apply these moves? (y/n) "; cin >> s;
+    if (s != "y" && s != "Y") return;
+    manager.beginCheckpoint();
+    rebalancer.apply(manager);
+    cout << endl << "Do you want to keep these changes? (y/n) "; cin >> s; cout << endl;
+    if (s == "y" || s == "Y") {
+        manager.commitCheckpoint();
+        cout << ">> Changes kept." << endl;
+        saveInBackground();
+    }
+    else {
+        size_t changes = manager.getNumberOfCheckpointChanges();
+        manager.rollbackCheckpoint();
+        cout << ">> Changes rolled back (" << changes << " changes undone)." << endl;
+    }
+}
+
+/**
+ * @brief Cross-checks the classes of the students against the students of the classes and prints the divergences
+ * @details Time complexity: @see IntegrityChecker::check()
+ */
+void App::checkIntegrity() const {
+    IntegrityChecker checker(manager);
+    auto start = chrono::steady_clock::now();
+    checker.check();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    checker.printReport();
+    cout << ">> Checked in " << ms << " ms" << endl;
+}
+
+/**
+ * @brief Asks for a weekday and a time (or a period) and prints the classes in session then, optionally with their
+ * students
+ * @details Time complexity: @see ScheduleManager::printClassesInSession()
+ */
+void App::classesInSession() const {
+    string weekDay, line, type, s;
+    cout << endl << "Please insert the weekday (e.g. Tuesday): "; cin >> weekDay;
+    cout << "Please insert the time (e.g. 14:30) or the period (e.g. 14:00 16:00): ";
+    cin >> ws;
+    getline(cin, line);
+    istringstream times(line);
+    string startText, endText;
+    times >> startText >> endText;
+    float start = SessionIndex::parseTime(startText), end = endText.empty() ? -1 : SessionIndex::parseTime(endText);
+    if (start < 0 || (!endText.empty() && end <= start)) {
+        cout << ">> Invalid time." << endl;
+        return;
+    }
+    cout << "Please insert the type of the classes (T, TP, PL or all): "; cin >> type;
+    if (type == "all" || type == "ALL") type.clear();
+    cout << "List the students? (y/n) "; cin >> s;
+    auto begin = chrono::steady_clock::now();
+    manager.printClassesInSession(weekDay, start, end, type, s == "y" || s == "Y");
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    cout << ">> Computed in " << ms << " ms" << endl;
+}
+
+/**
+ * @brief Asks for a group of students (or a class) and prints the periods of the week in which all of them are free
+ * @details Time complexity: @see FreeTimeFinder::find()
+ */
+void App::commonFreeTime() const {
+    string line, token;
+    cout << endl << "Please insert the UP numbers separated by spaces (or the uc code and class code of a class): ";
+    cin >> ws;
+    getline(cin, line);
+    vector<string> tokens;
+    istringstream words(line);
+    while (words >> token) tokens.push_back(token);
+    FreeTimeFinder finder(manager);
+    auto start = chrono::steady_clock::now();
+    if (tokens.size() == 2 && manager.findSchedule(UcClass::lookup(tokens[0], tokens[1])) != nullptr) {
+        finder.findForClass(UcClass::lookup(tokens[0], tokens[1]));
+    } else {
+        finder.find(tokens);
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << endl;
+    finder.printWindows();
+    cout << ">> Computed in " << ms << " ms (Monday to Friday, 08:00 to 20:00, at least 1 hour)" << endl;
+}
+
+/**
+ * @brief Prints the memory taken by each structure of the schedules and students
+ * @details Time complexity: @see ScheduleManager::accountMemory()
+ */
+void App::memoryUsage() const {
+    system("clear");
+    MemoryReport report;
+    auto start = chrono::steady_clock::now();
+    manager.accountMemory(report);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    report.print();
+    cout << ">> Computed in " << ms << " ms" << endl;
+}
+
 /**
  * @brief Asks the user to insert the class code he wants to change into
  * @details Time complexity: O(log n) where n is the number of schedules(lines file classes_per_uc.csv)
@@ -233,7 +523,7 @@ void App::submitChangingRequest(Student* student) {
     }
     cout << "Please insert the class code: ";
     cin >> classCode;
-    ClassSchedule *cs = manager.findSchedule(UcClass(ucCode, classCode));
+    ClassSchedule *cs = manager.findSchedule(UcClass::lookup(ucCode, classCode));
     if (cs == nullptr) {
         cout << ">> Class not found." << endl;
         waitForInput();
@@ -260,7 +550,7 @@ void App::submitEnrollmentRequest(Student *student) {
     }
     cout << "Please insert the class code: ";
     cin >> classCode;
-    ClassSchedule *cs = manager.findSchedule(UcClass(ucCode, classCode));
+    ClassSchedule *cs = manager.findSchedule(UcClass::lookup(ucCode, classCode));
     if (cs == nullptr) {
         cout << ">> Class not found." << endl;
         waitForInput();
@@ -285,7 +575,7 @@ void App::submitRemovalRequest(Student *student) {
         waitForInput();
         return;
     }
-    for(UcClass &i : student->getClasses()){
+    for(const UcClass &i : student->getClasses()){
         if(i.getUcId() == ucCode){
             manager.addRemovalRequest(*student, i);
             cout << ">> Request submitted successfully." << endl;
@@ -335,6 +625,7 @@ void App::checkUcStudents() const{
     int option = sortingMenu();
     string ucCode;
     cout << "Please insert the uc code: "; cin >> ucCode;
+    system("clear");
     switch (option) {
         case 1:
             manager.printUcStudents(ucCode, "alphabetical");
@@ -354,7 +645,9 @@ void App::checkUcStudents() const{
 }
 /**
  * @brief Function that processes all pending changingRequests
- * @details Time complexity: Time complexity: O(h) + O(log n * log n) + O(log p) + O(t*log n + t*lr) + O(nlog n) where n is the number of schedules (lines in the classes_per_uc.csv file),
+ * @details The batch can be simulated first, then it is applied in a checkpoint and the user chooses to keep it or to
+ * roll it back.\n
+ * Time complexity: Time complexity: O(h) + O(log n * log n) + O(log p) + O(t*log n + t*lr) + O(nlog n) where n is the number of schedules (lines in the classes_per_uc.csv file),
  * p is the number of lines in the students.csv file, h is the number of classes of the student submitting the request,
  * t is the number of classes the student is enrolled in, n is the number of lines in classes_per_uc.csv, l is the number of slots of the first class
  */
@@ -367,18 +660,65 @@ void App::processPendingRequests() {
     string s;
     cout << "Do you want to see all pending changingRequests first? (y/n) "; cin >> s; cout << endl;
     if(s == "y" || s == "Y"){
+        system("clear");
         manager.printPendingRequests();
         waitForInput();
     }
+    cout << "Do you want to simulate them first (nothing is changed)? (y/n) "; cin >> s; cout << endl;
+    if(s == "y" || s == "Y"){
+        manager.simulateRequests();
+        cout << endl << "Do you want to process them now? (y/n) "; cin >> s; cout << endl;
+        if(s != "y" && s != "Y"){
+            cout << ">> The requests are still pending." << endl;
+            waitForInput();
+            return;
+        }
+    }
+    manager.beginCheckpoint();
     manager.processRequests();
+    IntegrityChecker checker(manager);
+    if(checker.check() > 0) checker.printReport();
+    cout << endl << "Do you want to keep these changes? (y/n) "; cin >> s; cout << endl;
+    if(s == "y" || s == "Y"){
+        manager.commitCheckpoint();
+        cout << ">> Changes kept." << endl;
+        saveInBackground();
+    }
+    else{
+        size_t changes = manager.getNumberOfCheckpointChanges();
+        manager.rollbackCheckpoint();
+        cout << ">> Changes rolled back (" << changes << " changes undone), the requests are pending again." << endl;
+        cout << "Do you want to discard the pending requests? (y/n) "; cin >> s; cout << endl;
+        if(s == "y" || s == "Y"){
+            manager.clearPendingRequests();
+            cout << ">> Pending requests discarded." << endl;
+        }
+    }
+    waitForInput();
 }
 
 /**
  * @brief Function that writes the information to the files before closing the program
- * @details Time complexity: O(O(st) where s is the number of students in the set and t is the number of classes of each student)
+ * @details The last state is handed to the Persister and this waits until it is on disk (durable flush).\n
+ * Time complexity: O(O(st) where s is the number of students in the set and t is the number of classes of each student)
  */
 void App::saveInformation() {
-    manager.writeFiles();
+    if (!persister) return;
+    saveInBackground();
+    if (!persister->flush()) cout << ">> Could not save " << persister->getPath() << ", the previous file was kept." << endl;
+}
+
+/**
+ * @brief Hands a copy of the students to the Persister, which saves it in the background
+ * @details The students are copied as columns (@see EnrollmentColumns), which are smaller and quicker to build than
+ * a copy of the set; the set is only copied when they can't be built. The files are written by the Persister thread.\n
+ * Time complexity: O(st) where s is the number of students and t the number of classes of each student
+ */
+void App::saveInBackground() {
+    if (!persister) return;
+    shared_ptr<EnrollmentColumns> columns = make_shared<EnrollmentColumns>();
+    if (columns->build(manager.getStudents())) persister->save(shared_ptr<const EnrollmentColumns>(move(columns)));
+    else persister->save(make_shared<const StudentSet>(manager.getStudents()));
 }
 
 /**
@@ -404,6 +744,7 @@ void App::printPendingRequests() const {
         waitForInput();
         return;
     }
+    system("clear");
     manager.printPendingRequests();
     waitForInput();
 }
\ No newline at end of file
@@ -1,7 +1,9 @@
 #ifndef TRABALHO_APP_H
 #define TRABALHO_APP_H
 
+#include <memory>
 #include "ScheduleManager.h"
+#include "Persister.h"
 /**
  * @brief Class to run the program.
  */
@@ -15,6 +17,7 @@ class App {
         int optionsMenu() const;
         int requestsMenu() const;
         int sortingMenu() const;
+        int toolsMenu() const;
 
         void checkStudentSchedule() const;
         void checkClassSchedule() const;
@@ -29,13 +32,26 @@ class App {
         void processPendingRequests();
         void printPendingRequests() const;
 
+        void runTool(int option);
+        void occupancyHeatmap() const;
+        void importDelta();
+        void buildTimetable();
+        void rebalanceClasses();
+        void checkIntegrity() const;
+        void classesInSession() const;
+        void commonFreeTime() const;
+        void memoryUsage() const;
+
         void saveInformation();
+        void saveInBackground();
 
     private:
         /** @brief ScheduleManager object that stores all students, schedules and requests */
         ScheduleManager manager;
         /** @brief Variable that stores the suspend execution time in microseconds */
         int sleepTime;
+        /** @brief Saves the students in the background after each batch of changes kept */
+        unique_ptr<Persister> persister;
 };
 
 
@@ -0,0 +1,98 @@
+#include "Arena.h"
+#include <sys/mman.h>
+
+using namespace std;
+
+/** @brief True while the current thread has an Arena::Scope open */
+static thread_local bool arenaActive = false;
+
+/**
+ * @brief Opens a scope, the allocations made by ArenaAllocator in this thread go to the arena
+ * @details Time complexity: O(1)
+ */
+Arena::Scope::Scope() {
+    previous = arenaActive;
+    arenaActive = true;
+}
+
+/**
+ * @brief Closes the scope, restoring the previous state of the thread
+ * @details Time complexity: O(1)
+ */
+Arena::Scope::~Scope() {
+    arenaActive = previous;
+}
+
+/**
+ * @brief Constructor, reserves the range of virtual memory (nothing is committed yet)
+ * @details Time complexity: O(1)
+ */
+Arena::Arena() {
+    this->capacity = sizeof(void*) == 8 ? (size_t(1) << 34) : (size_t(1) << 28);
+    this->used = 0;
+    void *memory = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    this->base = memory == MAP_FAILED ? nullptr : static_cast<char*>(memory);
+    if (base == nullptr) this->capacity = 0;
+}
+
+/**
+ * @brief Returns the arena of the process
+ * @details It is never destroyed, so memory allocated from it is valid until the process exits.\n
+ * Time complexity: O(1)
+ */
+Arena &Arena::instance() {
+    static Arena *arena = new Arena();
+    return *arena;
+}
+
+/**
+ * @brief Allocates memory from the arena
+ * @details Time complexity: O(1)
+ * @param bytes size of the block
+ * @param alignment alignment of the block (a power of two)
+ * @return the block, nullptr if the arena is full (the caller then uses the heap)
+ */
+void *Arena::allocate(size_t bytes, size_t alignment) {
+    size_t size = (bytes + alignment - 1) & ~(alignment - 1);
+    if (alignment > alignof(max_align_t)) size += alignment;
+    size = (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    size_t offset = used.fetch_add(size, memory_order_relaxed);
+    if (offset + size > capacity) return nullptr;
+    size_t address = reinterpret_cast<size_t>(base + offset);
+    address = (address + alignment - 1) & ~(alignment - 1);
+    return reinterpret_cast<void*>(address);
+}
+
+/**
+ * @brief Checks if a pointer was allocated from the arena
+ * @details Time complexity: O(1)
+ */
+bool Arena::owns(const void *pointer) const {
+    const char *p = static_cast<const char*>(pointer);
+    return base != nullptr && p >= base && p < base + capacity;
+}
+
+/**
+ * @brief Returns the number of bytes handed out
+ * @details Time complexity: O(1)
+ */
+size_t Arena::getUsed() const {
+    size_t bytes = used.load(memory_order_relaxed);
+    return bytes < capacity ? bytes : capacity;
+}
+
+/**
+ * @brief Returns the size of the reserved range
+ * @details Time complexity: O(1)
+ */
+size_t Arena::getCapacity() const {
+    return capacity;
+}
+
+/**
+ * @brief Returns true if the current thread has an Arena::Scope open
+ * @details Time complexity: O(1)
+ */
+bool Arena::active() {
+    return arenaActive;
+}
@@ -0,0 +1,83 @@
+#ifndef TRABALHO_ARENA_H
+#define TRABALHO_ARENA_H
+
+#include <cstddef>
+#include <atomic>
+#include <new>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * @brief Monotonic (bump pointer) arena for the data created while the files are read.
+ * @details A large range of virtual memory is reserved once and pages are only committed when touched.
+ * Allocating is a single atomic addition and freeing does nothing, the memory is given back to the system
+ * when the process exits. The arena is only used by the threads that hold an Arena::Scope.
+ */
+class Arena {
+    public:
+        /**
+         * @brief While an object of this class exists, ArenaAllocator allocates from the arena in the current thread
+         */
+        class Scope {
+            public:
+                Scope();
+                ~Scope();
+                Scope(const Scope &other) = delete;
+                Scope &operator = (const Scope &other) = delete;
+            private:
+                /** @brief Value of the flag before the scope was opened */
+                bool previous;
+        };
+
+        static Arena &instance();
+
+        void *allocate(size_t bytes, size_t alignment);
+        bool owns(const void *pointer) const;
+        size_t getUsed() const;
+        size_t getCapacity() const;
+        static bool active();
+
+    private:
+        Arena();
+
+        /** @brief Start of the reserved range, nullptr if it could not be reserved */
+        char *base;
+        /** @brief Size of the reserved range */
+        size_t capacity;
+        /** @brief Bytes already handed out */
+        atomic<size_t> used;
+};
+
+/**
+ * @brief Allocator for standard containers that uses the Arena inside an Arena::Scope and the heap outside
+ * @details It has no state, so every ArenaAllocator is interchangeable: memory from the arena is recognized by its
+ * address and deallocating it does nothing, memory from the heap is freed normally. Copies of containers made outside
+ * a scope (for instance the versions published by VersionedSchedule) live in the heap.
+ */
+template <class T>
+class ArenaAllocator {
+    public:
+        typedef T value_type;
+        typedef true_type is_always_equal;
+
+        ArenaAllocator() = default;
+        template <class U> ArenaAllocator(const ArenaAllocator<U> &) {}
+
+        T *allocate(size_t n) {
+            if (Arena::active()) {
+                void *pointer = Arena::instance().allocate(n * sizeof(T), alignof(T));
+                if (pointer != nullptr) return static_cast<T*>(pointer);
+            }
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *pointer, size_t) {
+            if (!Arena::instance().owns(pointer)) ::operator delete(pointer);
+        }
+
+        template <class U> bool operator == (const ArenaAllocator<U> &) const { return true; }
+        template <class U> bool operator != (const ArenaAllocator<U> &) const { return false; }
+};
+
+#endif //TRABALHO_ARENA_H
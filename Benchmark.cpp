@@ -0,0 +1,446 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <queue>
+#include <unistd.h>
+#include "ScheduleManager.h"
+#include "ScheduleIndex.h"
+#include "StudentSort.h"
+#include "TimetableBuilder.h"
+#include "IntegrityChecker.h"
+#include "EnrollmentColumns.h"
+#include "Persister.h"
+#include "FreeTimeFinder.h"
+#include "RequestIntake.h"
+
+using namespace std;
+
+/**
+ * @brief Microbenchmarks of the core primitives on generated data
+ * @details Generates a dataset of the requested size (in the same csv format as the data folder), loads it with
+ * ScheduleManager::readFiles() and measures each primitive in isolation. The results are written as JSON (default)
+ * or CSV so that they can be compared between commits.\n
+ * Usage: benchmark [--students n] [--ucs n] [--classes n] [--ucs-per-student n] [--min-time seconds]
+ * [--format json|csv] [--out file] [--filter name] [--seed n] [--search-sizes n,n,...]\n
+ * The schedule search is also measured on its own over synthetic schedule vectors of each of the search sizes.
+ */
+
+/** @brief Stream buffer that discards everything, used to measure the print functions without the terminal */
+class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+        streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+/** @brief Configuration of a run */
+struct Config {
+    int students = 20000;
+    int ucs = 40;
+    int classesPerUc = 12;
+    int ucsPerStudent = 5;
+    double minTime = 0.2;
+    unsigned seed = 42;
+    string format = "json";
+    string out;
+    string filter;
+    vector<size_t> searchSizes = {1000, 10000, 100000, 1000000};
+};
+
+/** @brief Result of one benchmark */
+struct Result {
+    string name;
+    long iterations;
+    double nsPerOp;
+};
+
+/**
+ * @brief Prevents the compiler from removing a computation whose result is not used
+ */
+template <class T>
+static void keep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Runs op with increasing iteration counts until it runs for at least minTime seconds
+ * @param op function that executes the primitive "iterations" times
+ */
+static Result measure(const string &name, double minTime, const function<void(long)> &op) {
+    op(1);
+    long iterations = 1;
+    double seconds = 0;
+    while (true) {
+        auto start = chrono::steady_clock::now();
+        op(iterations);
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (seconds >= minTime || iterations > (1L << 40)) break;
+        iterations = seconds <= 0 ? iterations * 10 : max(iterations * 2, (long) (iterations * minTime * 1.2 / seconds));
+    }
+    return {name, iterations, seconds * 1e9 / iterations};
+}
+
+/**
+ * @brief Binary search directly over the schedules, as ScheduleManager::binarySearchSchedules() did before the
+ * ScheduleIndex, kept as the baseline of the search benchmarks
+ */
+static long textbookSearch(const vector<ClassSchedule> &schedules, const UcClass &desired) {
+    long left = 0, right = (long) schedules.size() - 1;
+    while (left <= right) {
+        long middle = (left + right) / 2;
+        if (schedules[middle].getUcClass() == desired) return middle;
+        if (schedules[middle].getUcClass() < desired) left = middle + 1;
+        else right = middle - 1;
+    }
+    return -1;
+}
+
+/**
+ * @brief Writes classes_per_uc.csv, classes.csv and students_classes.csv with the requested size
+ * @details Every UC has a theoretical slot shared by all its classes and every class has a practical slot on a
+ * random weekday and hour. Every student is enrolled in ucsPerStudent different UCs.
+ */
+static void generateData(const string &dir, const Config &config) {
+    static const char *days[] = {"Monday", "Tuesday", "Wednesday", "Thursday", "Friday"};
+    static const char *names[] = {"Ana", "Bruno", "Carla", "Diogo", "Eva", "Filipe", "Ines", "Joao", "Marta", "Rui"};
+    mt19937 rng(config.seed);
+    char buffer[64];
+    ofstream perUc(dir + "classes_per_uc.csv"), classes(dir + "classes.csv"), students(dir + "students_classes.csv");
+    perUc << "UcCode,ClassCode\n";
+    classes << "ClassCode,UcCode,Weekday,StartHour,Duration,Type\n";
+    students << "StudentCode,StudentName,UcCode,ClassCode\n";
+    for (int u = 0; u < config.ucs; u++) {
+        snprintf(buffer, sizeof(buffer), "B.UC%04d", u);
+        string ucId = buffer;
+        const char *theoreticalDay = days[rng() % 5];
+        double theoreticalStart = 8 + (rng() % 20) * 0.5;
+        for (int c = 0; c < config.classesPerUc; c++) {
+            snprintf(buffer, sizeof(buffer), "1BEN%04d", c);
+            perUc << ucId << "," << buffer << "\n";
+            classes << buffer << "," << ucId << "," << theoreticalDay << "," << theoreticalStart << ",2,T\n";
+            classes << buffer << "," << ucId << "," << days[rng() % 5] << "," << 8 + (rng() % 20) * 0.5 << ",1.5," << (rng() % 3 ? "TP" : "PL") << "\n";
+        }
+    }
+    int ucsPerStudent = min(config.ucsPerStudent, config.ucs);
+    for (int s = 0; s < config.students; s++) {
+        vector<int> chosen;
+        while ((int) chosen.size() < ucsPerStudent) {
+            int u = rng() % config.ucs;
+            if (find(chosen.begin(), chosen.end(), u) == chosen.end()) chosen.push_back(u);
+        }
+        for (int u : chosen) {
+            snprintf(buffer, sizeof(buffer), "%d,%s,B.UC%04d,1BEN%04d", 202000000 + s, names[s % 10], u, (int) (rng() % config.classesPerUc));
+            students << buffer << "\n";
+        }
+    }
+}
+
+/**
+ * @brief Parses the command line arguments
+ * @return false if an argument is not valid
+ */
+static bool parseArguments(int argc, char **argv, Config &config) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string option = argv[i], value = argv[i + 1];
+        if (option == "--students") config.students = stoi(value);
+        else if (option == "--ucs") config.ucs = stoi(value);
+        else if (option == "--classes") config.classesPerUc = stoi(value);
+        else if (option == "--ucs-per-student") config.ucsPerStudent = stoi(value);
+        else if (option == "--min-time") config.minTime = stod(value);
+        else if (option == "--seed") config.seed = stoul(value);
+        else if (option == "--format") config.format = value;
+        else if (option == "--out") config.out = value;
+        else if (option == "--filter") config.filter = value;
+        else if (option == "--search-sizes") {
+            config.searchSizes.clear();
+            stringstream sizes(value);
+            string size;
+            while (getline(sizes, size, ',')) config.searchSizes.push_back(stoul(size));
+        }
+        else return false;
+    }
+    return argc % 2 == 1 && config.students > 0 && config.ucs > 0 && config.classesPerUc > 0;
+}
+
+/**
+ * @brief Writes the results in the requested format
+ */
+static void writeResults(ostream &out, const Config &config, const vector<Result> &results) {
+    if (config.format == "csv") {
+        out << "name,iterations,ns_per_op,students,ucs,classes_per_uc\n";
+        for (const Result &r : results) {
+            out << r.name << "," << r.iterations << "," << r.nsPerOp << "," << config.students << "," << config.ucs
+                << "," << config.classesPerUc << "\n";
+        }
+        return;
+    }
+    out << "{\n  \"config\": {\"students\": " << config.students << ", \"ucs\": " << config.ucs
+        << ", \"classes_per_uc\": " << config.classesPerUc << ", \"ucs_per_student\": " << config.ucsPerStudent
+        << ", \"seed\": " << config.seed << "},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "    {\"name\": \"" << results[i].name << "\", \"iterations\": " << results[i].iterations
+            << ", \"ns_per_op\": " << results[i].nsPerOp << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int main(int argc, char **argv) {
+    Config config;
+    if (!parseArguments(argc, argv, config)) {
+        cerr << "Usage: " << argv[0] << " [--students n] [--ucs n] [--classes n] [--ucs-per-student n] [--min-time seconds]"
+             << " [--format json|csv] [--out file] [--filter name] [--seed n] [--search-sizes n,n,...]" << endl;
+        return 1;
+    }
+    char dirTemplate[] = "/tmp/aed_benchmark_XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr) {
+        cerr << "Could not create a temporary directory" << endl;
+        return 1;
+    }
+    string dir = string(dirTemplate) + "/";
+    generateData(dir, config);
+    ScheduleManager manager;
+    auto loadStart = chrono::steady_clock::now();
+    manager.readFiles(dir);
+    double loadNs = chrono::duration<double, nano>(chrono::steady_clock::now() - loadStart).count();
+
+    const vector<ClassSchedule> &schedules = manager.getSchedules();
+    mt19937 rng(config.seed);
+    const size_t SAMPLES = 4096;
+    vector<Slot> slots;
+    vector<UcClass> ucClasses;
+    vector<string> ucIds, studentIds;
+    vector<Request> requests;
+    for (size_t i = 0; i < SAMPLES; i++) {
+        const ClassSchedule &cs = schedules[rng() % schedules.size()];
+        slots.push_back(cs.getSlots()[rng() % cs.getSlots().size()]);
+        ucClasses.push_back(cs.getUcClass());
+        ucIds.push_back(cs.getUcClass().getUcId());
+        studentIds.push_back(to_string(202000000 + rng() % config.students));
+    }
+    for (size_t i = 0; i < SAMPLES; i++) {
+        Student *student = manager.findStudent(studentIds[i]);
+        requests.emplace_back(*student, ucClasses[i], "Enrollment");
+    }
+    NullBuffer nullBuffer;
+    ostream nullStream(&nullBuffer);
+
+    vector<Result> results;
+    results.push_back({"readFiles", 1, loadNs});
+    auto run = [&](const string &name, const function<void(long)> &op) {
+        if (!config.filter.empty() && name.find(config.filter) == string::npos) return;
+        results.push_back(measure(name, config.minTime, op));
+        cerr << name << ": " << results.back().nsPerOp << " ns/op" << endl;
+    };
+
+    run("Slot::overlaps", [&](long n) {
+        for (long i = 0; i < n; i++) keep(slots[i % SAMPLES].overlaps(slots[(i * 7 + 1) % SAMPLES]));
+    });
+    run("Slot::operator<", [&](long n) {
+        for (long i = 0; i < n; i++) keep(slots[i % SAMPLES] < slots[(i * 7 + 1) % SAMPLES]);
+    });
+    run("binarySearchSchedules", [&](long n) {
+        for (long i = 0; i < n; i++) keep(manager.binarySearchSchedules(ucClasses[i % SAMPLES]));
+    });
+    run("findStudent", [&](long n) {
+        for (long i = 0; i < n; i++) keep(manager.findStudent(studentIds[i % SAMPLES]));
+    });
+    run("classesOverlap", [&](long n) {
+        for (long i = 0; i < n; i++) keep(manager.classesOverlap(ucClasses[i % SAMPLES], ucClasses[(i * 7 + 1) % SAMPLES]));
+    });
+    run("requestHasCollision", [&](long n) {
+        for (long i = 0; i < n; i++) keep(manager.requestHasCollision(requests[i % SAMPLES]));
+    });
+    run("requestExceedsCap", [&](long n) {
+        for (long i = 0; i < n; i++) keep(manager.requestExceedsCap(requests[i % SAMPLES]));
+    });
+    run("studentsOfUc", [&](long n) {
+        for (long i = 0; i < n; i++) keep(manager.studentsOfUc(ucIds[i % SAMPLES]).size());
+    });
+    vector<SessionIndex::Session> sessions;
+    run("SessionIndex::inSession", [&](long n) {
+        for (long i = 0; i < n; i++) {
+            sessions.clear();
+            manager.getSessionIndex().inSession((int) (i % 5), 8 + (i % 40) / 4.0f, sessions);
+            keep(sessions.size());
+        }
+    });
+    // common free time of 300 students and of the students of a class
+    vector<string> group;
+    for (const Student &student : manager.getStudents()) {
+        if (group.size() == 300) break;
+        group.push_back(student.getId());
+    }
+    FreeTimeFinder finder(manager);
+    run("FreeTimeFinder::find/300", [&](long n) {
+        for (long i = 0; i < n; i++) keep(finder.find(group));
+    });
+    run("FreeTimeFinder::findForClass", [&](long n) {
+        for (long i = 0; i < n; i++) keep(finder.findForClass(ucClasses[i % SAMPLES]));
+    });
+    // full scans of the enrollments: the set of students against the columns
+    EnrollmentColumns columns;
+    columns.build(manager.getStudents());
+    run("EnrollmentColumns::build", [&](long n) {
+        for (long i = 0; i < n; i++) {
+            EnrollmentColumns built;
+            keep(built.build(manager.getStudents()));
+        }
+    });
+    run("EnrollmentColumns::studentsOfUc", [&](long n) {
+        for (long i = 0; i < n; i++) keep(columns.studentsOfUc(ucIds[i % SAMPLES]).size());
+    });
+    run("Persister::writeStudents", [&](long n) {
+        for (long i = 0; i < n; i++) Persister::writeStudents(manager.getStudents(), nullStream);
+    });
+    run("EnrollmentColumns::writeCsv", [&](long n) {
+        for (long i = 0; i < n; i++) columns.writeCsv(nullStream);
+    });
+    vector<const Student*> shuffled;
+    for (const Student &student : manager.getStudents()) shuffled.push_back(&student);
+    shuffle(shuffled.begin(), shuffled.end(), rng);
+    run("StudentSort/numerical", [&](long n) {
+        for (long i = 0; i < n; i++) {
+            StudentSort::Roster &roster = StudentSort::roster();
+            roster.assign(shuffled.begin(), shuffled.end());
+            StudentSort::sort<Numerical>(roster);
+            keep(roster.front());
+        }
+    });
+    run("StudentSort/alphabetical", [&](long n) {
+        for (long i = 0; i < n; i++) {
+            StudentSort::Roster &roster = StudentSort::roster();
+            roster.assign(shuffled.begin(), shuffled.end());
+            StudentSort::sort<Alphabetical>(roster);
+            keep(roster.front());
+        }
+    });
+    const char *sortTypes[] = {"alphabetical", "reverse alphabetical", "numerical", "reverse numerical"};
+    for (const char *sortType : sortTypes) {
+        run(string("ClassSchedule::printStudents/") + sortType, [&](long n) {
+            for (long i = 0; i < n; i++) manager.findSchedule(ucClasses[i % SAMPLES])->printStudents(sortType, nullStream);
+        });
+    }
+
+    // timetables of 8 UCs (or every UC) for the sampled students, on one worker
+    vector<string> desired;
+    for (int u = 0; u < min(config.ucs, 8); u++) {
+        char ucCode[16];
+        snprintf(ucCode, sizeof(ucCode), "B.UC%04d", u);
+        desired.push_back(ucCode);
+    }
+    run("TimetableBuilder::build", [&](long n) {
+        for (long i = 0; i < n; i++) {
+            TimetableBuilder builder(manager);
+            builder.build(*manager.findStudent(studentIds[i % SAMPLES]), desired, nullStream, 1);
+            keep(builder.getResults().size());
+        }
+    });
+
+    run("IntegrityChecker::check", [&](long n) {
+        for (long i = 0; i < n; i++) {
+            IntegrityChecker checker(manager);
+            keep(checker.check(1));
+        }
+    });
+
+    // dry run of a batch of pending enrollment requests (the batch stays pending)
+    for (const Request &request : requests) manager.addEnrollmentRequest(request.getStudent(), request.getDesiredUcClass());
+    run("ScheduleManager::simulateRequests", [&](long n) {
+        for (long i = 0; i < n; i++) keep(manager.simulateRequests(nullStream));
+    });
+    manager.clearPendingRequests();
+
+    // submissions from several threads while one thread drains them: the lock-free intake against a locked queue
+    RequestIntake::Submission submission = {"Changing", studentIds[0], ucClasses[0].getUcId(), ucClasses[0].getClassId()};
+    for (unsigned producers : {1u, 2u, 4u, 8u}) {
+        string suffix = "/" + to_string(producers) + "producers";
+        run("RequestIntake::submit" + suffix, [&](long n) {
+            RequestIntake intake(4096);
+            vector<thread> threads;
+            for (unsigned t = 0; t < producers; t++) {
+                threads.emplace_back([&, t] {
+                    for (long i = t; i < n; i += producers) {
+                        while (!intake.submit(submission)) this_thread::yield(); // full: back off and retry
+                    }
+                });
+            }
+            RequestIntake::Submission taken;
+            for (long drained = 0; drained < n;) {
+                if (intake.take(taken)) drained++;
+                else this_thread::yield();
+            }
+            for (thread &producer : threads) producer.join();
+        });
+        run("mutexQueue::push" + suffix, [&](long n) {
+            queue<RequestIntake::Submission> locked;
+            mutex lockedMutex;
+            vector<thread> threads;
+            for (unsigned t = 0; t < producers; t++) {
+                threads.emplace_back([&, t] {
+                    for (long i = t; i < n; i += producers) {
+                        lock_guard<mutex> lock(lockedMutex);
+                        locked.push(submission);
+                    }
+                });
+            }
+            RequestIntake::Submission taken;
+            for (long drained = 0; drained < n;) {
+                unique_lock<mutex> lock(lockedMutex);
+                if (locked.empty()) {
+                    lock.unlock();
+                    this_thread::yield();
+                    continue;
+                }
+                taken = move(locked.front());
+                locked.pop();
+                drained++;
+            }
+            for (thread &producer : threads) producer.join();
+        });
+    }
+
+    for (size_t size : config.searchSizes) {
+        string suffix = "/" + to_string(size);
+        if (!config.filter.empty() && ("scheduleSearch/textbook" + suffix).find(config.filter) == string::npos
+            && ("scheduleSearch/index" + suffix).find(config.filter) == string::npos) continue;
+        // 10 classes per uc, with codes of the same length as the real ones
+        vector<ClassSchedule> synthetic;
+        synthetic.reserve(size);
+        char ucCode[16], classCode[16];
+        for (size_t i = 0; i < size; i++) {
+            snprintf(ucCode, sizeof(ucCode), "L.%06d", (int) (i / 10));
+            snprintf(classCode, sizeof(classCode), "1LEIC%02d", (int) (i % 10));
+            synthetic.emplace_back(ucCode, classCode);
+        }
+        ScheduleIndex index;
+        index.build(synthetic);
+        vector<UcClass> probes;
+        for (size_t i = 0; i < SAMPLES; i++) probes.push_back(synthetic[rng() % size].getUcClass());
+        run("scheduleSearch/textbook" + suffix, [&](long n) {
+            for (long i = 0; i < n; i++) keep(textbookSearch(synthetic, probes[i % SAMPLES]));
+        });
+        run("scheduleSearch/index" + suffix, [&](long n) {
+            for (long i = 0; i < n; i++) keep(index.find(probes[i % SAMPLES], synthetic));
+        });
+    }
+
+    for (const char *file : {"classes_per_uc.csv", "classes.csv", "students_classes.csv"}) remove((dir + file).c_str());
+    rmdir(dirTemplate);
+
+    if (config.out.empty()) {
+        writeResults(cout, config, results);
+    } else {
+        ofstream out(config.out);
+        writeResults(out, config, results);
+    }
+    return 0;
+}
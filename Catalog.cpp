@@ -0,0 +1,110 @@
+#include "Catalog.h"
+#include "MemoryReport.h"
+#include <fstream>
+#include <sstream>
+#include <mutex>
+
+/**
+ * @brief Constructor, the names of the L.EIC UCs are known in advance
+ * @details Time complexity: O(1)
+ */
+Catalog::Catalog() {
+    ucNames = {{"L.EIC001", "ALGA"}, {"L.EIC002", "AM I"}, {"L.EIC003", "FP"}, {"L.EIC004", "FSC"}, {"L.EIC005", "MD"}, {"L.EIC011", "AED"}, {"L.EIC012", "BD"}, {"L.EIC013", "F II"}, {"L.EIC014", "LDTS"}, {"L.EIC015", "SO"}, {"L.EIC021", "FSI"}, {"L.EIC022", "IPC"}, {"L.EIC023", "LBAW"}, {"L.EIC024", "PFL"}, {"L.EIC025", "RC"}};
+}
+
+/**
+ * @brief Catalog shared by every ScheduleManager of the process
+ * @details Time complexity: O(1)
+ */
+Catalog &Catalog::shared() {
+    static Catalog catalog;
+    return catalog;
+}
+
+/**
+ * @brief Returns the interned copy of a string, adding it when it is new
+ * @details Time complexity: O(k) expected, where k is the length of the string
+ * @return pointer that stays valid until the end of the process
+ */
+const string *Catalog::intern(const string &text) {
+    {
+        shared_lock<shared_timed_mutex> lock(tableMutex);
+        auto it = strings.find(text);
+        if (it != strings.end()) return &*it;
+    }
+    unique_lock<shared_timed_mutex> lock(tableMutex);
+    return &*strings.insert(text).first;
+}
+
+/**
+ * @brief Finds the interned copy of a string, without adding it
+ * @details Used for the codes given by users, so that a code that doesn't exist isn't kept forever.\n
+ * Time complexity: O(k) expected, where k is the length of the string
+ * @return pointer to the interned copy, nullptr if the string was never interned (so no schedule has it)
+ */
+const string *Catalog::find(const string &text) const {
+    shared_lock<shared_timed_mutex> lock(tableMutex);
+    auto it = strings.find(text);
+    return it == strings.end() ? nullptr : &*it;
+}
+
+/**
+ * @brief Default abbreviation of a UC
+ * @details Time complexity: O(k) expected, where k is the length of the UcId
+ * @return the abbreviation, an empty string if the UC has no name
+ */
+string Catalog::ucName(const string &ucId) const {
+    shared_lock<shared_timed_mutex> lock(tableMutex);
+    auto it = ucNames.find(ucId);
+    return it == ucNames.end() ? string() : it->second;
+}
+
+/**
+ * @brief Reads the abbreviations of the UCs from a csv file with the header "UcCode,Name"
+ * @details Time complexity: O(u) where u is the number of lines of the file
+ * @param names where the abbreviations are added, indexed by UcId
+ * @return false if the file couldn't be opened
+ */
+bool Catalog::readUcNames(const string &path, unordered_map<string, string> &names) {
+    ifstream file(path);
+    if (!file.is_open()) return false;
+    file.ignore(1000, '\n');
+    string line, ucId, name;
+    while (getline(file, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') line.resize(line.size() - 1);
+        stringstream str(line);
+        if (getline(str, ucId, ',') && getline(str, name)) names[ucId] = name;
+    }
+    return true;
+}
+
+/**
+ * @brief Number of interned strings
+ * @details Time complexity: O(1)
+ */
+size_t Catalog::size() const {
+    shared_lock<shared_timed_mutex> lock(tableMutex);
+    return strings.size();
+}
+
+/**
+ * @brief Adds the interned codes and the names of the UCs to a memory report
+ * @details A node of the hash tables holds the link to the next node, the value and its hash.\n
+ * Time complexity: O(k) where k is the number of strings
+ */
+void Catalog::accountMemory(MemoryReport &report) const {
+    shared_lock<shared_timed_mutex> lock(tableMutex);
+    size_t bytes = (strings.bucket_count() + ucNames.bucket_count()) * sizeof(void*);
+    size_t allocations = 2 + strings.size() + ucNames.size();
+    bytes += strings.size() * (sizeof(void*) + sizeof(string) + sizeof(size_t));
+    for (const string &text : strings) {
+        bytes += MemoryReport::heapBytes(text);
+        allocations += MemoryReport::heapBytes(text) > 0;
+    }
+    bytes += ucNames.size() * (sizeof(void*) + sizeof(pair<const string, string>) + sizeof(size_t));
+    for (const pair<const string, string> &name : ucNames) {
+        bytes += MemoryReport::heapBytes(name.first) + MemoryReport::heapBytes(name.second);
+        allocations += (MemoryReport::heapBytes(name.first) > 0) + (MemoryReport::heapBytes(name.second) > 0);
+    }
+    report.add("catalog (codes shared by the datasets)", bytes, strings.size() + ucNames.size(), allocations);
+}
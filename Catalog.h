@@ -0,0 +1,47 @@
+#ifndef TRABALHO_CATALOG_H
+#define TRABALHO_CATALOG_H
+
+#include <string>
+#include <unordered_set>
+#include <unordered_map>
+#include <shared_mutex>
+
+class MemoryReport;
+
+using namespace std;
+
+/**
+ * @brief Process wide tables shared by every dataset: the interned UC and class codes and the default names of the UCs
+ * @details A code is stored once, however many datasets, schedules and students refer to it, and a UcClass only
+ * keeps pointers to the interned codes (so two codes are equal when their pointers are equal).
+ * Interned strings are never removed, so the pointers stay valid for the whole process: only the codes read from the
+ * files are interned, the codes given by users are looked up with find(), which never adds them.
+ * Lookups take a shared lock, only a code that is seen for the first time takes the exclusive lock.
+ * The names read from the uc_names.csv of a dataset belong to that dataset (@see ScheduleManager::getUcName()).
+ */
+class Catalog {
+    public:
+        static Catalog &shared();
+
+        const string *intern(const string &text);
+        const string *find(const string &text) const;
+        string ucName(const string &ucId) const;
+        size_t size() const;
+        void accountMemory(MemoryReport &report) const;
+
+        static bool readUcNames(const string &path, unordered_map<string, string> &names);
+
+    private:
+        Catalog();
+        Catalog(const Catalog &other) = delete;
+        Catalog &operator = (const Catalog &other) = delete;
+
+        /** @brief Interned strings, the nodes of an unordered_set never move */
+        unordered_set<string> strings;
+        /** @brief Default abbreviation of each UC, indexed by UcId */
+        unordered_map<string, string> ucNames;
+        /** @brief Protects strings and ucNames */
+        mutable shared_timed_mutex tableMutex;
+};
+
+#endif //TRABALHO_CATALOG_H
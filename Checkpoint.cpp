@@ -0,0 +1,76 @@
+#include "Checkpoint.h"
+
+using namespace std;
+
+/**
+ * @brief Constructor, takes a checkpoint of the current state
+ * @details Only the pending requests are stored, the rest of the state is saved as it changes.\n
+ * Time complexity: O(r) where r is the number of pending requests
+ */
+Checkpoint::Checkpoint(Requests requests) : requests(move(requests)) {}
+
+/**
+ * @brief Saves the classes of a student before it is changed, only the first change of each student is saved
+ * @details Time complexity: O(h) the first time, O(1) after, where h is the number of classes of the student
+ */
+void Checkpoint::saveStudent(Student *student) {
+    if (savedClasses.count(student) == 0) savedClasses.emplace(student, student->getClasses());
+}
+
+/**
+ * @brief Logs that a student was added to (or removed from) the students of a class
+ * @details Time complexity: O(h) where h is the number of classes of the student (it is copied)
+ * @param schedule index of the class in the schedules
+ * @param student student as it was added, or as it was in the class before being removed
+ */
+void Checkpoint::rosterChanged(unsigned long schedule, const Student &student, bool added) {
+    rosterChanges.push_back({schedule, student, added});
+}
+
+/**
+ * @brief Logs that a student was created
+ * @details Time complexity: O(1)
+ */
+void Checkpoint::studentCreated(Student *student) {
+    createdStudents.push_back(student);
+}
+
+/**
+ * @brief Restores the state of the checkpoint and clears the log
+ * @details The changes to the classes are undone from the last to the first, then the classes of the students are
+ * restored and finally the students created since the checkpoint are removed.\n
+ * Time complexity: O(c log q + s h + k) where c is the number of class changes, q the number of students in a class,
+ * s the number of changed students, h their number of classes and k the number of created students
+ */
+void Checkpoint::undo(vector<ClassSchedule> &schedules, StudentSet &students, StudentIndex &studentIndex) {
+    for (auto it = rosterChanges.rbegin(); it != rosterChanges.rend(); it++) {
+        if (it->added) schedules[it->schedule].removeStudent(it->student);
+        else schedules[it->schedule].addStudent(it->student);
+    }
+    for (auto &saved : savedClasses) {
+        saved.first->setClasses(move(saved.second));
+    }
+    for (auto it = createdStudents.rbegin(); it != createdStudents.rend(); it++) {
+        studentIndex.erase(**it);
+        students.erase(students.find(**it));
+    }
+    rosterChanges.clear();
+    savedClasses.clear();
+    createdStudents.clear();
+}
+
+/**
+ * @brief Request queues when the checkpoint was taken
+ * @details Time complexity: O(1)
+ */
+Checkpoint::Requests &Checkpoint::getRequests() {
+    return requests;
+}
+
+/**
+ * @brief Number of logged changes
+ * @details Time complexity: O(1)
+ */
+size_t Checkpoint::getNumberOfChanges() const {
+    return rosterChanges.size() + savedClasses.size() + createdStudents.size();
+}
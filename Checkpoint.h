@@ -0,0 +1,58 @@
+#ifndef TRABALHO_CHECKPOINT_H
+#define TRABALHO_CHECKPOINT_H
+
+#include <vector>
+#include <unordered_map>
+#include <queue>
+#include "Student.h"
+#include "ClassSchedule.h"
+#include "StudentIndex.h"
+#include "Request.h"
+
+/**
+ * @brief Undo log of the student and class membership state since a checkpoint was taken
+ * @details Nothing is copied when the checkpoint is taken: the classes of a student are copied the first time the
+ * student is changed (before-image) and every change to the students of a class is logged with the student added
+ * or removed. Undoing the log restores the state in time proportional to the number of changes.
+ * The pending requests (which are few) are copied, so that they can be processed again after a rollback.
+ */
+class Checkpoint {
+    public:
+        /** @brief Request queues of the ScheduleManager when the checkpoint was taken */
+        struct Requests {
+            queue<Request> changing;
+            queue<Request> removal;
+            queue<Request> enrollment;
+            /** @brief Number of rejected requests */
+            size_t rejected;
+        };
+
+        explicit Checkpoint(Requests requests);
+
+        void saveStudent(Student *student);
+        void rosterChanged(unsigned long schedule, const Student &student, bool added);
+        void studentCreated(Student *student);
+        void undo(vector<ClassSchedule> &schedules, StudentSet &students, StudentIndex &studentIndex);
+        size_t getNumberOfChanges() const;
+        Requests &getRequests();
+
+    private:
+        /** @brief Pending requests when the checkpoint was taken */
+        Requests requests;
+
+        /** @brief Student added to or removed from the students of a class */
+        struct RosterChange {
+            unsigned long schedule;
+            Student student;
+            bool added;
+        };
+
+        /** @brief Classes of each changed student when it was first changed */
+        unordered_map<Student*, UcClassList> savedClasses;
+        /** @brief Changes to the students of the classes, in the order they were made */
+        vector<RosterChange> rosterChanges;
+        /** @brief Students created since the checkpoint */
+        vector<Student*> createdStudents;
+};
+
+#endif //TRABALHO_CHECKPOINT_H
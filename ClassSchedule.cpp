@@ -1,6 +1,9 @@
 #include "ClassSchedule.h"
+#include "Stats.h"
+#include "StudentSort.h"
 #include <iostream>
 #include <algorithm>
+#include <utility>
 
 using namespace std;
 
@@ -9,34 +12,28 @@ using namespace std;
  */
 ClassSchedule::ClassSchedule() {
     this->ucClass = UcClass();
-    this->slots = vector<Slot>();
+    this->slots = SlotList();
 }
 
 /**@brief Constructor, sets ucClass to the given one. The vector of slots is initialized as empty
 * @details Time complexity: O(1)
 * @param UcClass the UcClass of the schedule
 */
-ClassSchedule::ClassSchedule(const UcClass &ucClass) {
-    this->ucClass = ucClass;
-    this->slots = vector<Slot>();
-}
+ClassSchedule::ClassSchedule(UcClass ucClass) : ucClass(move(ucClass)) {}
 
 /**@brief Constructor, given a ucId and a classId, creates a UcClass and  the vector of slots is initialized as empty
  * @details Time complexity: O(1)
  * @param ucId
  * @param classId
  */
-ClassSchedule::ClassSchedule(const string &ucId, const string &classId) {
-    this->ucClass = UcClass(ucId, classId);
-    this->slots = vector<Slot>();
-}
+ClassSchedule::ClassSchedule(string ucId, string classId) : ucClass(move(ucId), move(classId)) {}
 
 /** @brief Add a slot to the vector of slots
  * @details Time complexity: O(1)
  * @param slot the slot to be added
 */
-void ClassSchedule::addSlot(const Slot &slot) {
-    slots.push_back(slot);
+void ClassSchedule::addSlot(Slot slot) {
+    slots.push_back(move(slot));
 }
 
 /** @brief Inserts a student in the set of students
@@ -66,45 +63,42 @@ bool ClassSchedule::sameUcId(const ClassSchedule &other) const {
 /**@brief Prints the ucId and classId
  * @details Time complexity: O(1)
  */
-void ClassSchedule::printHeader() const {
-    cout << ">> UC:" << ucClass.getUcId() << " " << ucClass.getClassId() << endl;
+void ClassSchedule::printHeader(ostream &out) const {
+    out << ">> UC:" << ucClass.getUcId() << " " << ucClass.getClassId() << endl;
 }
 
 /**@brief Prints each slot (Weekday, Start time, End time, Type)
  * @details Time complexity: O(l), where l is the number of slots in the ClassSchedule
  */
-void ClassSchedule::printSlots() const {
-    cout << ">> Slots:" << endl;
+void ClassSchedule::printSlots(ostream &out) const {
+    out << ">> Slots:" << endl;
     for (const Slot &slot : slots) {
-        cout << "   " << slot.getWeekDay() << "   " << slot.getStartTime() << " - " << slot.getEndTime() << "   " << slot.getType() << endl;
+        out << "   " << slot.getWeekDay() << "   " << slot.getStartTime() << " - " << slot.getEndTime() << "   " << slot.getType() << endl;
     }
 }
 
 /**@brief Prints the students in a given sortType
- * @details Prints the number of students, then the students in the given sortType\n
- * Time complexity: O(q log q), where q is the number of students in the ClassSchedule
+ * @details Prints the number of students, then the students in the given sortType. The students are sorted as
+ * pointers in the buffer of the thread, with the SortOrder named by sortType @see StudentSort\n
+ * Time complexity: O(q log q) alphabetically, O(q) numerically, where q is the number of students in the ClassSchedule
  * @param sortType the type of sort, it can be alphabetical, reverse alphabetical, numerical, reverse numerical
  */
-void ClassSchedule::printStudents(const string &sortType) const{
-    auto studentsVector = new vector<Student>(students.begin(), students.end()); //O(q)
-    if (sortType == "alphabetical") {
-        sort(studentsVector->begin(), studentsVector->end(), [](const Student &a, const Student &b) { return a.getName() < b.getName(); }); //O(q logQ)
-    } else if (sortType == "reverse alphabetical") {
-        sort(studentsVector->rbegin(), studentsVector->rend(), [](const Student &a, const Student &b) { return a.getName() < b.getName(); }); //O(q logQ)
-    } else if (sortType == "numerical") {
-        sort(studentsVector->begin(), studentsVector->end());
-    } else if (sortType == "reverse numerical") {
-        sort(studentsVector->rbegin(), studentsVector->rend());
-    } else {
-        cout << "Invalid sortType" << endl;
+void ClassSchedule::printStudents(const string &sortType, ostream &out) const{
+    STATS_TIMER("print.printStudents");
+    StudentSort::Roster &roster = StudentSort::roster();
+    for(const Student &student : students) roster.push_back(&student); //O(q)
+    bool valid = StudentSort::dispatch(sortType, [&roster](auto order) {
+        StudentSort::sort<decltype(order)>(roster); //O(q log q) or O(q)
+    });
+    if (!valid) {
+        out << "Invalid sortType" << endl;
         return;
     }
-    cout << ">> Number of students: " << students.size() << endl;
-    cout << ">> Students:" << endl;
-    for(const Student &student: *studentsVector){   //O(q)
-        cout << "   "; student.printHeader();
+    out << ">> Number of students: " << students.size() << endl;
+    out << ">> Students:" << endl;
+    for(const Student *student: roster){   //O(q)
+        out << "   "; student->printHeader(out);
     }
-    delete studentsVector;
 }
 
 /**@brief Prints the ClassSchedule (calls printHeader(), printSlots() and printStudents())
@@ -113,17 +107,17 @@ void ClassSchedule::printStudents(const string &sortType) const{
  * @see printSlots()
  * @see printStudents()
 */
-void ClassSchedule::print() const {
-    printHeader();  //O(1)
-    printSlots();   //O(l)
-    printStudents();    //O(q log q)
-    cout << endl;
+void ClassSchedule::print(ostream &out) const {
+    printHeader(out);  //O(1)
+    printSlots(out);   //O(l)
+    printStudents("alphabetical", out);    //O(q log q)
+    out << endl;
 }
 
-/**@brief Returns the UcClass of the ClassSchedule
+/**@brief Returns a reference to the UcClass of the ClassSchedule
  * @details Time complexity: O(1)
 */
-UcClass ClassSchedule::getUcClass() const {
+const UcClass &ClassSchedule::getUcClass() const {
     return ucClass;
 }
 
@@ -139,14 +133,14 @@ int ClassSchedule::getNumStudents() const {
  * @brief Returns a reference to the vector of slots
  * @details Time complexity: O(1)
 */
-const vector<Slot> &ClassSchedule::getSlots() const {
+const SlotList &ClassSchedule::getSlots() const {
     return slots;
 }
 
-/**@brief Returns the set of students
+/**@brief Returns a reference to the set of students
  * @details Time complexity: O(1)
 */
-set<Student> ClassSchedule::getStudents() const {
+const StudentSet &ClassSchedule::getStudents() const {
     return students;
 }
 
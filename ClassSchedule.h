@@ -7,29 +7,32 @@
 #include "UcClass.h"
 #include "Student.h"
 
+/** @brief Vector of the slots of a schedule, allocated in the Arena while the files are read */
+typedef vector<Slot, ArenaAllocator<Slot>> SlotList;
+
 /**
  * @brief Class that represents a schedule for a class in a given Course, with a vector of slots and a set of students
  */
 class ClassSchedule {
     public:
         ClassSchedule();
-        ClassSchedule(const UcClass &ucClass);
-        ClassSchedule(const string &ucId, const string &classId);
+        ClassSchedule(UcClass ucClass);
+        ClassSchedule(string ucId, string classId);
 
-        void addSlot(const Slot &slot);
+        void addSlot(Slot slot);
         void addStudent(const Student &student);
         void removeStudent(const Student &student);
         bool sameUcId(const ClassSchedule &other) const;
 
-        void printHeader() const;
-        void printSlots() const;
-        void printStudents(const string &sortType = "alphabetical") const;
-        void print() const;
+        void printHeader(ostream &out = cout) const;
+        void printSlots(ostream &out = cout) const;
+        void printStudents(const string &sortType = "alphabetical", ostream &out = cout) const;
+        void print(ostream &out = cout) const;
 
-        UcClass getUcClass() const;
+        const UcClass &getUcClass() const;
         int getNumStudents() const;
-        const vector<Slot> &getSlots() const;
-        set<Student> getStudents() const;
+        const SlotList &getSlots() const;
+        const StudentSet &getStudents() const;
         bool operator < (const ClassSchedule &other) const;
         bool operator == (const ClassSchedule &other) const;
 
@@ -37,9 +40,9 @@ class ClassSchedule {
         /** @brief Information about the class and UC that the schedule is for */
         UcClass ucClass;
         /** @brief Vector of slots that constitutes the schedule */
-        vector<Slot> slots;
+        SlotList slots;
         /** @brief Set of students that are enrolled in the class in this UC */
-        set<Student> students;
+        StudentSet students;
 };
 
 #endif //TRABALHO_CLASSSCHEDULE_H
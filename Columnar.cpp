@@ -0,0 +1,74 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <sys/stat.h>
+#include "EnrollmentColumns.h"
+#include "Persister.h"
+
+using namespace std;
+
+/**
+ * @brief Converts students_classes.csv to the columnar .col file and back, or describes a .col file
+ * @details to-col reads the csv and writes the .col next to it (or to the given output); from then on the .col is
+ * loaded instead of the csv while it is not older than it, and the app keeps both up to date when it saves.
+ * to-csv writes the csv of a .col file, info prints the sizes of the columns. Both files are replaced atomically.\n
+ * Usage: columnar to-col|to-csv|info input [output]
+ */
+
+/** @brief Size of a file in bytes, 0 if it doesn't exist */
+static long long fileSize(const string &path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? (long long) info.st_size : 0;
+}
+
+/** @brief Seconds since start */
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    string mode = argc > 1 ? argv[1] : "";
+    if ((argc != 3 && argc != 4) || (mode != "to-col" && mode != "to-csv" && mode != "info")) {
+        cerr << "Usage: " << argv[0] << " to-col|to-csv|info input [output]" << endl;
+        return 1;
+    }
+    string input = argv[2];
+    EnrollmentColumns columns;
+    auto start = chrono::steady_clock::now();
+    if (mode == "to-col") {
+        string output = argc == 4 ? argv[3] : EnrollmentColumns::pathFor(input);
+        if (!columns.readCsv(input)) {
+            cerr << "Could not read " << input << " (missing, or more than " << EnrollmentColumns::MAX_CLASSES
+                 << " classes or " << EnrollmentColumns::MAX_CLASSES_PER_STUDENT << " per student)" << endl;
+            return 1;
+        }
+        if (!columns.save(output)) {
+            cerr << "Could not write " << output << endl;
+            return 1;
+        }
+        cout << ">> " << columns.size() << " students and " << columns.getNumberOfEnrollments() << " enrollments: "
+             << fileSize(input) << " bytes -> " << fileSize(output) << " bytes in " << secondsSince(start) << " s" << endl;
+        return 0;
+    }
+    if (!columns.load(input)) {
+        cerr << "Could not read " << input << " (missing or not a valid .col file)" << endl;
+        return 1;
+    }
+    if (mode == "to-csv") {
+        string output = argc == 4 ? argv[3] : input.substr(0, input.rfind('.')) + ".csv";
+        if (!Persister::replaceFile(output, [&columns](ostream &out) { columns.writeCsv(out); })) {
+            cerr << "Could not write " << output << endl;
+            return 1;
+        }
+        cout << ">> " << columns.size() << " students and " << columns.getNumberOfEnrollments() << " enrollments: "
+             << fileSize(input) << " bytes -> " << fileSize(output) << " bytes in " << secondsSince(start) << " s" << endl;
+        return 0;
+    }
+    cout << ">> " << input << ": " << fileSize(input) << " bytes" << endl;
+    cout << "   Students: " << columns.size() << endl;
+    cout << "   Enrollments: " << columns.getNumberOfEnrollments() << endl;
+    cout << "   Classes in the dictionary: " << columns.getDictionary().size() << endl;
+    cout << "   Memory of the columns: " << columns.getMemoryUsage() << " bytes" << endl;
+    return 0;
+}
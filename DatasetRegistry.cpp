@@ -0,0 +1,73 @@
+#include "DatasetRegistry.h"
+#include <fstream>
+
+/**
+ * @brief Constructor, creates the shared pool of workers
+ * @details Time complexity: O(w) where w is the number of workers
+ * @param numThreads number of workers (0 uses the number of hardware threads)
+ */
+DatasetRegistry::DatasetRegistry(unsigned numThreads) : pool(numThreads) {}
+
+/**
+ * @brief Loads a dataset from a data directory and publishes it under the given name
+ * @details The overlaps are computed by the shared pool, so it must not be called from one of its workers.\n
+ * Time complexity: the same as ScheduleManager::readFiles()
+ * @param name name of the dataset, it must not be in use
+ * @param dataDir directory of the csv files, ending with '/'
+ * @param trace trace where the requests of the dataset are recorded (null if they are not recorded)
+ * @return false if the name is already in use or the directory has no classes_per_uc.csv
+ */
+bool DatasetRegistry::add(const string &name, const string &dataDir, shared_ptr<RequestTrace> trace) {
+    if(name.empty() || datasets.count(name) || !ifstream(dataDir + "classes_per_uc.csv").good()) return false;
+    ScheduleManager manager;
+    manager.setPool(&pool);
+    manager.setTrace(move(trace));
+    manager.readFiles(dataDir);
+    datasets[name].reset(new VersionedSchedule(move(manager)));
+    if(defaultName.empty()) defaultName = name;
+    return true;
+}
+
+/**
+ * @brief Finds a dataset
+ * @details Time complexity: O(log d) where d is the number of datasets
+ * @return versions of the dataset, nullptr if there is no dataset with that name
+ */
+VersionedSchedule *DatasetRegistry::find(const string &name) const {
+    auto it = datasets.find(name);
+    return it == datasets.end() ? nullptr : it->second.get();
+}
+
+/**
+ * @brief Name of the dataset used when none is selected (the first one added)
+ * @details Time complexity: O(1)
+ */
+const string &DatasetRegistry::getDefaultName() const {
+    return defaultName;
+}
+
+/**
+ * @brief Names of the datasets, in alphabetical order
+ * @details Time complexity: O(d) where d is the number of datasets
+ */
+vector<string> DatasetRegistry::getNames() const {
+    vector<string> names;
+    for(const auto &dataset : datasets) names.push_back(dataset.first);
+    return names;
+}
+
+/**
+ * @brief Number of datasets
+ * @details Time complexity: O(1)
+ */
+size_t DatasetRegistry::size() const {
+    return datasets.size();
+}
+
+/**
+ * @brief Pool of workers shared by every dataset
+ * @details Time complexity: O(1)
+ */
+ThreadPool &DatasetRegistry::getPool() {
+    return pool;
+}
@@ -0,0 +1,41 @@
+#ifndef TRABALHO_DATASETREGISTRY_H
+#define TRABALHO_DATASETREGISTRY_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "VersionedSchedule.h"
+#include "ThreadPool.h"
+#include "RequestTrace.h"
+
+/**
+ * @brief Named datasets (for example one per program or semester) hosted by the same process
+ * @details Each dataset is a ScheduleManager loaded from its own data directory and published through its own
+ * VersionedSchedule. The UC and class codes and the names of the UCs are interned once in the Catalog, and every
+ * dataset is loaded and served by the same pool of workers.
+ * Datasets are only added before the registry is shared with other threads (e.g. before the Server runs).
+ */
+class DatasetRegistry {
+    public:
+        explicit DatasetRegistry(unsigned numThreads = 0);
+        DatasetRegistry(const DatasetRegistry &other) = delete;
+        DatasetRegistry &operator = (const DatasetRegistry &other) = delete;
+
+        bool add(const string &name, const string &dataDir, shared_ptr<RequestTrace> trace = nullptr);
+        VersionedSchedule *find(const string &name) const;
+        const string &getDefaultName() const;
+        vector<string> getNames() const;
+        size_t size() const;
+        ThreadPool &getPool();
+
+    private:
+        /** @brief Workers shared by every dataset */
+        ThreadPool pool;
+        /** @brief Versions of each dataset, indexed by name */
+        map<string, unique_ptr<VersionedSchedule>> datasets;
+        /** @brief Name of the first dataset added, used when a command doesn't select one */
+        string defaultName;
+};
+
+#endif //TRABALHO_DATASETREGISTRY_H
@@ -0,0 +1,565 @@
+#include "EnrollmentColumns.h"
+#include "Persister.h"
+#include "Stats.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <cstring>
+#include <sys/stat.h>
+
+using namespace std;
+
+/** @brief First bytes of a .col file, the last character is the version of the format */
+static const char MAGIC[] = "ENRCOL1\n";
+static const size_t MAGIC_SIZE = sizeof(MAGIC) - 1;
+
+/**
+ * @brief Appends a value in 7 bit groups, the high bit of a byte is set when more bytes follow
+ * @details Time complexity: O(1)
+ */
+template <typename Bytes>
+static void putVarint(Bytes &bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t) value);
+}
+
+/**
+ * @brief Reads a value written by putVarint()
+ * @details Time complexity: O(1)
+ * @param offset position of the value, moved past it
+ * @return false if the value doesn't end before size or has more than 64 bits
+ */
+static bool getVarint(const uint8_t *bytes, size_t size, size_t &offset, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && offset < size; shift += 7) {
+        uint8_t byte = bytes[offset++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+/** @brief Appends a string preceded by its length */
+static void putString(string &out, const string &text) {
+    putVarint(out, text.size());
+    out += text;
+}
+
+/** @brief FNV-1a hash of the content of a .col file, checked when it is loaded */
+static uint64_t checksum(const char *data, size_t size) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ (unsigned char) data[i]) * 1099511628211ULL;
+    return hash;
+}
+
+/**
+ * @brief Decimal form of a number
+ * @details Time complexity: O(d) where d is the number of digits
+ */
+static void toDecimal(uint64_t value, string &out) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    out.resize(n);
+    for (size_t i = 0; i < n; i++) out[i] = digits[n - 1 - i];
+}
+
+/**
+ * @brief Orders the students by number and, when two ids have the same number (leading zeros), by id
+ */
+static bool byKey(uint64_t keyA, const string &idA, uint64_t keyB, const string &idB) {
+    return keyA != keyB ? keyA < keyB : idA < idB;
+}
+
+/**
+ * @brief Constructor, creates empty columns
+ * @details Time complexity: O(1)
+ */
+EnrollmentColumns::EnrollmentColumns() {
+    this->numStudents = 0;
+}
+
+/**
+ * @brief Empties every column
+ * @details Time complexity: O(1)
+ */
+void EnrollmentColumns::clear() {
+    dictionary.clear();
+    idDeltas.clear();
+    irregularIds.clear();
+    names.clear();
+    classCounts.clear();
+    classCodes.clear();
+    numStudents = 0;
+}
+
+/**
+ * @brief Code of a class, the class is added to the dictionary if it is new
+ * @details Time complexity: O(1) expected
+ * @param codes code of each class of the dictionary
+ * @return false if the class is new and the dictionary already has MAX_CLASSES
+ */
+bool EnrollmentColumns::codeOf(const UcClass &ucClass, unordered_map<UcClass, uint16_t, UcClassHash> &codes,
+                               uint16_t &code) {
+    auto it = codes.find(ucClass);
+    if (it == codes.end()) {
+        if (dictionary.size() == MAX_CLASSES) return false;
+        it = codes.emplace(ucClass, (uint16_t) dictionary.size()).first;
+        dictionary.push_back(ucClass);
+    }
+    code = it->second;
+    return true;
+}
+
+/**
+ * @brief Appends the number, id and name of the next student (its classes are appended by the caller)
+ * @details Time complexity: O(1)
+ * @param key number of the student, not smaller than previousKey
+ * @param previousKey number of the previous student, updated to key
+ */
+void EnrollmentColumns::appendStudent(uint64_t key, const string &id, const char *name, size_t nameLength,
+                                      uint64_t &previousKey) {
+    putVarint(idDeltas, key - previousKey);
+    previousKey = key;
+    // parseKey() only accepts digits, so an id with a number is its decimal form unless it has leading zeros
+    if (key == Student::NO_KEY || (id.size() > 1 && id[0] == '0')) irregularIds.emplace_back(numStudents, id);
+    names.append(name, nameLength);
+    names.push_back('\0');
+    numStudents++;
+}
+
+/**
+ * @brief Encodes the students of a set
+ * @details The set is ordered by id, which is the order of the numbers when the ids have the same length, so the
+ * students are only sorted again when it isn't.\n
+ * Time complexity: O(p log p + e) where p is the number of students and e the number of enrollments
+ * @return false (and the columns are left empty) if there are more than MAX_CLASSES classes or a student has more
+ * than MAX_CLASSES_PER_STUDENT
+ */
+bool EnrollmentColumns::build(const StudentSet &students) {
+    STATS_TIMER("columns.build");
+    clear();
+    vector<const Student*> order;
+    order.reserve(students.size());
+    for (const Student &student : students) order.push_back(&student);
+    auto less = [](const Student *a, const Student *b) { return byKey(a->getKey(), a->getId(), b->getKey(), b->getId()); };
+    if (!is_sorted(order.begin(), order.end(), less)) sort(order.begin(), order.end(), less);
+
+    unordered_map<UcClass, uint16_t, UcClassHash> codes;
+    uint64_t previousKey = 0;
+    for (const Student *student : order) {
+        const UcClassList &classes = student->getClasses();
+        if (classes.size() > MAX_CLASSES_PER_STUDENT) {
+            clear();
+            return false;
+        }
+        for (const UcClass &ucClass : classes) {
+            uint16_t code;
+            if (!codeOf(ucClass, codes, code)) {
+                clear();
+                return false;
+            }
+            classCodes.push_back(code);
+        }
+        classCounts.push_back((uint8_t) classes.size());
+        appendStudent(student->getKey(), student->getId(), student->getName().c_str(), student->getName().size(), previousKey);
+    }
+    return true;
+}
+
+/**
+ * @brief Encodes a file in the format of students_classes.csv
+ * @details The rows of a student don't need to be together, the name is taken from the first one.\n
+ * Time complexity: O(r + p log p) where r is the number of rows and p the number of students
+ * @return false if the file couldn't be opened or has too many classes (@see build())
+ */
+bool EnrollmentColumns::readCsv(const string &path) {
+    STATS_TIMER("columns.readCsv");
+    clear();
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) return false;
+    stringstream buffer;
+    buffer << file.rdbuf();
+    const string text = buffer.str();
+
+    struct Row {
+        uint64_t key;
+        string id;
+        string name;
+        vector<uint16_t> classes;
+    };
+    vector<Row> rows;
+    unordered_map<string, size_t> rowOf;
+    unordered_map<UcClass, uint16_t, UcClassHash> codes;
+    size_t start = text.find('\n'); // header
+    start = start == string::npos ? text.size() : start + 1;
+    string fields[4];
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == string::npos) end = text.size();
+        size_t lineEnd = end > start && text[end - 1] == '\r' ? end - 1 : end;
+        int n = 0;
+        for (size_t field = start; n < 4 && field <= lineEnd; n++) {
+            size_t comma = text.find(',', field);
+            if (comma == string::npos || comma > lineEnd) comma = lineEnd;
+            fields[n].assign(text, field, comma - field);
+            field = comma + 1;
+        }
+        start = end + 1;
+        if (n < 4) continue;
+        auto found = rowOf.find(fields[0]);
+        if (found == rowOf.end()) {
+            found = rowOf.emplace(fields[0], rows.size()).first;
+            rows.push_back({Student::parseKey(fields[0]), fields[0], fields[1], {}});
+        }
+        Row &row = rows[found->second];
+        uint16_t code;
+        if (!codeOf(UcClass(fields[2], fields[3]), codes, code) || row.classes.size() == MAX_CLASSES_PER_STUDENT) {
+            clear();
+            return false;
+        }
+        row.classes.push_back(code);
+    }
+
+    vector<size_t> order(rows.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    sort(order.begin(), order.end(), [&rows](size_t a, size_t b) {
+        return byKey(rows[a].key, rows[a].id, rows[b].key, rows[b].id);
+    });
+    uint64_t previousKey = 0;
+    for (size_t i : order) {
+        const Row &row = rows[i];
+        classCodes.insert(classCodes.end(), row.classes.begin(), row.classes.end());
+        classCounts.push_back((uint8_t) row.classes.size());
+        appendStudent(row.key, row.id, row.name.c_str(), row.name.size(), previousKey);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the students in the format of students_classes.csv, sorted by number
+ * @details The text of each class is built once and the rows are written through a buffer, without formatting.\n
+ * Time complexity: O(e) where e is the number of enrollments
+ */
+void EnrollmentColumns::writeCsv(ostream &out) const {
+    STATS_TIMER("columns.writeCsv");
+    vector<string> classText;
+    classText.reserve(dictionary.size());
+    for (const UcClass &ucClass : dictionary) classText.push_back(ucClass.getUcId() + ',' + ucClass.getClassId() + '\n');
+    static const size_t FLUSH_SIZE = 1 << 20;
+    string buffer = "StudentCode,StudentName,UcCode,ClassCode\n";
+    buffer.reserve(FLUSH_SIZE + 256);
+    Cursor cursor(*this);
+    while (cursor.next()) {
+        const string &id = cursor.getId();
+        const char *name = cursor.getName();
+        size_t nameLength = strlen(name);
+        for (size_t c = 0; c < cursor.getNumberOfClasses(); c++) {
+            buffer += id;
+            buffer += ',';
+            buffer.append(name, nameLength);
+            buffer += ',';
+            buffer += classText[cursor.getClassCode(c)];
+        }
+        if (buffer.size() >= FLUSH_SIZE) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+}
+
+/**
+ * @brief Writes the columns to a binary file, replacing it atomically
+ * @details The file has the MAGIC, the dictionary, the number of students, each column (preceded by its size) and
+ * a checksum of everything before it.\n
+ * Time complexity: O(p + e) where p is the number of students and e the number of enrollments
+ * @see Persister::replaceFile()
+ * @return false if the file couldn't be written
+ */
+bool EnrollmentColumns::save(const string &path) const {
+    STATS_TIMER("columns.save");
+    string data = serialize();
+    return Persister::replaceFile(path, [&data](ostream &out) { out.write(data.data(), data.size()); });
+}
+
+/**
+ * @brief Content of the binary file
+ * @details Time complexity: O(p + e) where p is the number of students and e the number of enrollments
+ */
+string EnrollmentColumns::serialize() const {
+    string data(MAGIC, MAGIC_SIZE);
+    putVarint(data, dictionary.size());
+    for (const UcClass &ucClass : dictionary) {
+        putString(data, ucClass.getUcId());
+        putString(data, ucClass.getClassId());
+    }
+    putVarint(data, numStudents);
+    putVarint(data, idDeltas.size());
+    data.append((const char*) idDeltas.data(), idDeltas.size());
+    putVarint(data, irregularIds.size());
+    for (const pair<size_t, string> &irregular : irregularIds) {
+        putVarint(data, irregular.first);
+        putString(data, irregular.second);
+    }
+    putVarint(data, names.size());
+    data += names;
+    data.append((const char*) classCounts.data(), classCounts.size());
+    putVarint(data, classCodes.size());
+    for (uint16_t code : classCodes) putVarint(data, code);
+    uint64_t hash = checksum(data.data(), data.size());
+    for (int i = 0; i < 8; i++) data.push_back((char) (hash >> (8 * i)));
+    return data;
+}
+
+/**
+ * @brief Reads a binary file written by save()
+ * @details Time complexity: O(p + e) where p is the number of students and e the number of enrollments
+ * @return false (and the columns are left empty) if the file couldn't be read or isn't a valid .col file
+ */
+bool EnrollmentColumns::load(const string &path) {
+    STATS_TIMER("columns.load");
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        clear();
+        return false;
+    }
+    stringstream buffer;
+    buffer << file.rdbuf();
+    if (deserialize(buffer.str())) return true;
+    clear();
+    return false;
+}
+
+/**
+ * @brief Decodes the content of a binary file, checking that the columns agree with each other
+ * @details Time complexity: O(p + e) where p is the number of students and e the number of enrollments
+ */
+bool EnrollmentColumns::deserialize(const string &data) {
+    clear();
+    if (data.size() < MAGIC_SIZE + 8 || data.compare(0, MAGIC_SIZE, MAGIC) != 0) return false;
+    size_t size = data.size() - 8;
+    uint64_t stored = 0;
+    for (int i = 0; i < 8; i++) stored |= uint64_t((unsigned char) data[size + i]) << (8 * i);
+    if (stored != checksum(data.data(), size)) return false;
+
+    const uint8_t *bytes = (const uint8_t*) data.data();
+    size_t offset = MAGIC_SIZE;
+    uint64_t count, value, length;
+    auto getBytes = [&](uint64_t n, const uint8_t *&start) {
+        if (n > size - offset) return false;
+        start = bytes + offset;
+        offset += n;
+        return true;
+    };
+    auto getText = [&](string &text) {
+        const uint8_t *start;
+        if (!getVarint(bytes, size, offset, length) || !getBytes(length, start)) return false;
+        text.assign((const char*) start, length);
+        return true;
+    };
+    const uint8_t *start;
+    string ucId, classId;
+    if (!getVarint(bytes, size, offset, count) || count > MAX_CLASSES) return false;
+    for (uint64_t i = 0; i < count; i++) {
+        if (!getText(ucId) || !getText(classId)) return false;
+        dictionary.emplace_back(ucId, classId);
+    }
+    uint64_t students;
+    if (!getVarint(bytes, size, offset, students) || students > size) return false;
+    if (!getVarint(bytes, size, offset, length) || !getBytes(length, start)) return false;
+    idDeltas.assign(start, start + length);
+    for (size_t position = 0, i = 0; i < students; i++) {
+        if (!getVarint(idDeltas.data(), idDeltas.size(), position, value)) return false;
+    }
+    if (!getVarint(bytes, size, offset, count) || count > students) return false;
+    for (uint64_t i = 0; i < count; i++) {
+        string id;
+        if (!getVarint(bytes, size, offset, value) || value >= students || !getText(id)) return false;
+        if (!irregularIds.empty() && value <= irregularIds.back().first) return false;
+        irregularIds.emplace_back(value, id);
+    }
+    if (!getVarint(bytes, size, offset, length) || !getBytes(length, start)) return false;
+    names.assign((const char*) start, length);
+    if ((uint64_t) count_if(names.begin(), names.end(), [](char c) { return c == '\0'; }) != students) return false;
+    if (students > 0 && names.back() != '\0') return false;
+    if (!getBytes(students, start)) return false;
+    classCounts.assign(start, start + students);
+    uint64_t enrollments = 0;
+    for (uint8_t classCount : classCounts) enrollments += classCount;
+    if (!getVarint(bytes, size, offset, count) || count != enrollments) return false;
+    classCodes.reserve(count);
+    for (uint64_t i = 0; i < count; i++) {
+        if (!getVarint(bytes, size, offset, value) || value >= dictionary.size()) return false;
+        classCodes.push_back((uint16_t) value);
+    }
+    if (offset != size) return false;
+    numStudents = students;
+    return true;
+}
+
+/**
+ * @brief Number of students
+ * @details Time complexity: O(1)
+ */
+size_t EnrollmentColumns::size() const {
+    return numStudents;
+}
+
+/**
+ * @brief Number of classes of every student added up
+ * @details Time complexity: O(1)
+ */
+size_t EnrollmentColumns::getNumberOfEnrollments() const {
+    return classCodes.size();
+}
+
+/**
+ * @brief Classes that appear, the code of a class is its position
+ * @details Time complexity: O(1)
+ */
+const vector<UcClass> &EnrollmentColumns::getDictionary() const {
+    return dictionary;
+}
+
+/**
+ * @brief Ids of the students enrolled in a UC, sorted by number
+ * @details Only the class codes are scanned, the codes of the UC are marked in the dictionary first.\n
+ * Time complexity: O(c + e) where c is the number of classes and e the number of enrollments
+ */
+vector<string> EnrollmentColumns::studentsOfUc(const string &ucId) const {
+    vector<bool> inUc(dictionary.size());
+    for (size_t code = 0; code < dictionary.size(); code++) inUc[code] = dictionary[code].getUcId() == ucId;
+    vector<string> ids;
+    Cursor cursor(*this);
+    while (cursor.next()) {
+        for (size_t c = 0; c < cursor.getNumberOfClasses(); c++) {
+            if (inUc[cursor.getClassCode(c)]) {
+                ids.push_back(cursor.getId());
+                break;
+            }
+        }
+    }
+    return ids;
+}
+
+/**
+ * @brief Bytes taken by the columns
+ * @details Time complexity: O(k) where k is the number of irregular ids
+ */
+size_t EnrollmentColumns::getMemoryUsage() const {
+    size_t bytes = sizeof(*this) + dictionary.capacity() * sizeof(UcClass) + idDeltas.capacity() + names.capacity()
+                   + classCounts.capacity() + classCodes.capacity() * sizeof(uint16_t)
+                   + irregularIds.capacity() * sizeof(pair<size_t, string>);
+    for (const pair<size_t, string> &irregular : irregularIds) bytes += irregular.second.capacity();
+    return bytes;
+}
+
+/**
+ * @brief Path of the .col file that goes with a csv file (its extension replaced, or appended)
+ * @details Time complexity: O(n) where n is the length of the path
+ */
+string EnrollmentColumns::pathFor(const string &csvPath) {
+    if (csvPath.size() >= 4 && csvPath.compare(csvPath.size() - 4, 4, ".csv") == 0) {
+        return csvPath.substr(0, csvPath.size() - 4) + ".col";
+    }
+    return csvPath + ".col";
+}
+
+/**
+ * @brief Checks if a file exists and was modified at the same time or after another one (or the other doesn't exist)
+ * @details Used to load the .col instead of the csv only when the csv wasn't changed after it.\n
+ * Time complexity: O(1)
+ */
+bool EnrollmentColumns::isNewer(const string &path, const string &other) {
+    struct stat info, otherInfo;
+    if (stat(path.c_str(), &info) != 0) return false;
+    if (stat(other.c_str(), &otherInfo) != 0) return true;
+    if (info.st_mtim.tv_sec != otherInfo.st_mtim.tv_sec) return info.st_mtim.tv_sec > otherInfo.st_mtim.tv_sec;
+    return info.st_mtim.tv_nsec >= otherInfo.st_mtim.tv_nsec;
+}
+
+/**
+ * @brief Constructor, the cursor starts before the first student
+ * @details Time complexity: O(1)
+ */
+EnrollmentColumns::Cursor::Cursor(const EnrollmentColumns &columns) : columns(columns) {
+    this->index = columns.numStudents;
+    this->idOffset = 0;
+    this->nameOffset = 0;
+    this->classOffset = 0;
+    this->irregular = 0;
+    this->key = 0;
+}
+
+/**
+ * @brief Moves to the next student
+ * @details Time complexity: O(n) where n is the length of the name of the current student
+ * @return false if there are no more students
+ */
+bool EnrollmentColumns::Cursor::next() {
+    if (index == columns.numStudents) {
+        if (idOffset != 0 || columns.numStudents == 0) return false; // already at the end
+        index = 0;
+    } else {
+        nameOffset += strlen(columns.names.c_str() + nameOffset) + 1;
+        classOffset += columns.classCounts[index];
+        if (++index == columns.numStudents) return false;
+    }
+    uint64_t delta;
+    getVarint(columns.idDeltas.data(), columns.idDeltas.size(), idOffset, delta);
+    key += delta;
+    if (irregular < columns.irregularIds.size() && columns.irregularIds[irregular].first == index) {
+        id = columns.irregularIds[irregular++].second;
+    } else {
+        toDecimal(key, id);
+    }
+    return true;
+}
+
+/**
+ * @brief Id of the current student
+ * @details Time complexity: O(1)
+ */
+const string &EnrollmentColumns::Cursor::getId() const {
+    return id;
+}
+
+/**
+ * @brief Name of the current student
+ * @details Time complexity: O(1)
+ */
+const char *EnrollmentColumns::Cursor::getName() const {
+    return columns.names.c_str() + nameOffset;
+}
+
+/**
+ * @brief Number of classes of the current student
+ * @details Time complexity: O(1)
+ */
+size_t EnrollmentColumns::Cursor::getNumberOfClasses() const {
+    return columns.classCounts[index];
+}
+
+/**
+ * @brief Class c of the current student
+ * @details Time complexity: O(1)
+ */
+const UcClass &EnrollmentColumns::Cursor::getClass(size_t c) const {
+    return columns.dictionary[columns.classCodes[classOffset + c]];
+}
+
+/**
+ * @brief Code (position in the dictionary) of class c of the current student
+ * @details Time complexity: O(1)
+ */
+uint16_t EnrollmentColumns::Cursor::getClassCode(size_t c) const {
+    return columns.classCodes[classOffset + c];
+}
@@ -0,0 +1,98 @@
+#ifndef TRABALHO_ENROLLMENTCOLUMNS_H
+#define TRABALHO_ENROLLMENTCOLUMNS_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include <iostream>
+#include "Student.h"
+
+/**
+ * @brief Compact, read only copy of the enrollments of every student, stored by columns
+ * @details students_classes.csv repeats the number and name of a student and the codes of the UC and class on every
+ * row. Here each column is encoded on its own: the students are sorted by number and each number is stored as the
+ * varint difference to the previous one, the names are stored once per student (one after the other, ended by '\0'),
+ * and every class is a 16 bit code into a dictionary of the UcClass that appear. The ids that are not the decimal
+ * form of their number (leading zeros, letters) are kept verbatim on the side.
+ * The same columns are written to a binary file (the .col next to the csv) that is several times smaller than the
+ * csv and loads without parsing text, and they are a cheap snapshot of the students to write in the background.
+ * The students are read in order with a Cursor.
+ */
+class EnrollmentColumns {
+    public:
+        /** @brief Largest number of different classes, their codes are 16 bits */
+        static const size_t MAX_CLASSES = 65535;
+        /** @brief Largest number of classes of a student, their count is 8 bits */
+        static const size_t MAX_CLASSES_PER_STUDENT = 255;
+
+        /** @brief Reads the students in order, decoding the columns as it goes */
+        class Cursor {
+            public:
+                explicit Cursor(const EnrollmentColumns &columns);
+                bool next();
+                const string &getId() const;
+                const char *getName() const;
+                size_t getNumberOfClasses() const;
+                const UcClass &getClass(size_t c) const;
+                uint16_t getClassCode(size_t c) const;
+
+            private:
+                const EnrollmentColumns &columns;
+                /** @brief Index of the current student (the number of students before the first next()) */
+                size_t index;
+                /** @brief Position of the next varint in idDeltas */
+                size_t idOffset;
+                /** @brief Position of the name of the current student in names */
+                size_t nameOffset;
+                /** @brief Position of the first class of the current student in classCodes */
+                size_t classOffset;
+                /** @brief Position of the next irregular id */
+                size_t irregular;
+                /** @brief Number of the current student */
+                uint64_t key;
+                /** @brief Id of the current student */
+                string id;
+        };
+
+        EnrollmentColumns();
+
+        bool build(const StudentSet &students);
+        bool readCsv(const string &path);
+        void writeCsv(ostream &out) const;
+        bool load(const string &path);
+        bool save(const string &path) const;
+
+        size_t size() const;
+        size_t getNumberOfEnrollments() const;
+        const vector<UcClass> &getDictionary() const;
+        vector<string> studentsOfUc(const string &ucId) const;
+        size_t getMemoryUsage() const;
+
+        static string pathFor(const string &csvPath);
+        static bool isNewer(const string &path, const string &other);
+
+    private:
+        void clear();
+        bool codeOf(const UcClass &ucClass, unordered_map<UcClass, uint16_t, UcClassHash> &codes, uint16_t &code);
+        void appendStudent(uint64_t key, const string &id, const char *name, size_t nameLength, uint64_t &previousKey);
+        string serialize() const;
+        bool deserialize(const string &data);
+
+        /** @brief Classes that appear, a class is stored as its position here */
+        vector<UcClass> dictionary;
+        /** @brief Varint difference between the number of each student and the previous one (the first from 0) */
+        vector<uint8_t> idDeltas;
+        /** @brief Ids that are not the decimal form of their number, with the index of their student, by index */
+        vector<pair<size_t, string>> irregularIds;
+        /** @brief Name of each student, in order and ended by '\0' */
+        string names;
+        /** @brief Number of classes of each student */
+        vector<uint8_t> classCounts;
+        /** @brief Classes of every student, in order, as positions in the dictionary */
+        vector<uint16_t> classCodes;
+        /** @brief Number of students */
+        size_t numStudents;
+};
+
+#endif //TRABALHO_ENROLLMENTCOLUMNS_H
@@ -0,0 +1,205 @@
+#include "FreeTimeFinder.h"
+#include "Stats.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Constructor, computes the mask of every class
+ * @details Time complexity: O(n * l) where n is the number of schedules and l the number of slots of a schedule
+ * @param manager ScheduleManager with the files already read
+ * @param dayStart,dayEnd hours of the day considered, rounded out to half hours
+ * @param minHours shortest window reported
+ * @param numDays weekdays considered, from Monday (5 is Monday to Friday)
+ */
+FreeTimeFinder::FreeTimeFinder(const ScheduleManager &manager, float dayStart, float dayEnd, float minHours,
+                               int numDays) : manager(manager) {
+    this->dayMask = WeekMask::hoursMask(dayStart, dayEnd);
+    this->minBuckets = max(1, (int) ceil(minHours * 2));
+    this->numDays = max(0, min(numDays, (int) WeekMask::DAYS));
+    this->numStudents = 0;
+    const vector<ClassSchedule> &schedules = manager.getSchedules();
+    classMasks.resize(schedules.size());
+    tableBits = 4;
+    while ((size_t(1) << tableBits) < 2 * schedules.size()) tableBits++;
+    classTable.assign(size_t(1) << tableBits, ClassEntry{nullptr, nullptr, 0});
+    for (size_t i = 0; i < schedules.size(); i++) {
+        for (const Slot &slot : schedules[i].getSlots()) classMasks[i].addSlot(slot);
+        const UcClass &ucClass = schedules[i].getUcClass();
+        classTable[slotOf(ucClass)] = {&ucClass.getUcId(), &ucClass.getClassId(), (uint32_t) i};
+    }
+}
+
+/**
+ * @brief Slot of the table that has the class or, if it isn't there, the empty slot where it goes
+ * @details Time complexity: O(1) expected
+ */
+size_t FreeTimeFinder::slotOf(const UcClass &ucClass) const {
+    const string *ucId = &ucClass.getUcId(), *classId = &ucClass.getClassId();
+    uint64_t hash = ((uint64_t) (uintptr_t) ucId * 31 + (uint64_t) (uintptr_t) classId) * 11400714819323198485ULL;
+    size_t mask = classTable.size() - 1, slot = hash >> (64 - tableBits);
+    while (classTable[slot].ucId != nullptr && (classTable[slot].ucId != ucId || classTable[slot].classId != classId)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Half hours taken by a class, nullptr if it isn't a class of the schedules
+ * @details Time complexity: O(1) expected
+ */
+const WeekMask *FreeTimeFinder::maskOf(const UcClass &ucClass) const {
+    const ClassEntry &entry = classTable[slotOf(ucClass)];
+    return entry.ucId == nullptr ? nullptr : &classMasks[entry.mask];
+}
+
+/**
+ * @brief Adds the classes of a student to the busy time of the group
+ * @details Time complexity: O(t) where t is the number of classes of the student
+ */
+void FreeTimeFinder::addStudent(const Student &student) {
+    WeekMask taken;
+    for (const UcClass &ucClass : student.getClasses()) {
+        const WeekMask *mask = maskOf(ucClass);
+        if (mask != nullptr) taken |= *mask;
+    }
+    busy |= taken;
+    numStudents++;
+}
+
+/**
+ * @brief Finds the students of the ids gathered in idBuffer and adds their classes to the busy time of the group
+ * @details The students are found in one batch and the classes of a student are prefetched a few students before
+ * they are read, since the students of a group are scattered in memory.\n
+ * Time complexity: O(k * t) where k is the number of ids and t the number of classes of a student
+ */
+void FreeTimeFinder::addStudents() {
+    static const size_t AHEAD = 8;
+    manager.findStudents(idBuffer, foundBuffer);
+    for (size_t i = 0; i < foundBuffer.size(); i++) {
+        if (i + AHEAD < foundBuffer.size() && foundBuffer[i + AHEAD] != nullptr) {
+            __builtin_prefetch(foundBuffer[i + AHEAD]->getClasses().data());
+        }
+        if (foundBuffer[i] == nullptr) unknown.push_back(*idBuffer[i]);
+        else addStudent(*foundBuffer[i]);
+    }
+}
+
+/**
+ * @brief Finds the windows in which every student of a group is free
+ * @details Time complexity: O(g * t) where g is the number of students of the group and t the number of classes of
+ * a student
+ * @param studentIds UP numbers of the students, the ones not found are ignored (@see getUnknown())
+ * @return number of windows found
+ */
+size_t FreeTimeFinder::find(const vector<string> &studentIds) {
+    STATS_TIMER("freeTime.find");
+    busy.clear();
+    numStudents = 0;
+    unknown.clear();
+    idBuffer.clear();
+    for (const string &id : studentIds) idBuffer.push_back(&id);
+    addStudents();
+    computeWindows();
+    return windows.size();
+}
+
+/**
+ * @brief Finds the windows in which every student of a class is free
+ * @details The students of the class are looked up, so their current classes are used.\n
+ * Time complexity: O(log n + q * t) where n is the number of schedules, q the number of students of the class and
+ * t the number of classes of a student
+ * @return number of windows found (0 if the class doesn't exist or has no students)
+ */
+size_t FreeTimeFinder::findForClass(const UcClass &ucClass) {
+    STATS_TIMER("freeTime.findForClass");
+    busy.clear();
+    numStudents = 0;
+    unknown.clear();
+    idBuffer.clear();
+    const ClassSchedule *cs = manager.findSchedule(ucClass);
+    if (cs != nullptr) {
+        for (const Student &member : cs->getStudents()) idBuffer.push_back(&member.getId());
+    }
+    addStudents();
+    unknown.clear(); // members that left the school since the roster was copied
+    computeWindows();
+    return windows.size();
+}
+
+/**
+ * @brief Extracts the runs of free half hours of each weekday that are long enough
+ * @details Time complexity: O(d * w) where d is the number of weekdays and w the number of windows of a day
+ */
+void FreeTimeFinder::computeWindows() {
+    windows.clear();
+    if (numStudents == 0) return;
+    WeekMask free;
+    for (int day = 0; day < numDays; day++) free.days[day] = ~busy.days[day];
+    WeekMask considered;
+    for (int day = 0; day < numDays; day++) considered.days[day] = dayMask;
+    free &= considered;
+    for (int day = 0; day < numDays; day++) {
+        uint64_t bits = free.days[day];
+        while (bits != 0) {
+            int begin = __builtin_ctzll(bits);
+            uint64_t rest = ~bits >> begin; // zeros where the run continues
+            int length = rest == 0 ? 64 - begin : __builtin_ctzll(rest);
+            if (length >= minBuckets) windows.push_back({day, begin / 2.0f, (begin + length) / 2.0f});
+            bits &= length + begin >= 64 ? 0 : ~uint64_t(0) << (begin + length);
+        }
+    }
+}
+
+/**
+ * @brief Windows of the last search, by weekday and start
+ * @details Time complexity: O(1)
+ */
+const vector<FreeTimeFinder::Window> &FreeTimeFinder::getWindows() const {
+    return windows;
+}
+
+/**
+ * @brief UP numbers of the last search that were not found
+ * @details Time complexity: O(1)
+ */
+const vector<string> &FreeTimeFinder::getUnknown() const {
+    return unknown;
+}
+
+/**
+ * @brief Number of students of the last search that were found
+ * @details Time complexity: O(1)
+ */
+size_t FreeTimeFinder::getNumberOfStudents() const {
+    return numStudents;
+}
+
+/**
+ * @brief Prints the windows of the last search, by weekday
+ * @details Time complexity: O(d + w) where d is the number of weekdays and w the number of windows
+ */
+void FreeTimeFinder::printWindows(ostream &out) const {
+    if (!unknown.empty()) {
+        out << ">> Students not found:";
+        for (const string &id : unknown) out << " " << id;
+        out << endl;
+    }
+    if (numStudents == 0) {
+        out << ">> No students to compare." << endl;
+        return;
+    }
+    out << ">> Common free time of " << numStudents << (numStudents == 1 ? " student:" : " students:") << endl;
+    size_t w = 0;
+    for (int day = 0; day < numDays; day++) {
+        out << "   >> " << WeekMask::dayName(day) << ":";
+        bool any = false;
+        for (; w < windows.size() && windows[w].day == day; w++) {
+            out << (any ? ", " : " ") << WeekMask::bucketToHours((int) (windows[w].start * 2)) << " to "
+                << WeekMask::bucketToHours((int) (windows[w].end * 2));
+            any = true;
+        }
+        out << (any ? "" : " none") << endl;
+    }
+}
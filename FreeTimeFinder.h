@@ -0,0 +1,82 @@
+#ifndef TRABALHO_FREETIMEFINDER_H
+#define TRABALHO_FREETIMEFINDER_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "ScheduleManager.h"
+#include "WeekMask.h"
+
+/**
+ * @brief Finds the periods of the week in which every student of a group is free
+ * @details The half hours taken by each class are computed once as a WeekMask. The mask of a student is the OR of
+ * the masks of his classes and the busy time of the group the OR of the masks of its students; the free half hours
+ * are the ones not busy, ANDed with the hours of the day that are considered. Each OR is 8 words and the mask of a
+ * class is found in a flat table by the addresses of its interned codes, so most of the time goes to finding the
+ * students, which is done in one pipelined batch (@see ScheduleManager::findStudents()).
+ */
+class FreeTimeFinder {
+    public:
+        /** @brief Period in which every student of the group is free */
+        struct Window {
+            /** @brief Index of the weekday (Monday is 0) */
+            int day;
+            float start;
+            float end;
+        };
+
+        explicit FreeTimeFinder(const ScheduleManager &manager, float dayStart = 8, float dayEnd = 20,
+                                float minHours = 1, int numDays = 5);
+
+        size_t find(const vector<string> &studentIds);
+        size_t findForClass(const UcClass &ucClass);
+        const vector<Window> &getWindows() const;
+        const vector<string> &getUnknown() const;
+        size_t getNumberOfStudents() const;
+        void printWindows(ostream &out = cout) const;
+
+    private:
+        /** @brief Entry of the table of classes: the interned codes of a class and the position of its mask */
+        struct ClassEntry {
+            const string *ucId;
+            const string *classId;
+            uint32_t mask;
+        };
+
+        size_t slotOf(const UcClass &ucClass) const;
+        const WeekMask *maskOf(const UcClass &ucClass) const;
+        void addStudent(const Student &student);
+        void addStudents();
+        void computeWindows();
+
+        /** @brief ScheduleManager of the students and classes */
+        const ScheduleManager &manager;
+        /** @brief Half hours taken by each class, in the order of the schedules */
+        vector<WeekMask> classMasks;
+        /** @brief Flat hash table (linear probing) from the codes of a class to its mask, the codes are interned so
+         * they are compared by address */
+        vector<ClassEntry> classTable;
+        /** @brief log2 of the size of classTable */
+        int tableBits;
+        /** @brief Half hours of the day considered */
+        uint64_t dayMask;
+        /** @brief Shortest window found, in half hours */
+        int minBuckets;
+        /** @brief Weekdays considered, from Monday */
+        int numDays;
+
+        /** @brief Half hours in which a student of the group has a class */
+        WeekMask busy;
+        /** @brief Number of students of the group found */
+        size_t numStudents;
+        /** @brief Ids of the group that were not found */
+        vector<string> unknown;
+        /** @brief Windows found, by weekday and start */
+        vector<Window> windows;
+        /** @brief Ids of the group being searched, kept between searches to reuse the memory */
+        vector<const string *> idBuffer;
+        /** @brief Students of the ids in idBuffer */
+        vector<Student *> foundBuffer;
+};
+
+#endif //TRABALHO_FREETIMEFINDER_H
@@ -0,0 +1,172 @@
+#include "IntegrityChecker.h"
+#include "ThreadPool.h"
+#include "Stats.h"
+#include <algorithm>
+#include <unordered_map>
+
+/**
+ * @brief Constructor
+ * @details Time complexity: O(1)
+ * @param manager ScheduleManager to check, it must not change while it is checked
+ */
+IntegrityChecker::IntegrityChecker(const ScheduleManager &manager) : manager(manager) {
+    this->enrollments = 0;
+}
+
+/**
+ * @brief Checks the classes of every student against the students of every class
+ * @details First pass (chunks of students in parallel): each class of a student is looked up in a hash table of the
+ * schedules, must be the only one of its UC, and the student is appended to the expected students of the class. The
+ * students are visited in the order of the set, so the expected students of each class come out in the same order as
+ * the students of the class. Second pass (the classes in parallel): the expected and the real students of each class
+ * are merged in one walk, a student only in the class is looked up to tell if it doesn't exist or doesn't have the
+ * class.\n
+ * Time complexity: O(e / w) + O(d * log p) where e is the number of enrollments, w the number of workers, d the
+ * number of divergences and p the number of students
+ * @param numThreads number of workers (0 uses the number of hardware threads)
+ * @return number of divergences found
+ */
+size_t IntegrityChecker::check(unsigned numThreads) {
+    STATS_TIMER("integrity.check");
+    const vector<ClassSchedule> &schedules = manager.getSchedules();
+    unordered_map<UcClass, unsigned long, UcClassHash> indexOf;
+    for (size_t i = 0; i < schedules.size(); i++) indexOf.emplace(schedules[i].getUcClass(), i);
+    vector<const Student*> students;
+    students.reserve(manager.getStudents().size());
+    for (const Student &student : manager.getStudents()) students.push_back(&student);
+
+    // what a worker found in its chunk of students
+    struct Partial {
+        vector<Divergence> divergences;
+        vector<vector<const Student*>> expected; // students of the chunk that have each class
+        size_t enrollments = 0;
+    };
+    ThreadPool pool(numThreads);
+    size_t chunks = min<size_t>(max<size_t>(students.size(), 1), pool.size() * 4);
+    size_t chunkSize = (students.size() + chunks - 1) / chunks;
+    vector<Partial> partials(chunks);
+    for (size_t c = 0; c < chunks; c++) {
+        pool.submit([&, c] {
+            Partial &partial = partials[c];
+            partial.expected.resize(schedules.size());
+            for (size_t s = c * chunkSize; s < min(students.size(), (c + 1) * chunkSize); s++) {
+                const Student &student = *students[s];
+                const UcClassList &classes = student.getClasses();
+                for (size_t j = 0; j < classes.size(); j++) {
+                    const UcClass &ucClass = classes[j];
+                    partial.enrollments++;
+                    bool repeated = false;
+                    for (size_t k = 0; k < j; k++) {
+                        if (!classes[k].sameUcId(ucClass)) continue;
+                        partial.divergences.push_back({DUPLICATE_UC, student.getId(), ucClass});
+                        repeated = classes[k] == ucClass;
+                        break;
+                    }
+                    auto index = indexOf.find(ucClass);
+                    if (index == indexOf.end()) partial.divergences.push_back({UNKNOWN_CLASS, student.getId(), ucClass});
+                    else if (!repeated) partial.expected[index->second].push_back(&student);
+                }
+            }
+        });
+    }
+    pool.wait();
+
+    vector<vector<Divergence>> perClass(schedules.size());
+    for (size_t i = 0; i < schedules.size(); i++) {
+        pool.submit([&, i] {
+            const StudentSet &roster = schedules[i].getStudents();
+            const UcClass &ucClass = schedules[i].getUcClass();
+            auto copy = roster.begin();
+            for (const Partial &partial : partials) {
+                for (const Student *student : partial.expected[i]) {
+                    int order = -1;
+                    for (; copy != roster.end() && (order = copy->getId().compare(student->getId())) < 0; copy++) {
+                        perClass[i].push_back({manager.findStudent(copy->getId()) == nullptr ? UNKNOWN_STUDENT : MISSING_IN_STUDENT, copy->getId(), ucClass});
+                    }
+                    if (order == 0) copy++;
+                    else perClass[i].push_back({MISSING_IN_CLASS, student->getId(), ucClass});
+                }
+            }
+            for (; copy != roster.end(); copy++) {
+                perClass[i].push_back({manager.findStudent(copy->getId()) == nullptr ? UNKNOWN_STUDENT : MISSING_IN_STUDENT, copy->getId(), ucClass});
+            }
+        });
+    }
+    pool.wait();
+
+    divergences.clear();
+    enrollments = 0;
+    for (const Partial &partial : partials) {
+        divergences.insert(divergences.end(), partial.divergences.begin(), partial.divergences.end());
+        enrollments += partial.enrollments;
+    }
+    for (const vector<Divergence> &classDivergences : perClass) {
+        divergences.insert(divergences.end(), classDivergences.begin(), classDivergences.end());
+    }
+    if (!divergences.empty()) STATS_COUNT("integrity.inconsistent");
+    return divergences.size();
+}
+
+/**
+ * @brief Checks if the last check() found no divergences
+ * @details Time complexity: O(1)
+ */
+bool IntegrityChecker::isConsistent() const {
+    return divergences.empty();
+}
+
+/**
+ * @brief Divergences found by the last check()
+ * @details Time complexity: O(1)
+ */
+const vector<IntegrityChecker::Divergence> &IntegrityChecker::getDivergences() const {
+    return divergences;
+}
+
+/**
+ * @brief Number of classes of every student, counted by the last check()
+ * @details Time complexity: O(1)
+ */
+size_t IntegrityChecker::getNumberOfEnrollments() const {
+    return enrollments;
+}
+
+/**
+ * @brief Prints the number of divergences of each kind and the first ones found
+ * @details Time complexity: O(d) where d is the number of divergences
+ * @param maxListed number of divergences listed
+ */
+void IntegrityChecker::printReport(ostream &out, size_t maxListed) const {
+    out << ">> " << enrollments << " enrollments checked." << endl;
+    if (divergences.empty()) {
+        out << ">> The students and the classes are consistent." << endl;
+        return;
+    }
+    size_t counts[KINDS] = {};
+    for (const Divergence &divergence : divergences) counts[divergence.kind]++;
+    out << ">> " << divergences.size() << " divergences:" << endl;
+    for (int kind = 0; kind < KINDS; kind++) {
+        if (counts[kind] > 0) out << "   " << counts[kind] << " - " << kindToString((Kind) kind) << endl;
+    }
+    for (size_t i = 0; i < divergences.size() && i < maxListed; i++) {
+        const Divergence &divergence = divergences[i];
+        out << "   " << divergence.studentId << " " << divergence.ucClass.getUcId() << " "
+            << divergence.ucClass.getClassId() << ": " << kindToString(divergence.kind) << endl;
+    }
+    if (divergences.size() > maxListed) out << "   ... and " << divergences.size() - maxListed << " more" << endl;
+}
+
+/**
+ * @brief Description of a kind of divergence
+ * @details Time complexity: O(1)
+ */
+string IntegrityChecker::kindToString(Kind kind) {
+    switch (kind) {
+        case UNKNOWN_CLASS: return "class of the student not in the schedules";
+        case MISSING_IN_CLASS: return "student missing from the students of the class";
+        case DUPLICATE_UC: return "student with more than one class of the uc";
+        case UNKNOWN_STUDENT: return "student of the class doesn't exist";
+        case MISSING_IN_STUDENT: return "class missing from the classes of the student";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef TRABALHO_INTEGRITYCHECKER_H
+#define TRABALHO_INTEGRITYCHECKER_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "ScheduleManager.h"
+
+/**
+ * @brief Cross-checks the two copies of the enrollments: the classes of each student and the students of each class
+ * @details Every class of a student must exist in the schedules, have the student in its students and be the only
+ * class of its UC in the student. Every student of a class must exist and have that class. The students of a class
+ * are copies taken when they were added (their classes are not kept up to date), so only their ids are compared.
+ * The students are split in chunks between the workers of a pool, which build the expected students of each class
+ * in the order of the set, then each class is merged with its expected students in one walk.
+ */
+class IntegrityChecker {
+    public:
+        /** @brief Kind of divergence between the two copies */
+        enum Kind {
+            /** @brief The student has a class that is not in the schedules */
+            UNKNOWN_CLASS,
+            /** @brief The student has a class that doesn't have the student */
+            MISSING_IN_CLASS,
+            /** @brief The student has more than one class of a UC */
+            DUPLICATE_UC,
+            /** @brief A class has a student that doesn't exist */
+            UNKNOWN_STUDENT,
+            /** @brief A class has a student that doesn't have the class */
+            MISSING_IN_STUDENT,
+            KINDS
+        };
+
+        /** @brief Divergence found, with the student and the class involved */
+        struct Divergence {
+            Kind kind;
+            string studentId;
+            UcClass ucClass;
+        };
+
+        explicit IntegrityChecker(const ScheduleManager &manager);
+
+        size_t check(unsigned numThreads = 0);
+        bool isConsistent() const;
+        const vector<Divergence> &getDivergences() const;
+        size_t getNumberOfEnrollments() const;
+        void printReport(ostream &out = cout, size_t maxListed = 20) const;
+        static string kindToString(Kind kind);
+
+    private:
+        /** @brief ScheduleManager that is checked */
+        const ScheduleManager &manager;
+        /** @brief Divergences found by the last check(), grouped by the side where they were found */
+        vector<Divergence> divergences;
+        /** @brief Number of classes of every student */
+        size_t enrollments;
+};
+
+#endif //TRABALHO_INTEGRITYCHECKER_H
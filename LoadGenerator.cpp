@@ -0,0 +1,153 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+/**
+ * @brief Load generator for the query server (trabalho --serve)
+ * @details Opens several connections, each one sends read queries (student, class and UC schedules and rosters)
+ * built from the students_classes.csv file and waits for the response before sending the next one.
+ * At the end it prints the throughput and the latency percentiles.\n
+ * Usage: loadgen [--socket path] [--clients n] [--requests n] [--data dir]
+ */
+
+/**
+ * @brief Opens a connection to the server
+ * @return socket of the connection, -1 if it failed
+ */
+static int connectTo(const string &socketPath) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if(fd < 0 || connect(fd, (sockaddr*) &address, sizeof(address)) < 0){
+        if(fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief Sends a command and reads the response until the END line
+ * @return false if the connection was closed
+ */
+static bool query(int fd, const string &command, string &buffer) {
+    string line = command + "\n";
+    if(send(fd, line.data(), line.size(), MSG_NOSIGNAL) != (ssize_t) line.size()) return false;
+    char chunk[8192];
+    while(true){
+        size_t end = buffer.find("END\n");
+        if(end != string::npos && (end == 0 || buffer[end - 1] == '\n')){
+            buffer.erase(0, end + 4);
+            return true;
+        }
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if(n <= 0) return false;
+        buffer.append(chunk, n);
+    }
+}
+
+/**
+ * @brief Builds the list of queries from the students_classes.csv file
+ */
+static vector<string> buildQueries(const string &dataDir) {
+    vector<string> queries;
+    const char *orders[] = {"alphabetical", "reverse-alphabetical", "numerical", "reverse-numerical"};
+    fstream file(dataDir + "students_classes.csv");
+    file.ignore(1000, '\n');
+    string line;
+    int i = 0;
+    while(getline(file, line)){
+        if(!line.empty() && line[line.size() - 1] == '\r') line.resize(line.size() - 1);
+        vector<string> row;
+        string word;
+        stringstream str(line);
+        while(getline(str, word, ',')) row.push_back(word);
+        if(row.size() < 4) continue;
+        queries.push_back("STUDENT " + row[0]);
+        switch(i++ % 4){
+            case 0: queries.push_back("CLASS_STUDENTS " + row[2] + " " + row[3] + " " + orders[i % 4]); break;
+            case 1: queries.push_back("UC " + row[2]); break;
+            case 2: queries.push_back("CLASS " + row[3]); break;
+            default: queries.push_back("UC_STUDENTS " + row[2] + " " + orders[i % 4]);
+        }
+    }
+    return queries;
+}
+
+int main(int argc, char **argv) {
+    string socketPath = "/tmp/trabalho.sock", dataDir = "../data/";
+    int clients = 8, requests = 2000;
+    if(argc % 2 == 0){ // an option without its value
+        cerr << "Usage: " << argv[0] << " [--socket path] [--clients n] [--requests n] [--data dir]" << endl;
+        return 1;
+    }
+    for(int i = 1; i + 1 < argc; i += 2){
+        string option = argv[i];
+        if(option == "--socket") socketPath = argv[i + 1];
+        else if(option == "--clients") clients = stoi(argv[i + 1]);
+        else if(option == "--requests") requests = stoi(argv[i + 1]);
+        else if(option == "--data") dataDir = argv[i + 1];
+        else { cerr << "Unknown option " << option << endl; return 1; }
+    }
+    vector<string> queries = buildQueries(dataDir);
+    if(queries.empty()){
+        cerr << "No queries could be built from " << dataDir << "students_classes.csv" << endl;
+        return 1;
+    }
+
+    vector<vector<double>> latencies(clients);
+    vector<int> failures(clients, 0);
+    vector<thread> threads;
+    auto begin = chrono::steady_clock::now();
+    for(int c = 0; c < clients; c++){
+        threads.emplace_back([&, c]{
+            int fd = connectTo(socketPath);
+            if(fd < 0){ failures[c] = requests; return; }
+            mt19937 rng(c);
+            uniform_int_distribution<size_t> pick(0, queries.size() - 1);
+            string buffer;
+            latencies[c].reserve(requests);
+            for(int r = 0; r < requests; r++){
+                auto start = chrono::steady_clock::now();
+                if(!query(fd, queries[pick(rng)], buffer)){ failures[c] += requests - r; break; }
+                latencies[c].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+            }
+            close(fd);
+        });
+    }
+    for(thread &t : threads) t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    vector<double> all;
+    int failed = 0;
+    for(int c = 0; c < clients; c++){
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        failed += failures[c];
+    }
+    if(all.empty()){
+        cerr << "No request succeeded, is the server running on " << socketPath << "?" << endl;
+        return 1;
+    }
+    sort(all.begin(), all.end());
+    auto percentile = [&all](double p){ return all[min(all.size() - 1, (size_t)(p * all.size()))]; };
+    cout << "clients: " << clients << endl
+         << "requests: " << all.size() << " (" << failed << " failed)" << endl
+         << "throughput: " << all.size() / seconds << " req/s" << endl
+         << "latency p50: " << percentile(0.50) << " us" << endl
+         << "latency p90: " << percentile(0.90) << " us" << endl
+         << "latency p99: " << percentile(0.99) << " us" << endl
+         << "latency max: " << all.back() << " us" << endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+#include "MemoryReport.h"
+#include <iomanip>
+#include <sstream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#ifdef SCHEDULER_COUNT_ALLOCATIONS
+/**
+ * Counting allocator: replaces the global operator new and delete of the process. Each block gets a header with its
+ * size, so that the live bytes can be kept when it is freed.
+ */
+namespace {
+    /** @brief Bytes of the header, keeps the blocks aligned to 16 bytes */
+    const size_t HEADER = 16;
+    atomic<size_t> liveBytes(0);
+    atomic<size_t> liveAllocations(0);
+    atomic<size_t> totalAllocations(0);
+
+    void *countedAllocate(size_t size) {
+        void *block = malloc(size + HEADER);
+        if (block == nullptr) return nullptr;
+        *static_cast<size_t*>(block) = size;
+        liveBytes.fetch_add(size, memory_order_relaxed);
+        liveAllocations.fetch_add(1, memory_order_relaxed);
+        totalAllocations.fetch_add(1, memory_order_relaxed);
+        return static_cast<char*>(block) + HEADER;
+    }
+
+    void countedFree(void *pointer) {
+        if (pointer == nullptr) return;
+        char *block = static_cast<char*>(pointer) - HEADER;
+        liveBytes.fetch_sub(*reinterpret_cast<size_t*>(block), memory_order_relaxed);
+        liveAllocations.fetch_sub(1, memory_order_relaxed);
+        free(block);
+    }
+}
+
+void *operator new(size_t size) {
+    void *pointer = countedAllocate(size);
+    if (pointer == nullptr) throw bad_alloc();
+    return pointer;
+}
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+void *operator new(size_t size, const nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+void *operator new[](size_t size, const nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+void operator delete(void *pointer) noexcept {
+    countedFree(pointer);
+}
+void operator delete[](void *pointer) noexcept {
+    countedFree(pointer);
+}
+void operator delete(void *pointer, size_t) noexcept {
+    countedFree(pointer);
+}
+void operator delete[](void *pointer, size_t) noexcept {
+    countedFree(pointer);
+}
+void operator delete(void *pointer, const nothrow_t &) noexcept {
+    countedFree(pointer);
+}
+void operator delete[](void *pointer, const nothrow_t &) noexcept {
+    countedFree(pointer);
+}
+#endif
+
+const size_t MemoryReport::SET_NODE_OVERHEAD;
+
+/**
+ * @brief Constructor, creates an empty report
+ * @details Time complexity: O(1)
+ */
+MemoryReport::MemoryReport() {
+    this->numStudents = 0;
+}
+
+/**
+ * @brief Adds bytes, objects and allocations to a category, created if it doesn't exist yet
+ * @details Time complexity: O(c) where c is the number of categories
+ */
+void MemoryReport::add(const string &category, size_t bytes, size_t objects, size_t allocations) {
+    for (Category &existing : categories) {
+        if (existing.name == category) {
+            existing.bytes += bytes;
+            existing.objects += objects;
+            existing.allocations += allocations;
+            return;
+        }
+    }
+    categories.push_back({category, bytes, objects, allocations});
+}
+
+/**
+ * @brief Sets the number of students, used to print the footprint per 100000 students
+ * @details Time complexity: O(1)
+ */
+void MemoryReport::setNumberOfStudents(size_t numStudents) {
+    this->numStudents = numStudents;
+}
+
+/**
+ * @brief Categories in the order they were first added
+ * @details Time complexity: O(1)
+ */
+const vector<MemoryReport::Category> &MemoryReport::getCategories() const {
+    return categories;
+}
+
+/**
+ * @brief Sum of the bytes of every category
+ * @details Time complexity: O(c) where c is the number of categories
+ */
+size_t MemoryReport::getTotalBytes() const {
+    size_t total = 0;
+    for (const Category &category : categories) total += category.bytes;
+    return total;
+}
+
+/**
+ * @brief Sum of the allocations of every category
+ * @details Time complexity: O(c) where c is the number of categories
+ */
+size_t MemoryReport::getTotalAllocations() const {
+    size_t total = 0;
+    for (const Category &category : categories) total += category.allocations;
+    return total;
+}
+
+/**
+ * @brief Bytes of a string outside the string object, 0 if it fits in the object itself (short string optimization)
+ * @details Time complexity: O(1)
+ */
+size_t MemoryReport::heapBytes(const string &text) {
+    static const size_t inlineCapacity = string().capacity();
+    return text.capacity() > inlineCapacity ? text.capacity() + 1 : 0;
+}
+
+/**
+ * @brief Number of heap allocations of a block: 0 if it is null or in the Arena, 1 otherwise
+ * @details Time complexity: O(1)
+ */
+size_t MemoryReport::heapAllocations(const void *block) {
+    return block == nullptr || Arena::instance().owns(block) ? 0 : 1;
+}
+
+/**
+ * @brief Adds what a student holds outside its record: the heap part of its id and name and the vector of its classes
+ * @details Time complexity: O(1)
+ */
+void MemoryReport::addStudent(const Student &student, size_t &bytes, size_t &allocations) {
+    bytes += heapBytes(student.getId()) + heapBytes(student.getName());
+    allocations += (heapBytes(student.getId()) > 0) + (heapBytes(student.getName()) > 0);
+    addVector(student.getClasses(), bytes, allocations);
+}
+
+/**
+ * @brief Checks if the process was built with the counting allocator
+ * @details Time complexity: O(1)
+ */
+bool MemoryReport::isCounting() {
+#ifdef SCHEDULER_COUNT_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Bytes allocated with operator new and not freed yet, 0 without the counting allocator
+ * @details Time complexity: O(1)
+ */
+size_t MemoryReport::getLiveHeapBytes() {
+#ifdef SCHEDULER_COUNT_ALLOCATIONS
+    return liveBytes.load(memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Blocks allocated with operator new and not freed yet, 0 without the counting allocator
+ * @details Time complexity: O(1)
+ */
+size_t MemoryReport::getLiveHeapAllocations() {
+#ifdef SCHEDULER_COUNT_ALLOCATIONS
+    return liveAllocations.load(memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Blocks allocated with operator new since the process started, 0 without the counting allocator
+ * @details Time complexity: O(1)
+ */
+size_t MemoryReport::getHeapAllocations() {
+#ifdef SCHEDULER_COUNT_ALLOCATIONS
+    return totalAllocations.load(memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Writes a number of bytes with the largest unit that keeps it above 1
+ * @details Time complexity: O(1)
+ */
+string MemoryReport::formatBytes(double bytes) {
+    ostringstream text;
+    text << fixed << setprecision(1);
+    if (bytes >= 1024.0 * 1024 * 1024) text << bytes / (1024.0 * 1024 * 1024) << " GB";
+    else if (bytes >= 1024 * 1024) text << bytes / (1024 * 1024) << " MB";
+    else if (bytes >= 1024) text << bytes / 1024 << " KB";
+    else text << setprecision(0) << bytes << " B";
+    return text.str();
+}
+
+/**
+ * @brief Prints a table with the bytes, objects and allocations of each category, the totals, the footprint per
+ * 100000 students, the use of the Arena and, with the counting allocator, the live heap
+ * @details Time complexity: O(c) where c is the number of categories
+ */
+void MemoryReport::print(ostream &out) const {
+    out << ">> Memory of " << numStudents << " students, by structure:" << endl;
+    out << "   " << left << setw(48) << "Category" << right << setw(12) << "Bytes" << setw(12) << "Objects"
+        << setw(13) << "Allocations" << endl;
+    for (const Category &category : categories) {
+        out << "   " << left << setw(48) << category.name << right << setw(12) << formatBytes(category.bytes)
+            << setw(12) << category.objects << setw(13) << category.allocations << endl;
+    }
+    size_t total = getTotalBytes();
+    out << "   " << left << setw(48) << "Total" << right << setw(12) << formatBytes(total) << setw(12) << ""
+        << setw(13) << getTotalAllocations() << endl;
+    if (numStudents > 0) out << ">> Per 100000 students: " << formatBytes(total * 100000.0 / numStudents) << endl;
+    const Arena &arena = Arena::instance();
+    out << ">> Arena: " << formatBytes(arena.getUsed()) << " used of " << formatBytes(arena.getCapacity())
+        << " reserved (structures built while reading the files, included above)" << endl;
+    if (isCounting()) {
+        out << ">> Heap of the whole process (counted): " << formatBytes(getLiveHeapBytes()) << " live in "
+            << getLiveHeapAllocations() << " blocks, " << getHeapAllocations() << " allocations since the start" << endl;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef TRABALHO_MEMORYREPORT_H
+#define TRABALHO_MEMORYREPORT_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include "Student.h"
+#include "Arena.h"
+
+/**
+ * @brief Memory taken by the structures of a ScheduleManager, by category
+ * @details The structures add themselves to the report (@see ScheduleManager::accountMemory()): for each category the
+ * bytes, the number of objects and the number of heap allocations. The bytes are computed from the sizes of the
+ * objects, the capacities of their buffers and the heap part of their strings (strings that fit in the string itself
+ * take nothing more); tree and list nodes are counted with their links. Blocks in the Arena are counted in the bytes
+ * but not as allocations. The overhead of malloc itself is not included, the counting allocator measures it: when
+ * built with SCHEDULER_COUNT_ALLOCATIONS every operator new of the process is counted and the report compares the
+ * live heap with the estimate.
+ */
+class MemoryReport {
+    public:
+        /** @brief Totals of a category */
+        struct Category {
+            string name;
+            size_t bytes;
+            size_t objects;
+            size_t allocations;
+        };
+
+        /** @brief Bytes of a node of a std::set or std::map besides its value (color, parent and two children) */
+        static const size_t SET_NODE_OVERHEAD = 4 * sizeof(void*);
+
+        MemoryReport();
+
+        void add(const string &category, size_t bytes, size_t objects, size_t allocations);
+        void setNumberOfStudents(size_t numStudents);
+        const vector<Category> &getCategories() const;
+        size_t getTotalBytes() const;
+        size_t getTotalAllocations() const;
+        void print(ostream &out = cout) const;
+
+        static size_t heapBytes(const string &text);
+        static size_t heapAllocations(const void *block);
+        static void addStudent(const Student &student, size_t &bytes, size_t &allocations);
+
+        /**
+         * @brief Adds the buffer of a vector: its capacity and, if it is in the heap, one allocation
+         * @details Time complexity: O(1)
+         */
+        template <class T, class Allocator>
+        static void addVector(const vector<T, Allocator> &values, size_t &bytes, size_t &allocations) {
+            bytes += values.capacity() * sizeof(T);
+            if (values.capacity() > 0) allocations += heapAllocations(values.data());
+        }
+
+        static bool isCounting();
+        static size_t getLiveHeapBytes();
+        static size_t getLiveHeapAllocations();
+        static size_t getHeapAllocations();
+
+    private:
+        static string formatBytes(double bytes);
+
+        /** @brief Categories in the order they were first added */
+        vector<Category> categories;
+        /** @brief Number of students of the ScheduleManager, for the footprint per 100000 students */
+        size_t numStudents;
+};
+
+#endif //TRABALHO_MEMORYREPORT_H
@@ -0,0 +1,165 @@
+#include "OccupancyHeatmap.h"
+#include <algorithm>
+
+using namespace std;
+
+const int OccupancyHeatmap::DAYS;
+const int OccupancyHeatmap::BUCKETS_PER_DAY;
+const int OccupancyHeatmap::CELLS;
+
+/**
+ * @brief Constructor, the heatmap is empty until compute() is called
+ * @details Time complexity: O(1)
+ * @param includeTheoretical if false (default) slots of type T are not counted
+ */
+OccupancyHeatmap::OccupancyHeatmap(bool includeTheoretical) {
+    this->includeTheoretical = includeTheoretical;
+    this->total = vector<uint32_t>(CELLS, 0);
+}
+
+/**
+ * @brief Returns the row of a key, creating it (filled with zeros) if it doesn't exist
+ * @details Time complexity: O(log k) where k is the number of keys
+ */
+uint32_t *OccupancyHeatmap::Breakdown::row(const string &key) {
+    auto it = rows.find(key);
+    if (it == rows.end()) {
+        it = rows.insert({key, (int) keys.size()}).first;
+        keys.push_back(key);
+        cells.resize(cells.size() + CELLS, 0);
+    }
+    return cells.data() + (size_t) it->second * CELLS;
+}
+
+/**
+ * @brief Returns the row of a key, nullptr if it doesn't exist
+ * @details Time complexity: O(log k) where k is the number of keys
+ */
+const uint32_t *OccupancyHeatmap::Breakdown::find(const string &key) const {
+    auto it = rows.find(key);
+    return it == rows.end() ? nullptr : cells.data() + (size_t) it->second * CELLS;
+}
+
+/**
+ * @brief Adds weight to the cells [first, last) of a row
+ * @details The loop has no dependencies between iterations, so the compiler turns it into vector additions.\n
+ * Time complexity: O(last - first)
+ */
+void OccupancyHeatmap::accumulate(uint32_t *row, int first, int last, uint32_t weight) {
+    for (int cell = first; cell < last; cell++) {
+        row[cell] += weight;
+    }
+}
+
+/**
+ * @brief Computes the heatmap of the given schedules
+ * @details Every slot adds the number of students of its class to the buckets it covers (a bucket is covered if the
+ * slot is in session during any part of it) in the total and in the rows of its UC, class code and type.
+ * The rows are created in a first pass so that the arrays are only allocated once.\n
+ * Time complexity: O(n*l*b) where n is the number of schedules, l is the number of slots in a schedule and
+ * b is the number of buckets covered by a slot
+ * @param schedules schedules to count
+ */
+void OccupancyHeatmap::compute(const vector<ClassSchedule> &schedules) {
+    total.assign(CELLS, 0);
+    byUc = Breakdown(); byClass = Breakdown(); byType = Breakdown();
+    for (const ClassSchedule &cs : schedules) {
+        for (const Slot &slot : cs.getSlots()) {
+            if (!includeTheoretical && slot.getType() == "T") continue;
+            byUc.row(cs.getUcClass().getUcId());
+            byClass.row(cs.getUcClass().getClassId());
+            byType.row(slot.getType());
+        }
+    }
+    for (const ClassSchedule &cs : schedules) {
+        uint32_t weight = cs.getNumStudents();
+        if (weight == 0) continue;
+        uint32_t *ucRow = byUc.row(cs.getUcClass().getUcId());
+        uint32_t *classRow = byClass.row(cs.getUcClass().getClassId());
+        for (const Slot &slot : cs.getSlots()) {
+            int day = slot.getWeekDayIndex();
+            if (day < 0 || (!includeTheoretical && slot.getType() == "T")) continue;
+            int first = WeekMask::firstBucket(slot.getStartTime());
+            int last = WeekMask::endBucket(slot.getEndTime());
+            if (first >= last) continue;
+            first += day * BUCKETS_PER_DAY;
+            last += day * BUCKETS_PER_DAY;
+            accumulate(total.data(), first, last, weight);
+            accumulate(ucRow, first, last, weight);
+            accumulate(classRow, first, last, weight);
+            accumulate(byType.row(slot.getType()), first, last, weight);
+        }
+    }
+}
+
+/**
+ * @brief Returns the number of students in classes in a given bucket
+ * @details Time complexity: O(1)
+ * @param day index of the weekday (Monday is 0)
+ * @param bucket index of the 30 minute bucket (0 is 00:00 - 00:30)
+ */
+uint32_t OccupancyHeatmap::getTotal(int day, int bucket) const {
+    return total[day * BUCKETS_PER_DAY + bucket];
+}
+
+/**
+ * @brief Returns the number of students in classes of a UC in a given bucket
+ * @details Time complexity: O(log k) where k is the number of UCs
+ */
+uint32_t OccupancyHeatmap::getUcOccupancy(const string &ucId, int day, int bucket) const {
+    const uint32_t *row = byUc.find(ucId);
+    return row == nullptr ? 0 : row[day * BUCKETS_PER_DAY + bucket];
+}
+
+/**
+ * @brief Writes the non empty cells of a row as CSV lines
+ * @details Time complexity: O(c) where c is the number of cells
+ */
+void OccupancyHeatmap::writeRow(ostream &out, const string &dimension, const string &key, const uint32_t *row) {
+    for (int cell = 0; cell < CELLS; cell++) {
+        if (row[cell] == 0) continue;
+        int bucket = cell % BUCKETS_PER_DAY;
+        out << dimension << "," << key << "," << WeekMask::dayName(cell / BUCKETS_PER_DAY) << ","
+            << WeekMask::bucketToHours(bucket) << "," << WeekMask::bucketToHours(bucket + 1) << "," << row[cell] << "\n";
+    }
+}
+
+/**
+ * @brief Writes the heatmap as CSV (Dimension,Key,Weekday,Start,End,Students), only the non empty cells are written
+ * @details Time complexity: O(k*c) where k is the number of keys of all breakdowns and c is the number of cells
+ */
+void OccupancyHeatmap::writeCsv(ostream &out) const {
+    out << "Dimension,Key,Weekday,Start,End,Students\n";
+    writeRow(out, "Total", "All", total.data());
+    for (size_t i = 0; i < byUc.keys.size(); i++) writeRow(out, "Uc", byUc.keys[i], byUc.cells.data() + i * CELLS);
+    for (size_t i = 0; i < byClass.keys.size(); i++) writeRow(out, "Class", byClass.keys[i], byClass.cells.data() + i * CELLS);
+    for (size_t i = 0; i < byType.keys.size(); i++) writeRow(out, "Type", byType.keys[i], byType.cells.data() + i * CELLS);
+}
+
+/**
+ * @brief Prints the busiest bucket of the week and the UCs grouped by the bucket where they peak
+ * @details Time complexity: O(k*c) where k is the number of UCs and c is the number of cells
+ */
+void OccupancyHeatmap::printPeaks(ostream &out) const {
+    int busiest = (int) (max_element(total.begin(), total.end()) - total.begin());
+    if (total[busiest] == 0) {
+        out << ">> There are no students in classes." << endl;
+        return;
+    }
+    out << ">> Busiest time: " << WeekMask::dayName(busiest / BUCKETS_PER_DAY) << " "
+        << WeekMask::bucketToHours(busiest % BUCKETS_PER_DAY) << " with " << total[busiest] << " students" << endl;
+
+    map<int, vector<string>> ucsByPeak;
+    for (size_t i = 0; i < byUc.keys.size(); i++) {
+        const uint32_t *row = byUc.cells.data() + i * CELLS;
+        int peak = (int) (max_element(row, row + CELLS) - row);
+        if (row[peak] > 0) ucsByPeak[peak].push_back(byUc.keys[i]);
+    }
+    out << ">> UCs that peak at the same time:" << endl;
+    for (const auto &peak : ucsByPeak) {
+        out << "   " << WeekMask::dayName(peak.first / BUCKETS_PER_DAY) << " "
+            << WeekMask::bucketToHours(peak.first % BUCKETS_PER_DAY) << ": ";
+        for (const string &ucId : peak.second) out << ucId << " ";
+        out << endl;
+    }
+}
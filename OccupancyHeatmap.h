@@ -0,0 +1,60 @@
+#ifndef TRABALHO_OCCUPANCYHEATMAP_H
+#define TRABALHO_OCCUPANCYHEATMAP_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <cstdint>
+#include <iostream>
+#include "ClassSchedule.h"
+#include "WeekMask.h"
+
+/**
+ * @brief Number of students sitting in classes per weekday and 30 minute bucket, weighted by the size of each class.
+ * @details Besides the total, the heatmap is broken down by UC, by class code and by slot type. Every breakdown is a
+ * single contiguous array with one row of DAYS * BUCKETS_PER_DAY counters per key.
+ */
+class OccupancyHeatmap {
+    public:
+        static const int DAYS = WeekMask::DAYS;
+        static const int BUCKETS_PER_DAY = WeekMask::BUCKETS_PER_DAY;
+        static const int CELLS = DAYS * BUCKETS_PER_DAY;
+
+        explicit OccupancyHeatmap(bool includeTheoretical = false);
+
+        void compute(const vector<ClassSchedule> &schedules);
+        uint32_t getTotal(int day, int bucket) const;
+        uint32_t getUcOccupancy(const string &ucId, int day, int bucket) const;
+        void writeCsv(ostream &out) const;
+        void printPeaks(ostream &out = cout) const;
+
+    private:
+        /** @brief Rows of counters of one dimension (UC, class code or slot type) */
+        struct Breakdown {
+            /** @brief Key of each row */
+            vector<string> keys;
+            /** @brief Row of each key */
+            map<string, int> rows;
+            /** @brief keys.size() rows of CELLS counters */
+            vector<uint32_t> cells;
+
+            uint32_t *row(const string &key);
+            const uint32_t *find(const string &key) const;
+        };
+
+        static void accumulate(uint32_t *row, int first, int last, uint32_t weight);
+        static void writeRow(ostream &out, const string &dimension, const string &key, const uint32_t *row);
+
+        /** @brief If false, slots of type T are ignored */
+        bool includeTheoretical;
+        /** @brief Occupancy of all the classes */
+        vector<uint32_t> total;
+        /** @brief Occupancy per UC */
+        Breakdown byUc;
+        /** @brief Occupancy per class code */
+        Breakdown byClass;
+        /** @brief Occupancy per slot type */
+        Breakdown byType;
+};
+
+#endif //TRABALHO_OCCUPANCYHEATMAP_H
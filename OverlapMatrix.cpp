@@ -0,0 +1,196 @@
+#include "OverlapMatrix.h"
+#include "MemoryReport.h"
+#include <mutex>
+#include "ThreadPool.h"
+
+using namespace std;
+
+const size_t OverlapMatrix::BLOCK;
+
+/**
+ * @brief Constructor, the matrix is empty until build() is called
+ * @details Time complexity: O(1)
+ */
+OverlapMatrix::OverlapMatrix() {
+    this->n = 0;
+    this->numBlocks = 0;
+}
+
+/**
+ * @brief Stores the slots, day mask and UC of a schedule in the compact form used to compute overlaps
+ * @details Time complexity: O(l) where l is the number of slots of the schedule
+ */
+void OverlapMatrix::prepare(const vector<ClassSchedule> &schedules, size_t index) {
+    slots[index].clear();
+    dayMask[index] = 0;
+    for (const Slot &slot : schedules[index].getSlots()) {
+        int day = slot.getWeekDayIndex();
+        if (day < 0 || slot.getType() == "T") continue;
+        slots[index].push_back({day, slot.getStartTime(), slot.getEndTime()});
+        dayMask[index] |= 1 << day;
+    }
+}
+
+/**
+ * @brief Builds the matrix for the given schedules, the tile rows are computed in parallel
+ * @details A tile is skipped without testing any pair when its rows and columns have no day in common.\n
+ * Time complexity: O(n^2 * l * r / w) where n is the number of schedules, l and r are the number of slots of
+ * each schedule and w is the number of threads
+ * @param schedules schedules ordered by UcClass
+ * @param numThreads number of threads (0 uses the number of hardware threads)
+ */
+void OverlapMatrix::build(const vector<ClassSchedule> &schedules, unsigned numThreads) {
+    ThreadPool pool(numThreads);
+    build(schedules, pool);
+}
+
+/**
+ * @brief Builds the matrix for the given schedules, the tile rows are computed by the workers of an existing pool
+ * @details It waits for every task of the pool, so it must not be called from one of its workers.\n
+ * Time complexity: O(n^2 * l * r / w) where w is the number of workers of the pool
+ * @param schedules schedules ordered by UcClass
+ * @param pool workers that compute the tiles
+ */
+void OverlapMatrix::build(const vector<ClassSchedule> &schedules, ThreadPool &pool) {
+    n = schedules.size();
+    numBlocks = (n + BLOCK - 1) / BLOCK;
+    slots.assign(n, vector<TimeSlot>());
+    dayMask.assign(n, 0);
+    ucIndex.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        prepare(schedules, i);
+        ucIndex[i] = (i > 0 && schedules[i].sameUcId(schedules[i - 1])) ? ucIndex[i - 1] : (int) i;
+    }
+    directory.assign(numBlocks * numBlocks, -1);
+    blocks.clear();
+
+    mutex blocksMutex;
+    for (size_t rowBlock = 0; rowBlock < numBlocks; rowBlock++) {
+        pool.submit([this, rowBlock, &blocksMutex] {
+            vector<pair<size_t, Block>> found;
+            Block block;
+            for (size_t colBlock = 0; colBlock < numBlocks; colBlock++) {
+                if (computeBlock(rowBlock, colBlock, block)) found.emplace_back(colBlock, block);
+            }
+            lock_guard<mutex> lock(blocksMutex);
+            for (const pair<size_t, Block> &b : found) {
+                directory[rowBlock * numBlocks + b.first] = (int) blocks.size();
+                blocks.push_back(b.second);
+            }
+        });
+    }
+    pool.wait();
+}
+
+/**
+ * @brief Computes a tile
+ * @details Time complexity: O(BLOCK^2 * l * r)
+ * @return true if the tile has at least one overlap
+ */
+bool OverlapMatrix::computeBlock(size_t rowBlock, size_t colBlock, Block &block) const {
+    size_t rowEnd = min(n, (rowBlock + 1) * BLOCK), colEnd = min(n, (colBlock + 1) * BLOCK);
+    uint8_t rowDays = 0, colDays = 0;
+    for (size_t i = rowBlock * BLOCK; i < rowEnd; i++) rowDays |= dayMask[i];
+    for (size_t j = colBlock * BLOCK; j < colEnd; j++) colDays |= dayMask[j];
+    block.fill(0);
+    if ((rowDays & colDays) == 0) return false;
+    bool any = false;
+    for (size_t i = rowBlock * BLOCK; i < rowEnd; i++) {
+        uint64_t word = 0;
+        for (size_t j = colBlock * BLOCK; j < colEnd; j++) {
+            if (computeOverlap(i, j)) word |= uint64_t(1) << (j % BLOCK);
+        }
+        block[i % BLOCK] = word;
+        any |= word != 0;
+    }
+    return any;
+}
+
+/**
+ * @brief Tests the slots of two schedules
+ * @details Time complexity: O(l*r) where l and r are the number of slots of each schedule
+ */
+bool OverlapMatrix::computeOverlap(size_t i, size_t j) const {
+    if (ucIndex[i] == ucIndex[j] || (dayMask[i] & dayMask[j]) == 0) return false;
+    for (const TimeSlot &a : slots[i]) {
+        for (const TimeSlot &b : slots[j]) {
+            if (a.day == b.day && a.start < b.end && b.start < a.end) return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Sets a bit, storing the tile if it was empty
+ * @details Time complexity: O(1) amortized
+ */
+void OverlapMatrix::setBit(size_t i, size_t j, bool value) {
+    int &entry = directory[(i / BLOCK) * numBlocks + j / BLOCK];
+    if (entry < 0) {
+        if (!value) return;
+        entry = (int) blocks.size();
+        blocks.emplace_back();
+        blocks.back().fill(0);
+    }
+    uint64_t mask = uint64_t(1) << (j % BLOCK);
+    if (value) blocks[entry][i % BLOCK] |= mask;
+    else blocks[entry][i % BLOCK] &= ~mask;
+}
+
+/**
+ * @brief Recomputes the row and the column of a schedule whose slots changed
+ * @details Time complexity: O(n * l * r) where n is the number of schedules
+ * @param schedules the same schedules used in build()
+ * @param index index of the schedule that changed
+ */
+void OverlapMatrix::updateRow(const vector<ClassSchedule> &schedules, size_t index) {
+    prepare(schedules, index);
+    for (size_t j = 0; j < n; j++) {
+        bool value = computeOverlap(index, j);
+        setBit(index, j, value);
+        setBit(j, index, value);
+    }
+}
+
+/**
+ * @brief Checks if two schedules overlap
+ * @details Time complexity: O(1)
+ * @param i index of the first schedule
+ * @param j index of the second schedule
+ * @return true if the schedules overlap, false otherwise
+ */
+bool OverlapMatrix::overlaps(size_t i, size_t j) const {
+    int entry = directory[(i / BLOCK) * numBlocks + j / BLOCK];
+    return entry >= 0 && (blocks[entry][i % BLOCK] >> (j % BLOCK) & 1);
+}
+
+/**
+ * @brief Returns the number of schedules in the matrix
+ * @details Time complexity: O(1)
+ */
+size_t OverlapMatrix::size() const {
+    return n;
+}
+
+/**
+ * @brief Returns the number of stored (non empty) tiles
+ * @details Time complexity: O(1)
+ */
+size_t OverlapMatrix::getNumBlocks() const {
+    return blocks.size();
+}
+
+/**
+ * @brief Adds the tiles, the directory and the slots kept to test the overlaps to a memory report
+ * @details Time complexity: O(n) where n is the number of schedules
+ */
+void OverlapMatrix::accountMemory(MemoryReport &report) const {
+    size_t bytes = 0, allocations = 0;
+    MemoryReport::addVector(slots, bytes, allocations);
+    for (const vector<TimeSlot> &scheduleSlots : slots) MemoryReport::addVector(scheduleSlots, bytes, allocations);
+    MemoryReport::addVector(dayMask, bytes, allocations);
+    MemoryReport::addVector(ucIndex, bytes, allocations);
+    MemoryReport::addVector(directory, bytes, allocations);
+    MemoryReport::addVector(blocks, bytes, allocations);
+    report.add("overlap matrix", bytes, blocks.size(), allocations);
+}
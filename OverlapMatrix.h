@@ -0,0 +1,63 @@
+#ifndef TRABALHO_OVERLAPMATRIX_H
+#define TRABALHO_OVERLAPMATRIX_H
+
+#include <vector>
+#include <array>
+#include <cstdint>
+#include "ClassSchedule.h"
+#include "ThreadPool.h"
+
+class MemoryReport;
+
+/**
+ * @brief Precomputed answer of "do these two classes overlap?" for every pair of schedules.
+ * @details The matrix is a bitset split in BLOCK x BLOCK tiles. Only tiles with at least one overlap are stored,
+ * the others are marked as empty in a directory, since most pairs of classes never overlap.
+ * Two classes overlap if they are of different UCs and any pair of their slots overlaps (@see Slot::overlaps()).
+ */
+class OverlapMatrix {
+    public:
+        static const size_t BLOCK = 64;
+
+        OverlapMatrix();
+
+        void build(const vector<ClassSchedule> &schedules, unsigned numThreads = 0);
+        void build(const vector<ClassSchedule> &schedules, ThreadPool &pool);
+        void updateRow(const vector<ClassSchedule> &schedules, size_t index);
+        bool overlaps(size_t i, size_t j) const;
+        size_t size() const;
+        size_t getNumBlocks() const;
+        void accountMemory(MemoryReport &report) const;
+
+    private:
+        /** @brief Slot reduced to what is needed to test overlaps (slots of type T never overlap and are not kept) */
+        struct TimeSlot {
+            int day;
+            float start;
+            float end;
+        };
+        /** @brief Tile of BLOCK x BLOCK bits, one word per row */
+        typedef array<uint64_t, BLOCK> Block;
+
+        void prepare(const vector<ClassSchedule> &schedules, size_t index);
+        bool computeOverlap(size_t i, size_t j) const;
+        bool computeBlock(size_t rowBlock, size_t colBlock, Block &block) const;
+        void setBit(size_t i, size_t j, bool value);
+
+        /** @brief Number of schedules */
+        size_t n;
+        /** @brief Number of tiles per row (and per column) */
+        size_t numBlocks;
+        /** @brief Slots of each schedule that can overlap */
+        vector<vector<TimeSlot>> slots;
+        /** @brief Bitmask of the days of the week where each schedule has slots that can overlap */
+        vector<uint8_t> dayMask;
+        /** @brief Index of the UC of each schedule, classes of the same UC never overlap */
+        vector<int> ucIndex;
+        /** @brief Index in blocks of each tile (row major), -1 if the tile is empty */
+        vector<int> directory;
+        /** @brief Stored tiles */
+        vector<Block> blocks;
+};
+
+#endif //TRABALHO_OVERLAPMATRIX_H
@@ -0,0 +1,223 @@
+#include "Persister.h"
+#include "Stats.h"
+#include <fstream>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+/**
+ * @brief Constructor, starts the thread
+ * @details Time complexity: O(1)
+ * @param path file where the students are saved
+ */
+Persister::Persister(const string &path) : path(path) {
+    this->saved = 0;
+    this->written = 0;
+    this->lastWriteOk = true;
+    this->writes = 0;
+    this->coalesced = 0;
+    this->stopping = false;
+    this->worker = thread(&Persister::workerLoop, this);
+}
+
+/**
+ * @brief Destructor, writes the last snapshot saved (if it wasn't written yet) and stops the thread
+ * @details Time complexity: the time of the pending write
+ */
+Persister::~Persister() {
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeWorker.notify_one();
+    worker.join();
+}
+
+/**
+ * @brief Hands a snapshot of the students to the thread and returns without waiting for the disk
+ * @details A snapshot that is still waiting to be written is replaced by the new one. The thread encodes the students
+ * as columns before writing them.\n
+ * Time complexity: O(1), plus freeing the snapshot replaced
+ * @param students immutable students to save, the caller must not change them afterwards
+ */
+void Persister::save(shared_ptr<const StudentSet> students) {
+    shared_ptr<const EnrollmentColumns> columns;
+    setPending(students, columns);
+}
+
+/**
+ * @brief Hands a snapshot of the students, already encoded as columns, to the thread and returns
+ * @details Time complexity: O(1), plus freeing the snapshot replaced
+ * @param columns immutable columns to save
+ */
+void Persister::save(shared_ptr<const EnrollmentColumns> columns) {
+    shared_ptr<const StudentSet> students;
+    setPending(students, columns);
+}
+
+/**
+ * @brief Replaces the pending snapshot and wakes the thread
+ * @details Only one of the two forms is set. Time complexity: O(1)
+ * @param students,columns snapshot to save, they are left with the snapshot replaced (freed by the caller, outside the lock)
+ */
+void Persister::setPending(shared_ptr<const StudentSet> &students, shared_ptr<const EnrollmentColumns> &columns) {
+    {
+        lock_guard<mutex> lock(stateMutex);
+        if (pending || pendingColumns) {
+            coalesced++;
+            STATS_COUNT("persist.coalesced");
+        }
+        swap(pending, students);
+        swap(pendingColumns, columns);
+        saved++;
+    }
+    wakeWorker.notify_one();
+}
+
+/**
+ * @brief Waits until the last snapshot saved is on disk
+ * @details Time complexity: the time of the writes in progress
+ * @return false if the last write failed
+ */
+bool Persister::flush() {
+    STATS_TIMER("persist.flush");
+    unique_lock<mutex> lock(stateMutex);
+    unsigned long target = saved;
+    writeFinished.wait(lock, [this, target] { return written >= target; });
+    return lastWriteOk;
+}
+
+/**
+ * @brief File where the students are saved
+ * @details Time complexity: O(1)
+ */
+const string &Persister::getPath() const {
+    return path;
+}
+
+/**
+ * @brief Number of files written
+ * @details Time complexity: O(1)
+ */
+size_t Persister::getNumberOfWrites() const {
+    lock_guard<mutex> lock(stateMutex);
+    return writes;
+}
+
+/**
+ * @brief Number of snapshots that were replaced by a newer one before being written
+ * @details Time complexity: O(1)
+ */
+size_t Persister::getNumberOfCoalesced() const {
+    lock_guard<mutex> lock(stateMutex);
+    return coalesced;
+}
+
+/**
+ * @brief Loop of the thread: waits for a snapshot, writes it and signals flush()
+ * @details The lock is released while the file is written, so save() never waits for the disk.
+ */
+void Persister::workerLoop() {
+    unique_lock<mutex> lock(stateMutex);
+    while (true) {
+        wakeWorker.wait(lock, [this] { return pending || pendingColumns || stopping; });
+        if (!pending && !pendingColumns) return;
+        shared_ptr<const StudentSet> students = move(pending);
+        shared_ptr<const EnrollmentColumns> columns = move(pendingColumns);
+        pending.reset();
+        pendingColumns.reset();
+        unsigned long number = saved;
+        lock.unlock();
+        bool ok;
+        {
+            STATS_TIMER("persist.write");
+            ok = columns ? writeFiles(path, *columns) : writeFiles(path, *students);
+        }
+        students.reset(); // the snapshot is freed by this thread
+        columns.reset();
+        lock.lock();
+        writes++;
+        lastWriteOk = ok;
+        written = number;
+        writeFinished.notify_all();
+    }
+}
+
+/**
+ * @brief Writes the students in the format of students_classes.csv
+ * @details Time complexity: O(st) where s is the number of students and t the number of classes of each student
+ */
+void Persister::writeStudents(const StudentSet &students, ostream &out) {
+    out << "StudentCode,StudentName,UcCode,ClassCode" << endl;
+    for (const Student &s : students) {
+        for (const UcClass &c : s.getClasses()) {
+            out << s.getId() << ',' << s.getName() << ',' << c.getUcId() << ',' << c.getClassId() << '\n';
+        }
+    }
+}
+
+/**
+ * @brief Saves the students to a csv file and, if it exists, to its .col file
+ * @details The students are encoded as columns first, which are quicker to write; if they can't be (too many
+ * classes) the csv is written from the set and the .col is left older than it, so it isn't loaded anymore.\n
+ * Time complexity: O(p log p + e) where p is the number of students and e the number of enrollments
+ * @see EnrollmentColumns::build()
+ * @return false if a file could not be written
+ */
+bool Persister::writeFiles(const string &path, const StudentSet &students) {
+    EnrollmentColumns columns;
+    if (columns.build(students)) return writeFiles(path, columns);
+    return replaceFile(path, [&students](ostream &out) { writeStudents(students, out); });
+}
+
+/**
+ * @brief Saves columns to a csv file and, if it exists, to its .col file
+ * @details The .col is written after the csv, so it is the newest of the two.\n
+ * Time complexity: O(p + e) where p is the number of students and e the number of enrollments
+ * @return false if a file could not be written
+ */
+bool Persister::writeFiles(const string &path, const EnrollmentColumns &columns) {
+    if (!replaceFile(path, [&columns](ostream &out) { columns.writeCsv(out); })) return false;
+    string columnsPath = EnrollmentColumns::pathFor(path);
+    if (access(columnsPath.c_str(), F_OK) != 0) return true;
+    return columns.save(columnsPath);
+}
+
+/**
+ * @brief Replaces a file atomically: writes a temporary file, syncs it and renames it over the file
+ * @details The directory is synced after the rename so that the new name survives a crash too.\n
+ * Time complexity: the time of write
+ * @param write function that writes the content of the file
+ * @return false if the file could not be written (the old file is left untouched)
+ */
+bool Persister::replaceFile(const string &path, const function<void(ostream&)> &write) {
+    string temporary = path + ".tmp";
+    {
+        ofstream file(temporary, ios::trunc);
+        if (!file.is_open()) return false;
+        write(file);
+        file.flush();
+        if (!file.good()) {
+            file.close();
+            remove(temporary.c_str());
+            return false;
+        }
+    }
+    int fd = open(temporary.c_str(), O_RDONLY);
+    bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) close(fd);
+    if (!synced || rename(temporary.c_str(), path.c_str()) != 0) {
+        remove(temporary.c_str());
+        return false;
+    }
+    size_t slash = path.rfind('/');
+    string directory = slash == string::npos ? "." : path.substr(0, slash + 1);
+    int dirFd = open(directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return true;
+}
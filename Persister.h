@@ -0,0 +1,76 @@
+#ifndef TRABALHO_PERSISTER_H
+#define TRABALHO_PERSISTER_H
+
+#include <string>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include "Student.h"
+#include "EnrollmentColumns.h"
+
+/**
+ * @brief Saves the students to students_classes.csv in a background thread
+ * @details save() only hands an immutable snapshot of the students to the thread and returns, so the callers never
+ * wait for the disk. The thread writes the snapshot to a temporary file next to the target, syncs it and renames it
+ * over the target, so a crash leaves either the old file or the new one, never a file half written. If several
+ * snapshots are saved while a write is in progress only the last one is written. flush() waits until the last
+ * snapshot saved is on disk.
+ * When the .col file of the target exists (@see EnrollmentColumns) it is rewritten after the csv, so that it stays the
+ * newest and keeps being loaded instead of the csv. The csv is written from the columns, which are also the snapshot
+ * the app hands over: they take a fraction of the memory of a copy of the students and are quicker to build.
+ */
+class Persister {
+    public:
+        explicit Persister(const string &path);
+        ~Persister();
+        Persister(const Persister &other) = delete;
+        Persister &operator = (const Persister &other) = delete;
+
+        void save(shared_ptr<const StudentSet> students);
+        void save(shared_ptr<const EnrollmentColumns> columns);
+        bool flush();
+        const string &getPath() const;
+        size_t getNumberOfWrites() const;
+        size_t getNumberOfCoalesced() const;
+
+        static void writeStudents(const StudentSet &students, ostream &out);
+        static bool writeFiles(const string &path, const StudentSet &students);
+        static bool writeFiles(const string &path, const EnrollmentColumns &columns);
+        static bool replaceFile(const string &path, const function<void(ostream&)> &write);
+
+    private:
+        void workerLoop();
+        void setPending(shared_ptr<const StudentSet> &students, shared_ptr<const EnrollmentColumns> &columns);
+
+        /** @brief File where the students are saved */
+        string path;
+        /** @brief Protects every field below */
+        mutable mutex stateMutex;
+        /** @brief Signals the thread that there is a snapshot to write (or that it must stop) */
+        condition_variable wakeWorker;
+        /** @brief Signals flush() that a write finished */
+        condition_variable writeFinished;
+        /** @brief Last snapshot saved and not yet being written, as a set of students (null if there is none) */
+        shared_ptr<const StudentSet> pending;
+        /** @brief Last snapshot saved and not yet being written, as columns (null if there is none) */
+        shared_ptr<const EnrollmentColumns> pendingColumns;
+        /** @brief Number of snapshots saved */
+        unsigned long saved;
+        /** @brief Number of the last snapshot saved that was written (or failed) */
+        unsigned long written;
+        /** @brief False if the last write failed */
+        bool lastWriteOk;
+        /** @brief Number of files written */
+        size_t writes;
+        /** @brief Number of snapshots replaced by a newer one before being written */
+        size_t coalesced;
+        /** @brief Set by the destructor, the thread writes the pending snapshot and exits */
+        bool stopping;
+        /** @brief Thread that writes the snapshots, started last */
+        thread worker;
+};
+
+#endif //TRABALHO_PERSISTER_H
@@ -0,0 +1,269 @@
+#include "Rebalancer.h"
+#include "ThreadPool.h"
+#include "Stats.h"
+#include <algorithm>
+#include <unordered_map>
+
+/** @brief Classes of every student, as indices of the schedules */
+struct Rebalancer::Enrollments {
+    /** @brief Students, numbered in the order of the set */
+    vector<const Student*> students;
+    /** @brief The classes of student s are classes[offsets[s]] to classes[offsets[s + 1]] */
+    vector<size_t> offsets;
+    vector<unsigned long> classes;
+    /** @brief Students of each schedule */
+    vector<vector<size_t>> members;
+};
+
+/**
+ * @brief Largest minus smallest value
+ * @details Time complexity: O(k)
+ */
+static int spread(const vector<int> &sizes) {
+    if (sizes.empty()) return 0;
+    return *max_element(sizes.begin(), sizes.end()) - *min_element(sizes.begin(), sizes.end());
+}
+
+/**
+ * @brief Constructor
+ * @details Time complexity: O(1)
+ * @param manager ScheduleManager with the files already read, it must not change while the plan is made
+ */
+Rebalancer::Rebalancer(const ScheduleManager &manager) : manager(manager) {
+    this->dropped = 0;
+}
+
+/**
+ * @brief Plans the moves of a UC
+ * @details The classes of the UC that collide with each schedule are found first, so the classes a student can go to
+ * are the ones not blocked by any of his other classes.\n
+ * Time complexity: O(n * k) + O(s * t) + O(m * k^2 * q) where n is the number of schedules, k the number of classes
+ * of the UC, s the number of students of the UC, t the number of classes of a student, m the number of moves and q
+ * the number of students of a class
+ */
+void Rebalancer::planUc(const string &ucId, const Enrollments &enrollments, vector<Move> &ucMoves,
+                        vector<size_t> &movedStudents, UcPlan &ucPlan) const {
+    const vector<ClassSchedule> &schedules = manager.getSchedules();
+    ScheduleView classesUc = manager.schedulesOfUc(ucId);
+    size_t k = classesUc.size(), first = classesUc.begin() - schedules.begin(), words = (k + 63) / 64;
+
+    vector<uint64_t> blocked(schedules.size() * words, 0);
+    for (size_t other = 0; other < schedules.size(); other++) {
+        for (size_t b = 0; b < k; b++) {
+            if (manager.classesOverlap(first + b, other)) blocked[other * words + b / 64] |= uint64_t(1) << (b % 64);
+        }
+    }
+    // students of each class, with the classes of the uc they can go to
+    vector<size_t> students;
+    vector<uint64_t> allowed;
+    vector<vector<size_t>> members(k);
+    vector<int> sizes(k);
+    for (size_t j = 0; j < k; j++) {
+        const vector<size_t> &classMembers = enrollments.members[first + j];
+        sizes[j] = (int) classMembers.size();
+        for (size_t s : classMembers) {
+            size_t id = students.size();
+            students.push_back(s);
+            allowed.resize(allowed.size() + words, ~uint64_t(0));
+            for (size_t c = enrollments.offsets[s]; c < enrollments.offsets[s + 1]; c++) {
+                unsigned long other = enrollments.classes[c];
+                if (other >= first && other < first + k) continue;
+                for (size_t w = 0; w < words; w++) allowed[id * words + w] &= ~blocked[other * words + w];
+            }
+            members[j].push_back(id);
+        }
+    }
+    ucPlan.ucId = ucId;
+    ucPlan.spreadBefore = spread(sizes);
+
+    vector<size_t> bySize(k);
+    for (size_t j = 0; j < k; j++) bySize[j] = j;
+    bool moved = true;
+    while (moved) {
+        moved = false;
+        sort(bySize.begin(), bySize.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+        for (size_t i = 0; i < k && !moved; i++) {
+            size_t from = bySize[i];
+            for (size_t l = k; l-- > i + 1 && !moved;) {
+                size_t to = bySize[l];
+                if (sizes[to] + 2 > sizes[from]) break;
+                vector<size_t> &candidates = members[from];
+                for (size_t p = 0; p < candidates.size(); p++) {
+                    size_t id = candidates[p];
+                    if (!(allowed[id * words + to / 64] >> (to % 64) & 1)) continue;
+                    ucMoves.push_back({enrollments.students[students[id]]->getId(), schedules[first + from].getUcClass(),
+                                       schedules[first + to].getUcClass()});
+                    movedStudents.push_back(students[id]);
+                    candidates[p] = candidates.back(); // a student is moved at most once
+                    candidates.pop_back();
+                    sizes[from]--;
+                    sizes[to]++;
+                    moved = true;
+                    break;
+                }
+            }
+        }
+    }
+    ucPlan.spreadAfter = spread(sizes);
+    ucPlan.moves = ucMoves.size();
+}
+
+/**
+ * @brief Plans the moves of the given UCs (every UC if none is given), one UC per task
+ * @details Each UC is planned against the current classes of the students, so the moves of a student in two UCs are
+ * checked against each other afterwards: a move whose new class collides with the class the student will have in
+ * another UC is dropped (and the spread of its UC recomputed).\n
+ * Time complexity: O(p * t) + O(sum of planUc() / w) + O(m * t) where p is the number of students, t the number of
+ * classes of a student, w the number of workers and m the number of moves
+ * @see planUc()
+ * @param ucIds UCs to rebalance, the UCs that don't exist are ignored
+ * @param numThreads number of workers (0 uses the number of hardware threads, 1 plans on the calling thread without
+ * starting any)
+ */
+void Rebalancer::plan(const vector<string> &ucIds, unsigned numThreads) {
+    STATS_TIMER("rebalance.plan");
+    const vector<ClassSchedule> &schedules = manager.getSchedules();
+    vector<string> ucs;
+    unordered_map<UcClass, unsigned long, UcClassHash> indexOf;
+    for (size_t i = 0; i < schedules.size(); i++) {
+        indexOf[schedules[i].getUcClass()] = i;
+        const string &ucId = schedules[i].getUcClass().getUcId();
+        if (i > 0 && ucId == schedules[i - 1].getUcClass().getUcId()) continue;
+        if (ucIds.empty() || find(ucIds.begin(), ucIds.end(), ucId) != ucIds.end()) ucs.push_back(ucId);
+    }
+    Enrollments enrollments;
+    enrollments.members.assign(schedules.size(), vector<size_t>());
+    enrollments.offsets.push_back(0);
+    for (const Student &student : manager.getStudents()) {
+        size_t s = enrollments.students.size();
+        enrollments.students.push_back(&student);
+        for (const UcClass &ucClass : student.getClasses()) {
+            auto it = indexOf.find(ucClass);
+            if (it == indexOf.end()) continue;
+            enrollments.classes.push_back(it->second);
+            enrollments.members[it->second].push_back(s);
+        }
+        enrollments.offsets.push_back(enrollments.classes.size());
+    }
+
+    vector<vector<Move>> perUc(ucs.size());
+    vector<vector<size_t>> movedPerUc(ucs.size());
+    ucPlans.assign(ucs.size(), UcPlan());
+    if (numThreads == 1) {
+        for (size_t u = 0; u < ucs.size(); u++) planUc(ucs[u], enrollments, perUc[u], movedPerUc[u], ucPlans[u]);
+    }
+    else {
+        ThreadPool pool(numThreads);
+        for (size_t u = 0; u < ucs.size(); u++) {
+            pool.submit([this, u, &ucs, &enrollments, &perUc, &movedPerUc] {
+                planUc(ucs[u], enrollments, perUc[u], movedPerUc[u], ucPlans[u]);
+            });
+        }
+        pool.wait();
+    }
+
+    // classes each moved student will have, to check his moves in different ucs against each other
+    unordered_map<size_t, vector<unsigned long>> planned;
+    for (const vector<size_t> &movedStudents : movedPerUc) {
+        for (size_t s : movedStudents) {
+            if (planned.count(s)) continue;
+            planned[s].assign(enrollments.classes.begin() + enrollments.offsets[s],
+                              enrollments.classes.begin() + enrollments.offsets[s + 1]);
+        }
+    }
+    moves.clear();
+    dropped = 0;
+    for (size_t u = 0; u < ucs.size(); u++) {
+        size_t kept = 0;
+        for (size_t i = 0; i < perUc[u].size(); i++) {
+            const Move &move = perUc[u][i];
+            vector<unsigned long> &classes = planned[movedPerUc[u][i]];
+            unsigned long from = indexOf[move.from], to = indexOf[move.to];
+            bool collides = false;
+            for (unsigned long other : classes) {
+                if (other != from && manager.classesOverlap(to, other)) { collides = true; break; }
+            }
+            if (collides) {
+                dropped++;
+                STATS_COUNT("rebalance.dropped");
+                continue;
+            }
+            replace(classes.begin(), classes.end(), from, to);
+            moves.push_back(move);
+            kept++;
+        }
+        if (kept != ucPlans[u].moves) {
+            vector<int> sizes;
+            for (const ClassSchedule &cs : manager.schedulesOfUc(ucs[u])) {
+                int size = cs.getNumStudents();
+                for (size_t i = moves.size() - kept; i < moves.size(); i++) {
+                    if (moves[i].from == cs.getUcClass()) size--;
+                    if (moves[i].to == cs.getUcClass()) size++;
+                }
+                sizes.push_back(size);
+            }
+            ucPlans[u].spreadAfter = spread(sizes);
+            ucPlans[u].moves = kept;
+        }
+    }
+}
+
+/**
+ * @brief Applies the planned moves to a ScheduleManager (the one the plan was made from or a copy of it)
+ * @details The moves are applied with ScheduleManager::moveStudent(), which refuses a move that is no longer
+ * possible (e.g. the student changed class since the plan was made).\n
+ * Time complexity: O(m) times the cost of ScheduleManager::moveStudent(), where m is the number of moves
+ * @return number of moves applied
+ */
+size_t Rebalancer::apply(ScheduleManager &target, ostream &out) const {
+    STATS_TIMER("rebalance.apply");
+    size_t applied = 0;
+    for (const Move &move : moves) {
+        if (target.moveStudent(move.studentId, move.from, move.to)) applied++;
+    }
+    out << ">> " << applied << " of " << moves.size() << " moves applied." << endl;
+    return applied;
+}
+
+/**
+ * @brief Moves planned by the last plan(), grouped by UC
+ * @details Time complexity: O(1)
+ */
+const vector<Rebalancer::Move> &Rebalancer::getMoves() const {
+    return moves;
+}
+
+/**
+ * @brief Plan of each UC of the last plan()
+ * @details Time complexity: O(1)
+ */
+const vector<Rebalancer::UcPlan> &Rebalancer::getUcPlans() const {
+    return ucPlans;
+}
+
+/**
+ * @brief Number of moves dropped by the last plan() because they collide with another move of the same student
+ * @details Time complexity: O(1)
+ */
+size_t Rebalancer::getNumberOfDropped() const {
+    return dropped;
+}
+
+/**
+ * @brief Prints the spread of each UC before and after the moves and, optionally, the moves
+ * @details Time complexity: O(u + m) where u is the number of UCs and m the number of moves
+ */
+void Rebalancer::printPlan(ostream &out, bool listMoves) const {
+    for (const UcPlan &ucPlan : ucPlans) {
+        out << ">> " << ucPlan.ucId << ": spread " << ucPlan.spreadBefore << " -> " << ucPlan.spreadAfter
+            << " with " << ucPlan.moves << " moves" << endl;
+    }
+    out << ">> " << moves.size() << " moves in " << ucPlans.size() << " ucs";
+    if (dropped > 0) out << ", " << dropped << " dropped because they collide with a move of the same student in another uc";
+    out << endl;
+    if (!listMoves) return;
+    for (const Move &move : moves) {
+        out << "   " << move.studentId << " " << move.from.getUcId() << " " << move.from.getClassId() << " -> "
+            << move.to.getClassId() << endl;
+    }
+}
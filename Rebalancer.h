@@ -0,0 +1,64 @@
+#ifndef TRABALHO_REBALANCER_H
+#define TRABALHO_REBALANCER_H
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include "ScheduleManager.h"
+
+/**
+ * @brief Plans the moves of students between the classes of a UC that even out the sizes of its classes
+ * @details requestProvokesDisequilibrium() only stops a request from making the classes of a UC more uneven, this
+ * fixes the imbalance that already exists. For each UC, a local search moves a student from the largest class to the
+ * smallest one that is at least two students smaller, choosing a student for whom the new class doesn't collide with
+ * his classes of the other UCs, until no such move is left. Every move lowers the sum of the squares of the sizes, so
+ * the search ends, and the spread (largest minus smallest class) only stays above one when collisions block it.
+ * The classes of every student are indexed once, then the UCs are planned in parallel, and finally the moves of a
+ * student in different UCs are checked against each other and the ones that would collide are dropped.
+ */
+class Rebalancer {
+    public:
+        /** @brief Student moved from one class to another of the same UC */
+        struct Move {
+            string studentId;
+            UcClass from;
+            UcClass to;
+        };
+
+        /** @brief Result of the plan of a UC */
+        struct UcPlan {
+            string ucId;
+            /** @brief Largest minus smallest class before the moves */
+            int spreadBefore;
+            /** @brief Largest minus smallest class after the moves */
+            int spreadAfter;
+            /** @brief Number of moves planned for the UC */
+            size_t moves;
+        };
+
+        explicit Rebalancer(const ScheduleManager &manager);
+
+        void plan(const vector<string> &ucIds, unsigned numThreads = 0);
+        size_t apply(ScheduleManager &target, ostream &out = cout) const;
+        const vector<Move> &getMoves() const;
+        const vector<UcPlan> &getUcPlans() const;
+        size_t getNumberOfDropped() const;
+        void printPlan(ostream &out = cout, bool listMoves = false) const;
+
+    private:
+        struct Enrollments;
+
+        void planUc(const string &ucId, const Enrollments &enrollments, vector<Move> &ucMoves, vector<size_t> &movedStudents,
+                    UcPlan &ucPlan) const;
+
+        /** @brief ScheduleManager whose classes are planned */
+        const ScheduleManager &manager;
+        /** @brief Moves of every UC, grouped by UC */
+        vector<Move> moves;
+        /** @brief Plan of each UC */
+        vector<UcPlan> ucPlans;
+        /** @brief Moves dropped because they collide with a move of the same student in another UC */
+        size_t dropped;
+};
+
+#endif //TRABALHO_REBALANCER_H
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+#include "ScheduleManager.h"
+#include "RequestTrace.h"
+
+using namespace std;
+
+/**
+ * @brief Replays a request trace (recorded with trabalho --trace file) on a fresh ScheduleManager
+ * @details The files of the data folder are loaded and the events of the trace are fed in order: every request is
+ * submitted with the state of the student at that moment and every Process event processes the pending requests.
+ * Rollback and Clear events undo the last processed batch and discard the pending requests, as in the recorded session.
+ * With --pace recorded the original intervals between events are kept (divided by --speed), with --pace fast
+ * (the default) the events are fed as fast as possible.
+ * At the end it prints the accepted and rejected counts, the throughput and checksums of the final state, so that
+ * two processing engines can be compared on the same workload.\n
+ * Usage: replay --trace file [--data dir] [--pace recorded|fast] [--speed factor]
+ */
+
+/** @brief Stream buffer that discards everything, the output of processRequests() is not needed */
+class NullBuffer : public streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+        streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+/** @brief FNV-1a hash, used for the checksums of the final state */
+class Checksum {
+    public:
+        void add(const string &value) {
+            for (unsigned char c : value) hash = (hash ^ c) * 1099511628211ULL;
+            hash = (hash ^ 0xff) * 1099511628211ULL; // separator, so that "ab","c" and "a","bc" differ
+        }
+        uint64_t get() const { return hash; }
+
+    private:
+        uint64_t hash = 14695981039346656037ULL;
+};
+
+/**
+ * @brief Checksum of the students of every class, in the order of the schedules
+ */
+static uint64_t classesChecksum(const ScheduleManager &manager) {
+    Checksum checksum;
+    for (const ClassSchedule &cs : manager.getSchedules()) {
+        checksum.add(cs.getUcClass().getUcId());
+        checksum.add(cs.getUcClass().getClassId());
+        for (const Student &student : cs.getStudents()) checksum.add(student.getId());
+    }
+    return checksum.get();
+}
+
+/**
+ * @brief Checksum of the classes of every student, in the order of the students
+ */
+static uint64_t studentsChecksum(const ScheduleManager &manager) {
+    Checksum checksum;
+    for (const Student &student : manager.getStudents()) {
+        checksum.add(student.getId());
+        for (const UcClass &ucClass : student.getClasses()) {
+            checksum.add(ucClass.getUcId());
+            checksum.add(ucClass.getClassId());
+        }
+    }
+    return checksum.get();
+}
+
+int main(int argc, char **argv) {
+    string tracePath, dataDir = "../data/", pace = "fast";
+    double speed = 1;
+    bool valid = argc % 2 == 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string option = argv[i], value = argv[i + 1];
+        if (option == "--trace") tracePath = value;
+        else if (option == "--data") dataDir = value.back() == '/' ? value : value + "/";
+        else if (option == "--pace") pace = value;
+        else if (option == "--speed") speed = stod(value);
+        else valid = false;
+    }
+    if (!valid || tracePath.empty() || (pace != "fast" && pace != "recorded") || speed <= 0) {
+        cerr << "Usage: " << argv[0] << " --trace file [--data dir] [--pace recorded|fast] [--speed factor]" << endl;
+        return 1;
+    }
+    vector<RequestTrace::Event> events;
+    if (!RequestTrace::load(tracePath, events)) {
+        cerr << "Could not open the trace " << tracePath << endl;
+        return 1;
+    }
+
+    ScheduleManager manager;
+    manager.readFiles(dataDir);
+    NullBuffer nullBuffer;
+    ostream nullStream(&nullBuffer);
+
+    bool rollbacks = false;
+    for (const RequestTrace::Event &event : events) rollbacks = rollbacks || event.type == "Rollback";
+    long submitted = 0, processed = 0, batches = 0, skipped = 0, rolledBack = 0;
+    double processingSeconds = 0;
+    auto begin = chrono::steady_clock::now();
+    for (const RequestTrace::Event &event : events) {
+        if (pace == "recorded") {
+            long long offset = (long long) ((event.timestamp - events.front().timestamp) / speed);
+            this_thread::sleep_until(begin + chrono::microseconds(offset));
+        }
+        if (event.type == "Rollback") {
+            if (manager.rollbackCheckpoint()) rolledBack++;
+            continue;
+        }
+        manager.commitCheckpoint();
+        if (event.type == "Clear") {
+            manager.clearPendingRequests();
+            continue;
+        }
+        if (event.type == "Process") {
+            processed += manager.getNumberOfPendingRequests();
+            batches++;
+            auto start = chrono::steady_clock::now();
+            if (rollbacks) manager.beginCheckpoint(); // only needed if a batch may be rolled back
+            manager.processRequests(nullStream);
+            processingSeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            continue;
+        }
+        Student *student = manager.findStudent(event.studentId);
+        if (student == nullptr || manager.findSchedule(event.ucClass) == nullptr) {
+            skipped++;
+            continue;
+        }
+        if (event.type == "Changing") manager.addChangingRequest(*student, event.ucClass);
+        else if (event.type == "Enrollment") manager.addEnrollmentRequest(*student, event.ucClass);
+        else if (event.type == "Removal") manager.addRemovalRequest(*student, event.ucClass);
+        else {
+            skipped++;
+            continue;
+        }
+        submitted++;
+    }
+    manager.commitCheckpoint();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    const vector<pair<Request, string>> &rejected = manager.getRejectedRequests();
+    map<string, long> reasons;
+    for (const pair<Request, string> &p : rejected) reasons[p.second]++;
+    char checksums[64];
+    snprintf(checksums, sizeof(checksums), "%016llx %016llx", (unsigned long long) classesChecksum(manager),
+             (unsigned long long) studentsChecksum(manager));
+
+    cout << "events: " << events.size() << " (" << submitted << " requests, " << batches << " process, "
+         << rolledBack << " rolled back, " << skipped << " skipped)" << endl
+         << "processed: " << processed << " (" << processed - (long) rejected.size() << " accepted, "
+         << rejected.size() << " rejected), " << manager.getNumberOfPendingRequests() << " left pending" << endl;
+    for (const pair<const string, long> &reason : reasons) {
+        cout << "   rejected: " << reason.second << "  " << reason.first << endl;
+    }
+    cout << "elapsed: " << seconds << " s (" << processingSeconds << " s processing)" << endl
+         << "throughput: " << submitted / seconds << " req/s submitted, "
+         << (processingSeconds > 0 ? processed / processingSeconds : 0) << " req/s processed" << endl
+         << "checksum (classes students): " << checksums << endl;
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "Request.h"
+#include <utility>
 
 
 /**
@@ -7,10 +8,10 @@
 * @param student Student that made the request
 * @param desiredClass Class that the student wants to enroll in
 */
-Request::Request(const Student &student, const UcClass &desiredClass, const string &type) {
+Request::Request(Student student, UcClass desiredClass, const string &type) {
     if(type != "Changing" && type != "Removal" && type != "Enrollment") return;
-    this->student = student;
-    this->desiredUcClass = desiredClass;
+    this->student = move(student);
+    this->desiredUcClass = move(desiredClass);
     this->type = type;
 }
 
@@ -19,11 +20,11 @@ Request::Request(const Student &student, const UcClass &desiredClass, const stri
  * @details Time complexity: O(1)
  */
 
-void Request::printHeader() const{
-    cout << "Student: " << student.getName() << " - "<< student.getId() <<  "  |  ";
-    if(type == "Removal") cout << "Requested Uc: " << desiredUcClass.getUcId();
+void Request::printHeader(ostream &out) const{
+    out << "Student: " << student.getName() << " - "<< student.getId() <<  "  |  ";
+    if(type == "Removal") out << "Requested Uc: " << desiredUcClass.getUcId();
     else{
-        cout << "Requested class: " << desiredUcClass.getUcId() << " - " << desiredUcClass.getClassId();
+        out << "Requested class: " << desiredUcClass.getUcId() << " - " << desiredUcClass.getClassId();
     }
 }
 
@@ -32,25 +33,33 @@ void Request::printHeader() const{
  * @details calls printHeader() and then prints the type of the request
  * Time complexity: O(1)
  */
-void Request::print() const {
-    printHeader();
-    cout << "  |  " << "Type: " << type << endl;
+void Request::print(ostream &out) const {
+    printHeader(out);
+    out << "  |  " << "Type: " << type << endl;
 }
 
 /**
 * @brief Returns the student that made the request
 * @details Time complexity: O(1)
-* @return Student that made the request
+* @return Reference to the student that made the request
 */
-Student Request::getStudent() const {
+const Student &Request::getStudent() const {
     return student;
 }
 
 /**
 * @brief Returns the UcClass that the student wants to enroll in
 * @details Time complexity: O(1)
-* @return Class that the student wants to enroll in
+* @return Reference to the class that the student wants to enroll in
 */
-UcClass Request::getDesiredUcClass() const {
+const UcClass &Request::getDesiredUcClass() const {
     return desiredUcClass;
+}
+
+/**
+* @brief Returns the type of the request (Changing, Removal or Enrollment)
+* @details Time complexity: O(1)
+*/
+const string &Request::getType() const {
+    return type;
 }
\ No newline at end of file
@@ -10,11 +10,12 @@
 
 class Request{
     public:
-        Request(const Student &student, const UcClass &desiredClass, const string &type);
-        void printHeader() const;
-        void print() const;
-        Student getStudent() const;
-        UcClass getDesiredUcClass() const;
+        Request(Student student, UcClass desiredClass, const string &type);
+        void printHeader(ostream &out = cout) const;
+        void print(ostream &out = cout) const;
+        const Student &getStudent() const;
+        const UcClass &getDesiredUcClass() const;
+        const string &getType() const;
 
     private:
         /** @brief Student that made the request */
@@ -0,0 +1,100 @@
+#include "RequestIntake.h"
+#include "Stats.h"
+
+using namespace std;
+
+/**
+ * @brief Constructor, creates an empty ring
+ * @details Time complexity: O(c) where c is the capacity
+ * @param capacity maximum number of requests waiting, rounded up to a power of two
+ */
+RequestIntake::RequestIntake(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size *= 2;
+    this->cells.reset(new Cell[size]);
+    this->mask = size - 1;
+    for (size_t i = 0; i < size; i++) cells[i].sequence.store(i, memory_order_relaxed);
+    this->tail = 0;
+    this->head = 0;
+    this->refused = 0;
+}
+
+/**
+ * @brief Adds a request to the ring, from any thread
+ * @details The producer claims the tail only if the cell there was already taken by the consumer, so a full ring is
+ * detected without waiting.\n
+ * Time complexity: O(1), lock-free (a retry only happens when another producer claimed the position first)
+ * @return false if the ring is full, the request is not added and the caller should ask the client to retry
+ */
+bool RequestIntake::submit(Submission submission) {
+    size_t position = tail.load(memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+        cell = &cells[position & mask];
+        size_t sequence = cell->sequence.load(memory_order_acquire);
+        long difference = (long) sequence - (long) position;
+        if (difference == 0) {
+            if (tail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) break;
+        } else if (difference < 0) {
+            refused.fetch_add(1, memory_order_relaxed);
+            STATS_COUNT("intake.full");
+            return false; // the consumer hasn't taken the request of the previous lap yet
+        } else {
+            position = tail.load(memory_order_relaxed);
+        }
+    }
+    cell->submission = move(submission);
+    cell->sequence.store(position + 1, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Takes the oldest request of the ring, only one thread may call it at a time
+ * @details A request whose producer claimed the position but is still writing it is not taken yet, so the requests
+ * after it wait too and the order of the positions is kept.\n
+ * Time complexity: O(1)
+ * @param submission where the request is moved to
+ * @return false if there is no request ready
+ */
+bool RequestIntake::take(Submission &submission) {
+    size_t position = head.load(memory_order_relaxed);
+    Cell &cell = cells[position & mask];
+    if (cell.sequence.load(memory_order_acquire) != position + 1) return false;
+    submission = move(cell.submission);
+    cell.sequence.store(position + mask + 1, memory_order_release);
+    head.store(position + 1, memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Number of requests in the ring (claimed and not yet taken), only exact when no thread is using it
+ * @details Time complexity: O(1)
+ */
+size_t RequestIntake::size() const {
+    size_t taken = head.load(memory_order_relaxed), claimed = tail.load(memory_order_relaxed);
+    return claimed > taken ? claimed - taken : 0;
+}
+
+/**
+ * @brief Maximum number of requests waiting
+ * @details Time complexity: O(1)
+ */
+size_t RequestIntake::getCapacity() const {
+    return mask + 1;
+}
+
+/**
+ * @brief Number of requests accepted since the ring was created
+ * @details Time complexity: O(1)
+ */
+unsigned long RequestIntake::getNumberOfSubmitted() const {
+    return tail.load(memory_order_relaxed);
+}
+
+/**
+ * @brief Number of requests refused because the ring was full
+ * @details Time complexity: O(1)
+ */
+unsigned long RequestIntake::getNumberOfRefused() const {
+    return refused.load(memory_order_relaxed);
+}
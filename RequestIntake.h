@@ -0,0 +1,67 @@
+#ifndef TRABALHO_REQUESTINTAKE_H
+#define TRABALHO_REQUESTINTAKE_H
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * @brief Bounded lock-free queue where many threads submit requests that a single consumer takes
+ * @details A ring of cells, each with a sequence number that says whose turn it is: a producer claims a position
+ * with a compare-and-swap on the tail and publishes the cell by storing its sequence, the consumer reads the cell when
+ * its sequence says it is full and hands it back to the producers of the next lap. Producers never wait for each other
+ * or for the consumer, and when the ring is full submit() fails at once, which is the backpressure signal: the caller
+ * tells the client to retry instead of the queue growing without bound.
+ * Only one thread may call take() at a time (the VersionedSchedule takes the writer lock to drain it).
+ */
+class RequestIntake {
+    public:
+        /** @brief Request as submitted, before it is validated against the students and classes */
+        struct Submission {
+            /** @brief Type of the request: Changing, Enrollment or Removal */
+            string type;
+            string studentId;
+            string ucCode;
+            /** @brief Class wanted (empty for a Removal) */
+            string classCode;
+        };
+
+        explicit RequestIntake(size_t capacity = 4096);
+        RequestIntake(const RequestIntake &other) = delete;
+        RequestIntake &operator = (const RequestIntake &other) = delete;
+
+        bool submit(Submission submission);
+        bool take(Submission &submission);
+        size_t size() const;
+        size_t getCapacity() const;
+        unsigned long getNumberOfSubmitted() const;
+        unsigned long getNumberOfRefused() const;
+
+    private:
+        /** @brief Position of the ring */
+        struct Cell {
+            /** @brief Equal to the position when the cell is free for it, to the position + 1 when it holds its request */
+            atomic<size_t> sequence;
+            Submission submission;
+        };
+
+        /** @brief Cells of the ring, a power of two */
+        unique_ptr<Cell[]> cells;
+        /** @brief Size of the ring - 1 */
+        size_t mask;
+        /** @brief Keeps the counters of the producers and of the consumer in different cache lines */
+        char padding0[64];
+        /** @brief Next position claimed by a producer, also the number of requests accepted */
+        atomic<size_t> tail;
+        char padding1[64 - sizeof(atomic<size_t>)];
+        /** @brief Next position read by the consumer */
+        atomic<size_t> head;
+        char padding2[64 - sizeof(atomic<size_t>)];
+        /** @brief Number of requests refused because the ring was full */
+        atomic<unsigned long> refused;
+};
+
+#endif //TRABALHO_REQUESTINTAKE_H
@@ -0,0 +1,69 @@
+#include "RequestOverlay.h"
+#include "ScheduleIndex.h"
+
+using namespace std;
+
+/**
+ * @brief Constructor, an empty overlay shows the schedules as they are
+ * @details Time complexity: O(1)
+ */
+RequestOverlay::RequestOverlay(const vector<ClassSchedule> &schedules) : schedules(schedules) {}
+
+/**
+ * @brief Number of students of a class with the changes of the overlay
+ * @details Time complexity: O(1) expected
+ * @param schedule index of the class in the schedules (0 if it is ScheduleIndex::NOT_FOUND)
+ */
+int RequestOverlay::getNumStudents(unsigned long schedule) const {
+    if (schedule == ScheduleIndex::NOT_FOUND) return 0;
+    auto it = countChanges.find(schedule);
+    return schedules[schedule].getNumStudents() + (it == countChanges.end() ? 0 : it->second);
+}
+
+/**
+ * @brief Checks if a student is in a class with the changes of the overlay
+ * @details Time complexity: O(log c + log q) where c is the number of changes and q the number of students of the class
+ */
+bool RequestOverlay::contains(unsigned long schedule, const Student &student) const {
+    auto it = members.find({schedule, student.getId()});
+    if (it != members.end()) return it->second;
+    return schedules[schedule].getStudents().count(student) > 0;
+}
+
+/**
+ * @brief Adds a student to a class in the overlay, nothing changes if the student is already in it
+ * @details Time complexity: O(log c + log q) where c is the number of changes and q the number of students of the class
+ */
+void RequestOverlay::addToClass(unsigned long schedule, const Student &student) {
+    if (schedule == ScheduleIndex::NOT_FOUND || contains(schedule, student)) return;
+    members[{schedule, student.getId()}] = true;
+    countChanges[schedule]++;
+}
+
+/**
+ * @brief Removes a student from a class in the overlay, nothing changes if the student is not in it
+ * @details Time complexity: O(log c + log q) where c is the number of changes and q the number of students of the class
+ */
+void RequestOverlay::removeFromClass(unsigned long schedule, const Student &student) {
+    if (schedule == ScheduleIndex::NOT_FOUND || !contains(schedule, student)) return;
+    members[{schedule, student.getId()}] = false;
+    countChanges[schedule]--;
+}
+
+/**
+ * @brief Tentative classes of a student, that can be changed without changing the student
+ * @details Time complexity: O(h) the first time, O(1) expected after, where h is the number of classes of the student
+ */
+UcClassList &RequestOverlay::classesOf(const Student &student) {
+    auto it = classes.find(student.getId());
+    if (it == classes.end()) it = classes.emplace(student.getId(), student.getClasses()).first;
+    return it->second;
+}
+
+/**
+ * @brief Number of (class, student) pairs changed in the overlay
+ * @details Time complexity: O(1)
+ */
+size_t RequestOverlay::getNumberOfChanges() const {
+    return members.size();
+}
@@ -0,0 +1,38 @@
+#ifndef TRABALHO_REQUESTOVERLAY_H
+#define TRABALHO_REQUESTOVERLAY_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "Student.h"
+#include "ClassSchedule.h"
+
+/**
+ * @brief Tentative changes to the students of the classes, layered over schedules that are never modified
+ * @details Used to simulate the pending requests: the students added to or removed from each class and the classes
+ * of the changed students are kept in the overlay, and the number of students of a class is its real number plus
+ * the changes made to it. The overlay grows with the number of requests simulated, not with the size of the data.
+ */
+class RequestOverlay {
+    public:
+        explicit RequestOverlay(const vector<ClassSchedule> &schedules);
+
+        int getNumStudents(unsigned long schedule) const;
+        bool contains(unsigned long schedule, const Student &student) const;
+        void addToClass(unsigned long schedule, const Student &student);
+        void removeFromClass(unsigned long schedule, const Student &student);
+        UcClassList &classesOf(const Student &student);
+        size_t getNumberOfChanges() const;
+
+    private:
+        /** @brief Schedules the overlay is layered over */
+        const vector<ClassSchedule> &schedules;
+        /** @brief Students added minus students removed of each changed class */
+        unordered_map<unsigned long, int> countChanges;
+        /** @brief Whether the student is in the class, for the (class, student) pairs that were changed */
+        map<pair<unsigned long, string>, bool> members;
+        /** @brief Tentative classes of each changed student, copied the first time it is changed */
+        unordered_map<string, UcClassList> classes;
+};
+
+#endif //TRABALHO_REQUESTOVERLAY_H
@@ -0,0 +1,64 @@
+#include "RequestTrace.h"
+#include <sstream>
+#include <chrono>
+
+using namespace std;
+
+/**
+ * @brief Creates (or truncates) the trace file and writes its header
+ * @details Time complexity: O(1)
+ * @param path file of the trace
+ */
+RequestTrace::RequestTrace(const string &path) : file(path, ios::trunc) {
+    file << "Timestamp,Type,StudentCode,UcCode,ClassCode" << endl;
+}
+
+/**
+ * @brief Checks if the trace file could be opened
+ * @details Time complexity: O(1)
+ */
+bool RequestTrace::isOpen() const {
+    return file.good();
+}
+
+/**
+ * @brief Appends an event to the trace
+ * @details The line is flushed, so the trace survives a crash of the application.\n
+ * Time complexity: O(1)
+ * @param type Changing, Enrollment, Removal, Process, Rollback or Clear
+ */
+void RequestTrace::record(const string &type, const string &studentId, const UcClass &ucClass) {
+    long long timestamp = chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    lock_guard<mutex> lock(fileMutex);
+    file << timestamp << ',' << type << ',' << studentId << ',' << ucClass.getUcId() << ',' << ucClass.getClassId() << endl;
+}
+
+/**
+ * @brief Reads a trace file
+ * @details Lines that can't be parsed are ignored.\n
+ * Time complexity: O(e) where e is the number of events
+ * @param events vector where the events are appended
+ * @return false if the file couldn't be opened
+ */
+bool RequestTrace::load(const string &path, vector<Event> &events) {
+    ifstream file(path);
+    if (!file.is_open()) return false;
+    file.ignore(1000, '\n');
+    vector<string> row;
+    string line, word;
+    while (getline(file, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.resize(line.size() - 1);
+        row.clear();
+        stringstream str(line);
+        while (getline(str, word, ','))
+            row.push_back(word);
+        row.resize(5);
+        try {
+            events.push_back({stoll(row[0]), row[1], row[2], UcClass(row[3], row[4])});
+        } catch (const logic_error &) {
+            continue;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef TRABALHO_REQUESTTRACE_H
+#define TRABALHO_REQUESTTRACE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include "UcClass.h"
+
+using namespace std;
+
+/**
+ * @brief Records the submitted requests (and the moments they were processed) to a csv trace file
+ * @details Each line is "Timestamp,Type,StudentCode,UcCode,ClassCode", the timestamp is in microseconds since the
+ * epoch and the type is Changing, Enrollment, Removal, Process, Rollback (of the last processed batch) or Clear (of the
+ * pending requests); only the first three have a student and a class.
+ * The trace can be fed to a fresh ScheduleManager with the replay tool.
+ */
+class RequestTrace {
+    public:
+        /** @brief Line of a trace */
+        struct Event {
+            /** @brief Microseconds since the epoch */
+            long long timestamp;
+            /** @brief Changing, Enrollment, Removal, Process, Rollback or Clear */
+            string type;
+            /** @brief UP number of the student, empty if the event is not a request */
+            string studentId;
+            /** @brief Class of the request, empty if the event is not a request */
+            UcClass ucClass;
+        };
+
+        explicit RequestTrace(const string &path);
+        RequestTrace(const RequestTrace &other) = delete;
+        RequestTrace &operator = (const RequestTrace &other) = delete;
+
+        bool isOpen() const;
+        void record(const string &type, const string &studentId, const UcClass &ucClass);
+        static bool load(const string &path, vector<Event> &events);
+
+    private:
+        /** @brief Trace file */
+        ofstream file;
+        /** @brief Serializes the lines written by different threads */
+        mutex fileMutex;
+};
+
+#endif //TRABALHO_REQUESTTRACE_H
@@ -0,0 +1,147 @@
+#include "ScheduleIndex.h"
+#include "MemoryReport.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+const unsigned long ScheduleIndex::NOT_FOUND;
+
+/**
+ * @brief Constructor, the index is empty until build() is called
+ * @details Time complexity: O(1)
+ */
+ScheduleIndex::ScheduleIndex() {
+    this->n = 0;
+    this->exact = true;
+}
+
+/**
+ * @brief Packs the first 8 characters of a code in an integer whose order is the order of the strings
+ * @details The characters are stored big-endian and the missing ones are zero, so if a < b then pack(a) <= pack(b).\n
+ * Time complexity: O(1)
+ */
+uint64_t ScheduleIndex::pack(const string &code) {
+    uint64_t value = 0;
+    if (code.size() >= 8) {
+        memcpy(&value, code.data(), 8);
+        return __builtin_bswap64(value);
+    }
+    for (size_t i = 0; i < 8; i++) {
+        value = value << 8 | (i < code.size() ? (unsigned char) code[i] : 0);
+    }
+    return value;
+}
+
+/**
+ * @brief Packed key of a UcClass
+ * @details Time complexity: O(1)
+ */
+ScheduleIndex::Key ScheduleIndex::makeKey(const UcClass &ucClass) {
+    return {pack(ucClass.getUcId()), pack(ucClass.getClassId())};
+}
+
+/**
+ * @brief Builds the index of the given schedules
+ * @details Time complexity: O(n log n) where n is the number of schedules
+ * @param schedules schedules to index, the index has to be rebuilt if they are added, removed or reordered
+ */
+void ScheduleIndex::build(const vector<ClassSchedule> &schedules) {
+    n = schedules.size();
+    exact = true;
+    vector<pair<Key, uint32_t>> entries(n);
+    for (size_t i = 0; i < n; i++) {
+        const UcClass &ucClass = schedules[i].getUcClass();
+        entries[i] = {makeKey(ucClass), (uint32_t) i};
+        if (ucClass.getUcId().size() > 8 || ucClass.getClassId().size() > 8) exact = false;
+    }
+    sort(entries.begin(), entries.end(), [](const pair<Key, uint32_t> &a, const pair<Key, uint32_t> &b) {
+        return a.first < b.first || (a.first == b.first && a.second < b.second);
+    });
+    sorted.resize(n);
+    order.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        sorted[i] = entries[i].first;
+        order[i] = entries[i].second;
+    }
+    tree.assign(n + 1, Key{0, 0});
+    rank.assign(n + 1, 0);
+    layout(0, 1);
+}
+
+/**
+ * @brief Places the sorted keys in the tree with an in-order traversal
+ * @details Time complexity: O(n)
+ * @param position next sorted key to place
+ * @param k current node
+ * @return next sorted key to place after the subtree of k
+ */
+size_t ScheduleIndex::layout(size_t position, size_t k) {
+    if (k <= n) {
+        position = layout(position, 2 * k);
+        tree[k] = sorted[position];
+        rank[k] = (uint32_t) position;
+        position = layout(position + 1, 2 * k + 1);
+    }
+    return position;
+}
+
+/**
+ * @brief Finds the node of the first key that is not less than the given key
+ * @details The loop has no data dependent branch: it always descends to a leaf, going right when the node is less
+ * than the key, and the last left turn is recovered from the bits of k. The 8 descendants three levels below
+ * (two cache lines) are prefetched at each step.\n
+ * Time complexity: O(log n)
+ * @return node of the tree, 0 if every key is less than the given key
+ */
+size_t ScheduleIndex::lowerBound(const Key &key) const {
+    const Key *nodes = tree.data();
+    size_t k = 1;
+    while (k <= n) {
+        if (8 * k + 4 <= n) {
+            __builtin_prefetch(nodes + 8 * k);
+            __builtin_prefetch(nodes + 8 * k + 4);
+        }
+        k = 2 * k + (nodes[k] < key);
+    }
+    return k >> __builtin_ffsll((long long) ~k);
+}
+
+/**
+ * @brief Finds the position of a UcClass in the schedules
+ * @details Time complexity: O(log n) where n is the number of schedules
+ * @param ucClass UcClass to find
+ * @param schedules schedules used to build the index, only read when a code is longer than 8 characters
+ * @return index of the schedule in the vector, NOT_FOUND if it doesn't exist
+ */
+unsigned long ScheduleIndex::find(const UcClass &ucClass, const vector<ClassSchedule> &schedules) const {
+    Key key = makeKey(ucClass);
+    size_t k = lowerBound(key);
+    if (k == 0 || !(tree[k] == key)) return NOT_FOUND;
+    if (exact && ucClass.getUcId().size() <= 8 && ucClass.getClassId().size() <= 8) return order[rank[k]];
+    for (size_t r = rank[k]; r < n && sorted[r] == key; r++) {
+        if (schedules[order[r]].getUcClass() == ucClass) return order[r];
+    }
+    return NOT_FOUND;
+}
+
+/**
+ * @brief Number of indexed schedules
+ * @details Time complexity: O(1)
+ */
+size_t ScheduleIndex::size() const {
+    return n;
+}
+
+/**
+ * @brief Adds the keys and the tree to a memory report
+ * @details Time complexity: O(1)
+ */
+void ScheduleIndex::accountMemory(MemoryReport &report) const {
+    size_t bytes = 0, allocations = 0;
+    MemoryReport::addVector(sorted, bytes, allocations);
+    MemoryReport::addVector(order, bytes, allocations);
+    MemoryReport::addVector(tree, bytes, allocations);
+    MemoryReport::addVector(rank, bytes, allocations);
+    report.add("schedule index", bytes, n, allocations);
+}
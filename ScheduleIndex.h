@@ -0,0 +1,63 @@
+#ifndef TRABALHO_SCHEDULEINDEX_H
+#define TRABALHO_SCHEDULEINDEX_H
+
+#include <vector>
+#include <cstdint>
+#include "ClassSchedule.h"
+
+class MemoryReport;
+
+/**
+ * @brief Compact search index over the (ucId, classId) keys of the schedules.
+ * @details The first 8 characters of each code are packed in an integer, so a probe compares two integers instead
+ * of two pairs of strings, and the keys are stored apart from the schedules in Eytzinger (breadth-first) order:
+ * the children of node k are 2k and 2k+1, the nodes visited by a search are close to each other in memory and the
+ * nodes a few levels below can be prefetched while the current one is compared.
+ * Codes longer than 8 characters share packed keys, in that case the candidates are confirmed with the full UcClass.
+ */
+class ScheduleIndex {
+    public:
+        /** @brief Position returned by find() when the UcClass is not in the schedules */
+        static const unsigned long NOT_FOUND = static_cast<unsigned long>(-1);
+
+        ScheduleIndex();
+
+        void build(const vector<ClassSchedule> &schedules);
+        unsigned long find(const UcClass &ucClass, const vector<ClassSchedule> &schedules) const;
+        size_t size() const;
+        void accountMemory(MemoryReport &report) const;
+
+    private:
+        /** @brief Packed (ucId, classId), compared as a pair of unsigned integers */
+        struct Key {
+            uint64_t uc;
+            uint64_t cls;
+
+            bool operator < (const Key &other) const {
+                return uc < other.uc || (uc == other.uc && cls < other.cls);
+            }
+            bool operator == (const Key &other) const {
+                return uc == other.uc && cls == other.cls;
+            }
+        };
+
+        static uint64_t pack(const string &code);
+        static Key makeKey(const UcClass &ucClass);
+        size_t layout(size_t position, size_t k);
+        size_t lowerBound(const Key &key) const;
+
+        /** @brief Number of keys */
+        size_t n;
+        /** @brief true if every code fits in its packed integer, then equal keys mean equal UcClasses */
+        bool exact;
+        /** @brief Keys sorted by Key::operator< */
+        vector<Key> sorted;
+        /** @brief Index in the schedules vector of each sorted key */
+        vector<uint32_t> order;
+        /** @brief Keys in Eytzinger order (position 0 is not used) */
+        vector<Key> tree;
+        /** @brief Position in sorted of each node of the tree */
+        vector<uint32_t> rank;
+};
+
+#endif //TRABALHO_SCHEDULEINDEX_H
@@ -9,6 +9,40 @@
 #include <csignal>
 
 #include "ScheduleManager.h"
+#include "Stats.h"
+#include "Arena.h"
+#include "StudentSort.h"
+#include "Catalog.h"
+#include "Persister.h"
+#include "MemoryReport.h"
+
+/** @brief Reasons why a request is rejected, shared by processRequests() and simulateRequests() */
+static const char *const COLLISION = "Collision in the students' schedule";
+static const char *const EXCEEDS_CAP = "Exceeds maximum number of students allowed in the class";
+static const char *const EXCEEDS_CAP_ENROLLMENT = "Exceeds maximum number of students allowed in the class. Choose another class";
+static const char *const DISEQUILIBRIUM = "Change provokes disequilibrium between classes";
+static const char *const NOT_ENROLLED = "The student is no longer enrolled in the uc";
+static const char *const STUDENT_NOT_FOUND = "Student not found";
+
+/**
+ * @brief Checks if a list of classes has a class of the uc of the given class
+ * @details Time complexity: O(h) where h is the number of classes
+ */
+static bool isEnrolled(const UcClassList &classes, const UcClass &ucClass) {
+    for(const UcClass &c : classes) if(c.sameUcId(ucClass)) return true;
+    return false;
+}
+
+/**
+ * @brief Requests of a queue in the order they are processed, without copying them
+ * @details Time complexity: O(1)
+ */
+static const deque<Request> &requestsOf(const queue<Request> &requests) {
+    struct Access : queue<Request> {
+        static const deque<Request> &container(const queue<Request> &requests) { return requests.*&Access::c; }
+    };
+    return Access::container(requests);
+}
 
 /**
 *@brief Schedule Manager constructor
@@ -16,34 +50,92 @@
 *Time complexity: O(1)
 */
 ScheduleManager::ScheduleManager() {
-    this->students = set<Student>();
+    this->dataDir = "../data/";
+    this->students = StudentSet();
     this->schedules = vector<ClassSchedule>();
     this->changingRequests = queue<Request>();
     this->removalRequests = queue<Request>();
     this->enrollmentRequests = queue<Request>();
     this->rejectedRequests = vector<pair<Request, string>>();
+    this->scheduleIndex = make_shared<const ScheduleIndex>();
+    this->overlapMatrix = make_shared<const OverlapMatrix>();
+    this->sessionIndex = make_shared<const SessionIndex>();
+    this->pool = nullptr;
+}
+
+/**
+ * @brief Copy constructor
+ * @details The StudentIndex is rebuilt, so that it points to the students of the copy. The ScheduleIndex, the overlaps
+ * and the SessionIndex are shared with the original, they are immutable once built. An open checkpoint is not copied.\n
+ * Time complexity: O(s) where s is the size of the students and rosters
+ */
+ScheduleManager::ScheduleManager(const ScheduleManager &other)
+    : dataDir(other.dataDir), students(other.students), schedules(other.schedules), scheduleIndex(other.scheduleIndex),
+      overlapMatrix(other.overlapMatrix), sessionIndex(other.sessionIndex), changingRequests(other.changingRequests), removalRequests(other.removalRequests),
+      enrollmentRequests(other.enrollmentRequests), rejectedRequests(other.rejectedRequests), trace(other.trace), pool(other.pool),
+      ucNames(other.ucNames) {
+    studentIndex.build(students);
+}
+
+/**
+ * @brief Copy assignment
+ * @details The StudentIndex is rebuilt, so that it points to the students of this object.\n
+ * Time complexity: O(s) where s is the size of the state
+ */
+ScheduleManager &ScheduleManager::operator = (const ScheduleManager &other) {
+    if (this != &other) {
+        ScheduleManager copy(other);
+        *this = move(copy);
+    }
+    return *this;
 }
 
 /**
 *@brief Reads the files and creates the objects
- * @details Time complexity: O(n) + O(m log n) + O(p log n) being n the number of lines in the file classes_per_uc,
- * m the number of lines in the file classes.csv and p the number of lines in the file student_classes.csv
+ * @details After reading the slots, the overlaps between every pair of schedules are precomputed and the slots are
+ * indexed by weekday.\n
+ * Time complexity: O(n) + O(m log n) + O(n^2 lr / w) + O(m log m) + O(p log n) being n the number of lines in the file classes_per_uc,
+ * m the number of lines in the file classes.csv, p the number of lines in the file student_classes.csv,
+ * l and r the number of slots of two schedules and w the number of threads
  * @see createSchedules()
  * @see setSchedules()
  * @see createStudents()
+ * @see OverlapMatrix::build()
+ * @see SessionIndex::build()
+ * @see Arena
+ * @see Catalog
+ * @param dataDir directory of the csv files, ending with '/'
 */
-void ScheduleManager::readFiles() {
+void ScheduleManager::readFiles(const string &dataDir) {
+    STATS_TIMER("load.readFiles");
+    Arena::Scope arenaScope; // the slots, classes and sets created while loading are bump allocated
+    this->dataDir = dataDir;
     createSchedules(); // O(n)
     setSchedules(); // O(m log n)
+    {
+        STATS_TIMER("load.overlapMatrix");
+        shared_ptr<OverlapMatrix> matrix = make_shared<OverlapMatrix>();
+        if (pool != nullptr) matrix->build(schedules, *pool); // O(n^2 lr / w)
+        else matrix->build(schedules);
+        overlapMatrix = matrix;
+    }
+    shared_ptr<SessionIndex> session = make_shared<SessionIndex>();
+    session->build(schedules); // O(m log m)
+    sessionIndex = session;
+    ucNames.clear();
+    Catalog::readUcNames(dataDir + "uc_names.csv", ucNames); // optional, adds or renames UCs of this dataset
     createStudents(); // O(p log n
 }
 
 /**
 *@brief Reads the file "classes_per_uc.csv" and creates a vector of schedules with only UcCLass (without students or slots)
-*@details Time complexity: O(n), being n the number of lines in the file "classes_per_uc.csv" (which happens to be the number of schedules)
+*@details The search index of the schedules is built at the end.\n
+*Time complexity: O(n log n), being n the number of lines in the file "classes_per_uc.csv" (which happens to be the number of schedules)
+*@see ScheduleIndex::build()
 */
 void ScheduleManager::createSchedules(){
-    fstream file("../data/classes_per_uc.csv");
+    STATS_TIMER("load.createSchedules");
+    fstream file(dataDir + "classes_per_uc.csv");
     file.ignore(1000, '\n');
     vector<string> row;
     string line, word;
@@ -58,6 +150,10 @@ void ScheduleManager::createSchedules(){
         ClassSchedule cs(ucClass);
         schedules.push_back(cs);
     }
+    STATS_TIMER("load.scheduleIndex");
+    shared_ptr<ScheduleIndex> index = make_shared<ScheduleIndex>();
+    index->build(schedules); //O(n log n)
+    scheduleIndex = index;
 }
 
 /**
@@ -65,7 +161,8 @@ void ScheduleManager::createSchedules(){
 * @details Time complexity: O(m log n), being m the number of lines in the file classes.csv (number of slots) and  n the number of schedules as seen previously
 */
 void ScheduleManager::setSchedules() {
-    fstream file("../data/classes.csv");
+    STATS_TIMER("load.setSchedules");
+    fstream file(dataDir + "classes.csv");
     file.ignore(1000, '\n');
     vector<string> row;
     string line, word;
@@ -79,24 +176,55 @@ void ScheduleManager::setSchedules() {
         string classCode = row[0], ucCode = row[1], weekDay = row[2], startTime = row[3], duration = row[4], type = row[5];
         UcClass ucClass(ucCode, classCode);
         Slot slot(weekDay, stof(startTime), stof(duration), type);
-        unsigned long scheduleIndex = binarySearchSchedules(ucClass);  //O(log n)
-        if (scheduleIndex != -1) {
-            schedules[scheduleIndex].addSlot(slot);
-        }
+        addSlot(ucClass, slot);  //O(log n)
+    }
+}
+
+/**
+* @brief Adds a slot to the schedule of a class
+* @details If the overlaps were already computed, only the row and column of that schedule are recomputed (and the
+* slots are indexed again), in new copies of the overlaps and of the SessionIndex, since the old ones may be shared
+* with published versions.\n
+* Time complexity: O(log n) before the overlaps are computed, O(n*l*r + m log m) after, being n the number of
+* schedules and m the number of slots
+* @see OverlapMatrix::updateRow()
+*/
+void ScheduleManager::addSlot(const UcClass &ucClass, const Slot &slot) {
+    unsigned long scheduleIndex = binarySearchSchedules(ucClass);  //O(log n)
+    if (scheduleIndex == ScheduleIndex::NOT_FOUND) return;
+    schedules[scheduleIndex].addSlot(slot);
+    if (overlapMatrix->size() == schedules.size()) {
+        shared_ptr<OverlapMatrix> matrix = make_shared<OverlapMatrix>(*overlapMatrix);
+        matrix->updateRow(schedules, scheduleIndex);
+        overlapMatrix = matrix;
+        shared_ptr<SessionIndex> session = make_shared<SessionIndex>();
+        session->build(schedules);
+        sessionIndex = session;
     }
 }
 
 /**
  * @brief Reads the file "students.csv" and creates/updates the student information and set of students
 * @detailes Reads the students_classes.csv file, adds/updates the student information by adding the UcClass read in the file.
-* It also inserts/updates the student in the set of students\n
-* Time complexity: O(p log s), being p the number of lines in the file students_classes.csv and s the number of students
+* It also inserts/updates the student in the set of students and in the StudentIndex.
+* If students_classes.col exists and is not older than the csv, it is loaded instead (@see EnrollmentColumns)\n
+* Time complexity: O(p + s log s), being p the number of lines in the file students_classes.csv and s the number of students
 */
 void ScheduleManager::createStudents() {
-    fstream file("../data/students_classes.csv");
+    STATS_TIMER("load.createStudents");
+    string path = dataDir + "students_classes.csv", columnsPath = EnrollmentColumns::pathFor(path);
+    if (EnrollmentColumns::isNewer(columnsPath, path)) {
+        EnrollmentColumns columns;
+        if (columns.load(columnsPath)) {
+            createStudents(columns);
+            return;
+        }
+    }
+    fstream file(path);
     file.ignore(1000, '\n');
     vector<string> row;
     string line, word;
+    vector<vector<const Student *>> members(schedules.size());
     while (getline(file, line)) { //O(p), being p the number of lines in the file students_classes.csv
         row.clear();
         if (line[line.size() - 1] == '\r')
@@ -110,117 +238,393 @@ void ScheduleManager::createStudents() {
         unsigned long i = binarySearchSchedules(newUcClass); //O(log n) where n is the number of schedules(lines in the classes_per_uc.csv file)
         Student student(id, name);
 
-        if (students.find(student) == students.end()) {
-            student.addClass(this->schedules[i].getUcClass());
-            students.insert(student); //O(log n)
+        //a class that isn't scheduled is skipped, but its student is still created, as createStudents(columns) does
+        bool scheduled = i != ScheduleIndex::NOT_FOUND;
+        Student *existing = findStudent(id); //O(1)
+        const Student *stored = existing;
+        if (existing == nullptr) {
+            if (scheduled) student.addClass(this->schedules[i].getUcClass());
+            stored = &*students.insert(student).first; //O(log s)
+            studentIndex.insert(*stored);
+        } else if (scheduled) {
+            //the id (the key of the set) doesn't change, so the student can be updated in place
+            existing->addClass(this->schedules[i].getUcClass());
+        }
+        if (scheduled) members[i].push_back(stored);
+    }
+    fillRosters(members);
+}
+
+/**
+ * @brief Creates the students and fills the classes from the enrollments stored by columns
+ * @details Each class of the dictionary is searched once, then every student is created with all of its classes.\n
+ * Time complexity: O(c log n + p + s log s), being c the number of classes of the dictionary, n the number of
+ * schedules, p the number of enrollments and s the number of students
+ */
+void ScheduleManager::createStudents(const EnrollmentColumns &columns) {
+    STATS_TIMER("load.createStudentsColumns");
+    vector<unsigned long> scheduleOf;
+    for (const UcClass &ucClass : columns.getDictionary()) scheduleOf.push_back(binarySearchSchedules(ucClass));
+    vector<vector<const Student *>> members(schedules.size());
+    vector<unsigned long> classes;
+    EnrollmentColumns::Cursor cursor(columns);
+    while (cursor.next()) {
+        Student student(cursor.getId(), cursor.getName());
+        Student *existing = findStudent(student.getId()); //O(1)
+        classes.clear();
+        for (size_t c = 0; c < cursor.getNumberOfClasses(); c++) {
+            unsigned long i = scheduleOf[cursor.getClassCode(c)];
+            if (i == ScheduleIndex::NOT_FOUND) continue;
+            if (existing == nullptr) student.addClass(schedules[i].getUcClass());
+            else existing->addClass(schedules[i].getUcClass());
+            classes.push_back(i);
+        }
+        const Student *stored = existing;
+        if (existing == nullptr) {
+            stored = &*students.insert(students.end(), student); //O(log s)
+            studentIndex.insert(*stored);
+        }
+        for (unsigned long i : classes) members[i].push_back(stored);
+    }
+    fillRosters(members);
+}
+
+/**
+ * @brief Adds the students read to the rosters of the classes, one class after the other
+ * @details The nodes of a roster are created together, so they are next to each other in the Arena instead of being
+ * interleaved with the nodes of every other class, and copying a roster (as every publish of a VersionedSchedule does)
+ * reads memory in order.\n
+ * Time complexity: O(p log q), being p the number of enrollments and q the number of students of a class
+ * @param members students of each schedule, in the order they were read
+ */
+void ScheduleManager::fillRosters(const vector<vector<const Student *>> &members) {
+    for (size_t i = 0; i < members.size(); i++) {
+        for (const Student *student : members[i]) schedules[i].addStudent(Student(student->getId(), student->getName()));
+    }
+}
+
+/**
+ * @brief Applies a file of enrollment changes, in the students_classes.csv format, without reading the other files again
+ * @details Each row "StudentCode,StudentName,UcCode,ClassCode" enrolls the student in the class: the student is
+ * created if it doesn't exist, moved to the class if it is enrolled in another class of the uc and enrolled in the uc
+ * otherwise. A row whose StudentCode starts with '-' removes the student from that class. Only the students,
+ * classes and indexes touched by a row are updated, then the changes are reported.\n
+ * Time complexity: O(k (log n + h + log q)) where k is the number of rows, n the number of schedules, h the number of
+ * classes of a student and q the number of students of a class
+ * @param path file with the changes
+ * @return false if the file couldn't be opened
+ */
+bool ScheduleManager::applyDelta(const string &path, ostream &out) {
+    STATS_TIMER("load.applyDelta");
+    ifstream file(path);
+    if (!file.is_open()) {
+        out << ">> Could not open " << path << endl;
+        return false;
+    }
+    file.ignore(1000, '\n');
+    int created = 0, enrolled = 0, moved = 0, removed = 0, unchanged = 0, lineNumber = 1;
+    vector<string> skipped;
+    set<unsigned long> touched;
+    vector<string> row;
+    string line, word;
+    while (getline(file, line)) { //O(k)
+        lineNumber++;
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.resize(line.size() - 1);
+        if (line.empty()) continue;
+        row.clear();
+        stringstream str(line);
+        while (getline(str, word, ','))
+            row.push_back(word);
+        if (row.size() < 4) {
+            skipped.push_back("line " + to_string(lineNumber) + ": expected 4 columns");
+            continue;
+        }
+        bool removal = !row[0].empty() && row[0][0] == '-';
+        string id = removal ? row[0].substr(1) : row[0];
+        unsigned long i = binarySearchSchedules(UcClass::lookup(row[2], row[3])); //O(log n)
+        if (i == ScheduleIndex::NOT_FOUND) {
+            skipped.push_back("line " + to_string(lineNumber) + ": class " + row[2] + " " + row[3] + " not found");
+            continue;
+        }
+        const UcClass &ucClass = schedules[i].getUcClass();
+        Student *student = findStudent(id); //O(1)
+        if (removal) {
+            if (student == nullptr || !(student->findUcClass(ucClass.getUcId()) == ucClass)) {
+                skipped.push_back("line " + to_string(lineNumber) + ": " + id + " is not enrolled in " + row[2] + " " + row[3]);
+                continue;
+            }
+            changeStudent(student)->removeUc(ucClass.getUcId()); //O(h)
+            removeFromClass(i, *student); //O(log q)
+            removed++;
+        } else if (student == nullptr) {
+            Student newStudent(id, row[1]);
+            newStudent.addClass(ucClass);
+            student = const_cast<Student*>(&*students.insert(newStudent).first); //O(log s)
+            studentIndex.insert(*student); //O(1)
+            if (checkpoint) checkpoint->studentCreated(student);
+            addToClass(i, *student); //O(log q)
+            created++;
+        } else if (!student->isEnrolled(ucClass.getUcId())) {
+            changeStudent(student)->addUc(ucClass); //O(h log h)
+            addToClass(i, *student);
+            enrolled++;
         } else {
-            auto loc = students.find(student);
-            Student modStudent = *loc;
-            students.erase(loc);
-            modStudent.addClass(this->schedules[i].getUcClass());
-            students.insert(modStudent);
+            UcClass oldClass = student->findUcClass(ucClass.getUcId());
+            if (oldClass == ucClass) {
+                unchanged++;
+                continue;
+            }
+            changeStudent(student)->changeClass(ucClass); //O(h)
+            addToClass(i, *student);
+            unsigned long oldIndex = binarySearchSchedules(oldClass); //O(log n)
+            removeFromClass(oldIndex, *student);
+            touched.insert(oldIndex);
+            moved++;
         }
-        this->schedules[i].addStudent(student);
+        touched.insert(i);
     }
+    out << ">> Applied " << path << ":" << endl;
+    out << "   >> New students: " << created << endl;
+    out << "   >> New enrollments: " << enrolled << endl;
+    out << "   >> Class changes: " << moved << endl;
+    out << "   >> Removed enrollments: " << removed << endl;
+    out << "   >> Unchanged rows: " << unchanged << endl;
+    out << "   >> Classes changed: " << touched.size() << endl;
+    out << "   >> Skipped rows: " << skipped.size() << endl;
+    for (size_t k = 0; k < skipped.size() && k < 20; k++) {
+        out << "      " << skipped[k] << endl;
+    }
+    if (skipped.size() > 20) out << "      ... and " << skipped.size() - 20 << " more" << endl;
+    return true;
+}
+
+/**
+ * @brief Returns the student after saving its classes in the open checkpoint, must be called before changing it
+ * @details Time complexity: O(h) the first time a student is changed after a checkpoint, O(1) otherwise
+ */
+Student *ScheduleManager::changeStudent(Student *student) {
+    if (checkpoint) checkpoint->saveStudent(student);
+    return student;
+}
+
+/**
+ * @brief Adds a student to a class, the change is logged in the open checkpoint
+ * @details Time complexity: O(log q) where q is the number of students of the class
+ * @param schedule index of the class in the schedules
+ */
+void ScheduleManager::addToClass(unsigned long schedule, const Student &student) {
+    if (checkpoint && schedules[schedule].getStudents().count(student) == 0) {
+        checkpoint->rosterChanged(schedule, student, true);
+    }
+    schedules[schedule].addStudent(student);
+}
+
+/**
+ * @brief Removes a student from a class, the change is logged in the open checkpoint
+ * @details Time complexity: O(log q) where q is the number of students of the class
+ * @param schedule index of the class in the schedules
+ */
+void ScheduleManager::removeFromClass(unsigned long schedule, const Student &student) {
+    if (checkpoint) {
+        auto it = schedules[schedule].getStudents().find(student);
+        if (it != schedules[schedule].getStudents().end()) checkpoint->rosterChanged(schedule, *it, false);
+    }
+    schedules[schedule].removeStudent(student);
+}
+
+/**
+ * @brief Opens a checkpoint, the changes made from now on can be rolled back until it is committed
+ * @details Nothing but the pending requests is copied. Time complexity: O(r) where r is the number of pending requests
+ * @return false if there is already an open checkpoint
+ */
+bool ScheduleManager::beginCheckpoint() {
+    if (checkpoint) return false;
+    checkpoint.reset(new Checkpoint({changingRequests, removalRequests, enrollmentRequests, rejectedRequests.size()}));
+    return true;
+}
+
+/**
+ * @brief Keeps the changes made since the checkpoint and closes it
+ * @details Time complexity: O(c) where c is the number of logged changes (the log is freed)
+ * @return false if there is no open checkpoint
+ */
+bool ScheduleManager::commitCheckpoint() {
+    if (!checkpoint) return false;
+    checkpoint.reset();
+    return true;
+}
+
+/**
+ * @brief Restores the students, classes and requests as they were when the checkpoint was opened and closes it
+ * @details Time complexity: O(c log q + r) where c is the number of logged changes, q the number of students of a class
+ * and r the number of pending requests @see Checkpoint::undo()
+ * @return false if there is no open checkpoint
+ */
+bool ScheduleManager::rollbackCheckpoint() {
+    if (!checkpoint) return false;
+    STATS_TIMER("request.rollback");
+    checkpoint->undo(schedules, students, studentIndex);
+    Checkpoint::Requests &saved = checkpoint->getRequests();
+    changingRequests = move(saved.changing);
+    removalRequests = move(saved.removal);
+    enrollmentRequests = move(saved.enrollment);
+    rejectedRequests.erase(rejectedRequests.begin() + saved.rejected, rejectedRequests.end());
+    checkpoint.reset();
+    if(trace) trace->record("Rollback", "", UcClass());
+    return true;
+}
+
+/**
+ * @brief Checks if there is an open checkpoint
+ * @details Time complexity: O(1)
+ */
+bool ScheduleManager::hasCheckpoint() const {
+    return checkpoint != nullptr;
+}
+
+/**
+ * @brief Number of changes logged since the checkpoint was opened (0 if there is none)
+ * @details Time complexity: O(1)
+ */
+size_t ScheduleManager::getNumberOfCheckpointChanges() const {
+    return checkpoint ? checkpoint->getNumberOfChanges() : 0;
+}
+
+/**
+ * @brief Discards the pending requests
+ * @details Time complexity: O(r) where r is the number of pending requests
+ */
+void ScheduleManager::clearPendingRequests() {
+    changingRequests = queue<Request>();
+    removalRequests = queue<Request>();
+    enrollmentRequests = queue<Request>();
+    if(trace) trace->record("Clear", "", UcClass());
 }
 
 /**
 * @brief Function that returns the index of the schedule with the ucClass passed as parameter
 * @param desiredUcCLass
-* @details Uses binary search to find the schedules \n
+* @details Searches the packed keys of the ScheduleIndex instead of the schedules themselves \n
 * Time complexity: O(log n) where n is the number of schedules(lines in the classes_per_uc.csv file)
-* @return The index of the schedule with the ucClass passed as parameter
-* @see Slot::overlaps()
+* @return The index of the schedule with the ucClass passed as parameter, ScheduleIndex::NOT_FOUND if it doesn't exist
+* @see ScheduleIndex::find()
 */
 unsigned long ScheduleManager::binarySearchSchedules(const UcClass &desiredUcCLass) const{
-    unsigned long left = 0, right = schedules.size() - 1, middle = (left + right) / 2;
-
-    while(left <= right){
-        if(schedules[middle].getUcClass() == desiredUcCLass){
-            return middle;
-        }
-        else if(schedules[middle].getUcClass() < desiredUcCLass){
-            left = middle + 1;
-        }
-        else{
-            right = middle - 1;
-        }
-        middle = (left + right) / 2;
-    }
-    return -1;
+    STATS_COUNT("index.binarySearchSchedules"); // counted, not timed: reading the clock costs more than the search
+    return scheduleIndex->find(desiredUcCLass, schedules); //O(log n)
 }
 
 /**
 * @brief Function that returns the student with the ID passed as parameter
- * @details Time complexity: O(log p) where p is the number of students in the set of students
+ * @details Numeric ids (UP numbers) are found in the StudentIndex without allocating, the others in the set of students\n
+ * Time complexity: O(1) expected for numeric ids, O(log p) otherwise where p is the number of students in the set of students
 * @param studentId
 */
 Student* ScheduleManager::findStudent(const string &studentId) const{
+    STATS_COUNT("index.findStudent"); // counted, not timed: reading the clock costs more than the lookup
+    if (Student::parseKey(studentId) != Student::NO_KEY) return studentIndex.find(studentId); //O(1)
     auto student = students.find(Student(studentId, "")); //O(log p)
     return student == students.end() ? nullptr : const_cast<Student*>(&(*student));
 }
 
+/**
+ * @brief Finds the students with the given UP numbers, for many of them at once
+ * @details The lookups of the index are pipelined (@see StudentIndex::findAll()) and timed once for the whole
+ * batch.\n
+ * Time complexity: O(k) expected where k is the number of ids (O(log p) for each id that is not a number)
+ * @param found vector that gets, at the position of each id, the student or nullptr if it doesn't exist
+ */
+void ScheduleManager::findStudents(const vector<const string *> &studentIds, vector<Student *> &found) const {
+    STATS_TIMER("index.findStudents");
+    studentIndex.findAll(studentIds, found); //O(k)
+    for (size_t i = 0; i < studentIds.size(); i++) {
+        if (found[i] != nullptr || Student::parseKey(*studentIds[i]) != Student::NO_KEY) continue;
+        auto student = students.find(Student(*studentIds[i], "")); //O(log p)
+        if (student != students.end()) found[i] = const_cast<Student*>(&(*student));
+    }
+}
+
 /**
 * @brief Function that returns the schedule with the ucClass passed as parameter
  * @details Time complexity: O(log n) where n is the number of schedules(lines file classes_per_uc.csv) @see binarySearchSchedules()
 * @param ucClass
 */
 ClassSchedule* ScheduleManager::findSchedule(const UcClass &ucClass) const {
+    STATS_COUNT("index.findSchedule");
     unsigned long index = binarySearchSchedules(ucClass); //O(log n)
-    if(index == -1) return nullptr;
+    if(index == ScheduleIndex::NOT_FOUND) return nullptr;
     return const_cast<ClassSchedule*>(&schedules[index]);
 }
 
 /**
- * @brief Function that returns a vector with the ClassSchedules of a given class
- * @details Time complexity: O(n) where n is the number of schedules(lines in the classes_per_uc.csv file)
+ * @brief Function that returns a view of the ClassSchedules of a given uc, without copying them
+ * @details The schedules are ordered by UcClass, so the classes of a uc are contiguous and found with binary search.\n
+ * Time complexity: O(log n) where n is the number of schedules(lines in the classes_per_uc.csv file)
+ * @param ucId
+ * @return A view of all the classes of a given uc (empty if the uc doesn't exist)
+ */
+ScheduleView ScheduleManager::schedulesOfUc(const string &ucId) const {
+    auto first = lower_bound(schedules.begin(), schedules.end(), ucId, [](const ClassSchedule &cs, const string &id) {
+        return cs.getUcClass().getUcId() < id;
+    });
+    auto last = upper_bound(first, schedules.end(), ucId, [](const string &id, const ClassSchedule &cs) {
+        return id < cs.getUcClass().getUcId();
+    });
+    return {first, last};
+}
+
+/**
+ * @brief Function that returns a vector with copies of the ClassSchedules of a given uc
+ * @details Time complexity: O(log n) + O(jq) where n is the number of schedules, j the number of ClassSchedules with
+ * the given ucId and q the number of students in each of them. @see schedulesOfUc() to iterate them without copies
  * @param ucCode
  * @return A vector with all the classes of a given uc
  */
 vector<ClassSchedule> ScheduleManager::classesOfUc(const string &ucId) const {
-    vector<ClassSchedule> classes;
-    for(const ClassSchedule &cs : schedules){
-        if(cs.getUcClass().getUcId() == ucId){
-            classes.push_back(cs);
-        }
-    }
-    return classes;
+    ScheduleView view = schedulesOfUc(ucId);
+    return vector<ClassSchedule>(view.begin(), view.end());
 }
 
 /**
  * @brief Function that returns a vector with the students of a given class
  * @param ucCode
- * @details Time Complexity: O(n) + O(jq) where n is the number of schedules(lines in classes_per_uc.csv file),
+ * @details Time Complexity: O(log n) + O(jq) where n is the number of schedules(lines in classes_per_uc.csv file),
  * j the number of ClassSchedules with a given ucId and q the number of students in a given ClassSchedule cs
  * @return A vector with all the students of a given uc
  */
 vector<Student> ScheduleManager::studentsOfUc(const string &ucId) const {
     vector<Student> ucStudents;
-    vector<ClassSchedule> ucClasses = classesOfUc(ucId); //O(n)
+    ScheduleView ucClasses = schedulesOfUc(ucId); //O(log n)
+    size_t total = 0;
+    for(const ClassSchedule &cs : ucClasses) total += cs.getNumStudents();
+    ucStudents.reserve(total);
     for(const ClassSchedule &cs : ucClasses){ //O(jq)
-        for(const Student &student : cs.getStudents()){
-            ucStudents.push_back(student);
-        }
+        ucStudents.insert(ucStudents.end(), cs.getStudents().begin(), cs.getStudents().end());
     }
     return ucStudents;
 }
 
 /**
  * @brief Function that returns the number of students in a given uc
- * @details returns the size of the vector studentsOfUc \n
- * Time complexity: O(n) + O(jq), where n is the number of schedules(lines in classes_per_uc.csv file),
- * j the number of ClassSchedules with a given ucId and q the number of students in a given ClassSchedule
+ * @details sums the sizes of the classes of the uc, without copying the students \n
+ * Time complexity: O(log n) + O(j), where n is the number of schedules(lines in classes_per_uc.csv file)
+ * and j the number of ClassSchedules with a given ucId
  */
 int ScheduleManager::getNumberOfStudentsUc(const std::string &ucId) const {
-    return studentsOfUc(ucId).size();
+    int total = 0;
+    for(const ClassSchedule &cs : schedulesOfUc(ucId)) total += cs.getNumStudents();
+    return total;
 }
 
 /**
  * @brief Function that gets the number of students in a given class of a given uc
  * @details Time complexity: O(log n) being n the number of schedules, @see findSchedule()
+ * @param overlay tentative changes to count the students with (null to count the real ones)
  */
-int ScheduleManager::getNumberOfStudentsUcClass(const UcClass &ucClass) const{
-    return findSchedule(ucClass)->getStudents().size();
+int ScheduleManager::getNumberOfStudentsUcClass(const UcClass &ucClass, const RequestOverlay *overlay) const{
+    if(overlay) return overlay->getNumStudents(binarySearchSchedules(ucClass));
+    return findSchedule(ucClass)->getNumStudents();
 }
 
 /**
@@ -231,6 +635,152 @@ int ScheduleManager::getNumberOfPendingRequests() const {
     return changingRequests.size() + enrollmentRequests.size() + removalRequests.size();
 }
 
+/**
+ * @brief Function that returns a reference to the set of students
+ * @details Time complexity: O(1)
+ */
+const StudentSet &ScheduleManager::getStudents() const {
+    return students;
+}
+
+/**
+ * @brief Adds the requests of a queue to a memory report
+ * @details std::queue doesn't expose its elements, so they are read from its underlying deque (a protected member).
+ * The deque keeps the requests in blocks of 512 bytes (as in libstdc++), each one an allocation.\n
+ * Time complexity: O(q) where q is the number of requests
+ */
+static void accountRequests(const queue<Request> &requests, MemoryReport &report) {
+    struct Access : queue<Request> {
+        static const deque<Request> &container(const queue<Request> &requests) {
+            return requests.*&Access::c;
+        }
+    };
+    const size_t perBlock = sizeof(Request) < 512 ? 512 / sizeof(Request) : 1;
+    size_t blocks = requests.size() / perBlock + 1;
+    size_t bytes = blocks * perBlock * sizeof(Request), allocations = blocks;
+    for (const Request &request : Access::container(requests)) {
+        MemoryReport::addStudent(request.getStudent(), bytes, allocations);
+        bytes += MemoryReport::heapBytes(request.getType());
+        allocations += MemoryReport::heapBytes(request.getType()) > 0;
+    }
+    report.add("pending requests (with a copy of the student)", bytes, requests.size(), allocations);
+}
+
+/**
+ * @brief Walks the structures and adds the memory each one takes to a report
+ * @details The students are counted twice over: the records of the set and the copies in the rosters of the classes
+ * (ClassSchedule::getStudents()), which only keep the id and the name. The slots are split between the records and
+ * their weekday and type strings.\n
+ * Time complexity: O(p + e + m + q) where p is the number of students, e the number of enrollments, m the number of
+ * slots and q the number of pending and rejected requests
+ */
+void ScheduleManager::accountMemory(MemoryReport &report) const {
+    report.setNumberOfStudents(students.size());
+    size_t bytes = 0, allocations = 0;
+    for (const Student &student : students) allocations += MemoryReport::heapAllocations(&student);
+    report.add("students: set nodes", students.size() * (MemoryReport::SET_NODE_OVERHEAD + sizeof(Student)),
+               students.size(), allocations);
+    bytes = allocations = 0;
+    for (const Student &student : students) MemoryReport::addStudent(student, bytes, allocations);
+    report.add("students: ids, names and classes", bytes, students.size(), allocations);
+    studentIndex.accountMemory(report);
+
+    bytes = allocations = 0;
+    MemoryReport::addVector(schedules, bytes, allocations);
+    report.add("schedules", bytes, schedules.size(), allocations);
+    size_t numSlots = 0, slotBytes = 0, slotAllocations = 0, stringBytes = 0, stringAllocations = 0;
+    size_t numCopies = 0, nodeAllocations = 0, copyBytes = 0, copyAllocations = 0;
+    for (const ClassSchedule &schedule : schedules) {
+        const SlotList &slots = schedule.getSlots();
+        numSlots += slots.size();
+        MemoryReport::addVector(slots, slotBytes, slotAllocations);
+        for (const Slot &slot : slots) {
+            for (const string *text : {&slot.getWeekDay(), &slot.getType()}) {
+                stringBytes += sizeof(string) + MemoryReport::heapBytes(*text);
+                stringAllocations += MemoryReport::heapBytes(*text) > 0;
+            }
+        }
+        numCopies += schedule.getStudents().size();
+        for (const Student &copy : schedule.getStudents()) {
+            nodeAllocations += MemoryReport::heapAllocations(&copy);
+            MemoryReport::addStudent(copy, copyBytes, copyAllocations);
+        }
+    }
+    report.add("slots", slotBytes - 2 * numSlots * sizeof(string), numSlots, slotAllocations);
+    report.add("slots: weekday and type strings", stringBytes, 2 * numSlots, stringAllocations);
+    report.add("rosters: copies of the students (set nodes)",
+               numCopies * (MemoryReport::SET_NODE_OVERHEAD + sizeof(Student)), numCopies, nodeAllocations);
+    report.add("rosters: ids and names of the copies", copyBytes, numCopies, copyAllocations);
+
+    scheduleIndex->accountMemory(report);
+    overlapMatrix->accountMemory(report);
+    sessionIndex->accountMemory(report);
+    accountRequests(changingRequests, report);
+    accountRequests(removalRequests, report);
+    accountRequests(enrollmentRequests, report);
+    bytes = allocations = 0;
+    MemoryReport::addVector(rejectedRequests, bytes, allocations);
+    for (const pair<Request, string> &rejected : rejectedRequests) {
+        MemoryReport::addStudent(rejected.first.getStudent(), bytes, allocations);
+        bytes += MemoryReport::heapBytes(rejected.second);
+        allocations += MemoryReport::heapBytes(rejected.second) > 0;
+    }
+    report.add("rejected requests", bytes, rejectedRequests.size(), allocations);
+    bytes = ucNames.bucket_count() * sizeof(void*) + ucNames.size() * (sizeof(void*) + sizeof(pair<const string, string>) + sizeof(size_t));
+    allocations = (ucNames.bucket_count() > 1) + ucNames.size();
+    for (const pair<const string, string> &name : ucNames) {
+        bytes += MemoryReport::heapBytes(name.first) + MemoryReport::heapBytes(name.second);
+        allocations += (MemoryReport::heapBytes(name.first) > 0) + (MemoryReport::heapBytes(name.second) > 0);
+    }
+    report.add("uc names of the dataset", bytes, ucNames.size(), allocations);
+    Catalog::shared().accountMemory(report);
+}
+
+/**
+ * @brief Function that returns the requests rejected so far with the reason of the rejection
+ * @details Time complexity: O(1)
+ */
+const vector<pair<Request, string>> &ScheduleManager::getRejectedRequests() const {
+    return rejectedRequests;
+}
+
+/**
+ * @brief Forgets the rejected requests, once they have been reported
+ * @details Nothing is forgotten while a checkpoint is open, a rollback restores the rejected requests it had.\n
+ * Time complexity: O(a) where a is the number of rejected requests
+ */
+void ScheduleManager::clearRejectedRequests() {
+    if (checkpoint) return;
+    rejectedRequests.clear();
+    rejectedRequests.shrink_to_fit();
+}
+
+/**
+ * @brief Records the requests submitted from now on (and the moments they are processed) in a trace
+ * @details Time complexity: O(1)
+ * @param trace trace where the requests are recorded, null to stop recording
+ */
+void ScheduleManager::setTrace(shared_ptr<RequestTrace> trace) {
+    this->trace = move(trace);
+}
+
+/**
+ * @brief Uses the workers of an existing pool (shared by several datasets) when the files are read
+ * @details Time complexity: O(1)
+ * @param pool workers used by readFiles(), null to create a pool for each load
+ */
+void ScheduleManager::setPool(ThreadPool *pool) {
+    this->pool = pool;
+}
+
+/**
+ * @brief Function that returns a reference to the vector of schedules, ordered by UcClass
+ * @details Time complexity: O(1)
+ */
+const vector<ClassSchedule> &ScheduleManager::getSchedules() const {
+    return schedules;
+}
+
 /**
  * @brief Function that returns the UcClass that the student is currently enrolled in
  * @details Time complexity: O(h) where h is the number of classes the student is enrolled in @see Student::findUcClass()
@@ -245,6 +795,7 @@ UcClass ScheduleManager::getFormerClass(const Request &request) const {
  */
 void ScheduleManager::addChangingRequest(const Student &student, const UcClass &ucClass) {
     changingRequests.push(Request(student, ucClass, "Changing"));
+    if(trace) trace->record("Changing", student.getId(), ucClass);
 }
 
 /**
@@ -253,6 +804,7 @@ void ScheduleManager::addChangingRequest(const Student &student, const UcClass &
  */
 void ScheduleManager::addEnrollmentRequest(const Student &student, const UcClass &ucClass) {
     enrollmentRequests.push(Request(student, ucClass, "Enrollment"));
+    if(trace) trace->record("Enrollment", student.getId(), ucClass);
 }
 
 /**
@@ -261,42 +813,101 @@ void ScheduleManager::addEnrollmentRequest(const Student &student, const UcClass
  */
 void ScheduleManager::addRemovalRequest(const Student &student, const UcClass &ucClass) {
     removalRequests.push(Request(student, ucClass, "Removal"));
+    if(trace) trace->record("Removal", student.getId(), ucClass);
+}
+
+/**
+ * @brief Checks that a request can be queued: the student exists and is (for Changing and Removal) or is not (for
+ * Enrollment) enrolled in the uc, and the class wanted exists
+ * @details Time complexity: O(log n) where n is the number of schedules
+ * @param type Changing, Enrollment or Removal
+ * @param classCode class wanted, ignored for a Removal
+ * @param out stream where the reason is written when the request can't be queued
+ * @return true if the request can be queued
+ */
+bool ScheduleManager::checkRequest(const string &type, const string &studentId, const string &ucCode,
+                                   const string &classCode, ostream &out) const {
+    const Student *student = findStudent(studentId); //O(1)
+    if(student == nullptr){
+        out << ">> Student not found." << endl;
+        return false;
+    }
+    bool enrolled = student->isEnrolled(ucCode);
+    if(type == "Enrollment" && enrolled){
+        out << ">> This student is already enrolled in this uc." << endl;
+        return false;
+    }
+    if(type != "Enrollment" && !enrolled){
+        out << ">> This student is not enrolled in this uc." << endl;
+        return false;
+    }
+    if(type != "Removal" && findSchedule(UcClass::lookup(ucCode, classCode)) == nullptr){ //O(log n)
+        out << ">> Class not found." << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Queues a request given by the codes, after checking it (@see checkRequest())
+ * @details A Removal is queued for the class the student is in. Time complexity: O(log n) where n is the number of
+ * schedules
+ * @param type Changing, Enrollment or Removal
+ * @param classCode class wanted, ignored for a Removal
+ * @param out stream where the reason is written when the request is not queued
+ * @return true if the request was queued
+ */
+bool ScheduleManager::submitRequest(const string &type, const string &studentId, const string &ucCode,
+                                    const string &classCode, ostream &out) {
+    if(!checkRequest(type, studentId, ucCode, classCode, out)) return false;
+    Student *student = findStudent(studentId); //O(1)
+    if(type == "Removal") addRemovalRequest(*student, student->findUcClass(ucCode));
+    else if(type == "Changing") addChangingRequest(*student, UcClass(ucCode, classCode));
+    else addEnrollmentRequest(*student, UcClass(ucCode, classCode));
+    return true;
 }
 
 /**
 * @brief Function that verifies if the schedule of two given classes have a conflict
 * @details Two UcClasses have a conflict if any pair of slots of the two classes overlap \n
- * Time complexity: O(log n) + O(lr) where n is the number of lines in classes_per_uc.csv, l is the number of slots of the first class and
- * r is the number of slots of the second class
+ * Time complexity: O(log n) where n is the number of lines in classes_per_uc.csv
 * @return true if the classes have a conflict, false otherwise
 */
 bool ScheduleManager::classesOverlap(const UcClass &c1, const UcClass &c2) const{
     if(c1.sameUcId(c2)) return false; //O(1)
-    ClassSchedule* cs1 = findSchedule(c1); //O(log n) being n the number of schedules
-    ClassSchedule* cs2 = findSchedule(c2); //O(log n)
-    for(const Slot &slot1 : cs1->getSlots()){   //O(lr) being l the number of slots of cs1 and r the number of slots of cs2
-        for(const Slot &slot2 : cs2->getSlots()){
-            if(slot1.overlaps(slot2)) return true;
-        }
-    }
-    return false;
+    unsigned long i1 = binarySearchSchedules(c1); //O(log n) being n the number of schedules
+    unsigned long i2 = binarySearchSchedules(c2); //O(log n)
+    if(i1 == ScheduleIndex::NOT_FOUND || i2 == ScheduleIndex::NOT_FOUND) return false;
+    return classesOverlap(i1, i2);
+}
+
+/**
+* @brief Function that verifies if the schedules with the given indexes have a conflict
+* @details Reads the precomputed overlap matrix, @see OverlapMatrix::overlaps() \n
+ * Time complexity: O(1)
+* @return true if the classes have a conflict, false otherwise
+*/
+bool ScheduleManager::classesOverlap(unsigned long i1, unsigned long i2) const{
+    return overlapMatrix->overlaps(i1, i2);
 }
 
 /**
 * @brief Function that verifies if a given request has a conflict with the schedule of a given student
 * @details A request has a conflict with the schedule if the class that student wants to enroll in causes a conflict with any of the current classes
 * of the student\n
- * Time complexity: O(t*log n + t*lr) where t is the number of classes the student is enrolled in, n is the number of lines in classes_per_uc.csv, l is the number of slots of the first class and
- * r is the number of slots of the second class
+ * Time complexity: O(t*log n) where t is the number of classes the student is enrolled in and n is the number of lines in classes_per_uc.csv
 * @param request
 * @return true if the request has a conflict with the schedule of the student, false otherwise
 */
 bool ScheduleManager::requestHasCollision(const Request &request) const{
-    Student student = request.getStudent(); //O(1)
-    UcClass desiredClass = request.getDesiredUcClass(); //O(1)
-    vector<UcClass> studentClasses = student.getClasses(); //O(1)
+    const UcClass &desiredClass = request.getDesiredUcClass(); //O(1)
+    unsigned long desiredIndex = binarySearchSchedules(desiredClass); //O(log n)
+    if(desiredIndex == ScheduleIndex::NOT_FOUND) return false;
+    const UcClassList &studentClasses = request.getStudent().getClasses(); //O(1)
     for (const UcClass &ucClass : studentClasses){
-        if(classesOverlap(ucClass, desiredClass)) return true; //(log n) + O(lr)
+        if(ucClass.sameUcId(desiredClass)) continue;
+        unsigned long index = binarySearchSchedules(ucClass); //O(log n)
+        if(index != ScheduleIndex::NOT_FOUND && classesOverlap(index, desiredIndex)) return true; //O(1)
     }
     return false;
 }
@@ -306,17 +917,21 @@ bool ScheduleManager::requestHasCollision(const Request &request) const{
  * @details The cap (maximum number of students in a class) is set to be the maximum number of students currently enrolled in q class.
  * If all classes have  the same number of students (and therefor the cap wouldn't  allow a new student to enroll),
  * the cap is set to the maximum number of students in a class + 1.\n
- * Time complexity: O(nlog n) where n is the number of schedules (lines in the classes_per_uc.csv file)
+ * Time complexity: O(log n + j) where n is the number of schedules (lines in the classes_per_uc.csv file) and j is the number of classes of the uc
+ * @param overlay tentative changes to count the students with (null to count the real ones)
  */
-bool ScheduleManager::requestExceedsCap(const Request &request) const{
-    vector < ClassSchedule> classesUc = classesOfUc(request.getDesiredUcClass().getUcId());  //O(n) where n is the number of schedules
-    sort(classesUc.begin(), classesUc.end(), [](const ClassSchedule &c1, const ClassSchedule &c2){  //O(nlog n)
-                                            return c1.getStudents().size() < c2.getStudents().size();
-    });
-
-    int cap = classesUc.back().getNumStudents();
-    if(classesUc[0].getNumStudents() == cap) cap++;
-    return cap < getNumberOfStudentsUcClass(request.getDesiredUcClass()) + 1;
+bool ScheduleManager::requestExceedsCap(const Request &request, const RequestOverlay *overlay) const{
+    ScheduleView classesUc = schedulesOfUc(request.getDesiredUcClass().getUcId());  //O(log n)
+    if(classesUc.empty()) return true;
+    unsigned long first = classesUc.begin() - schedules.begin(), last = first + classesUc.size();
+    int cap = 0, smallest = overlay ? overlay->getNumStudents(first) : classesUc.begin()->getNumStudents();
+    for(unsigned long i = first; i < last; i++){ //O(j)
+        int numStudents = overlay ? overlay->getNumStudents(i) : schedules[i].getNumStudents();
+        cap = max(cap, numStudents);
+        smallest = min(smallest, numStudents);
+    }
+    if(smallest == cap) cap++;
+    return cap < getNumberOfStudentsUcClass(request.getDesiredUcClass(), overlay) + 1;
 }
 
 
@@ -327,53 +942,97 @@ bool ScheduleManager::requestExceedsCap(const Request &request) const{
  * than 4. If he comes from a class with more students to a class with less students it doesn't provoke disequilibrium.\
  * If he comes from a class with less students to a class with more students it does provoke disequilibrium if the difference of the number of students is 4 or greater.\n
  * Time complexity: O(log n) where n is the number of schedules (lines in the classes_per_uc.csv file)
+ * @param overlay tentative changes to count the students with (null to count the real ones)
  */
-bool ScheduleManager::requestProvokesDisequilibrium(const Request &request) const {
-    int numFormerClass = getNumberOfStudentsUcClass((getFormerClass(request))) -1; //O(log n)
-    int numNewClass = getNumberOfStudentsUcClass(request.getDesiredUcClass()) + 1;
+bool ScheduleManager::requestProvokesDisequilibrium(const Request &request, const RequestOverlay *overlay) const {
+    int numFormerClass = getNumberOfStudentsUcClass(getFormerClass(request), overlay) -1; //O(log n)
+    int numNewClass = getNumberOfStudentsUcClass(request.getDesiredUcClass(), overlay) + 1;
 
     return (numNewClass) - (numFormerClass) >= 4;
 }
 
 /**
  * @brief Function that processes the changingRequests in the queue
- * @details if the request has any problem (conflict, disequilibrium, cap exceeded) it is added to the queue of failedRequests, otherwise it is processed and the student is removed from the former class and added to the new class\n
+ * @details if the request has any problem (the student left the uc in an earlier request, conflict, disequilibrium, cap exceeded) it is added to the queue of failedRequests, otherwise it is processed and the student is removed from the former class and added to the new class\n
  * Time complexity: O(t*log n + t*lr) + O(nlog n) where n is the number of schedules (lines in the classes_per_uc.csv file),
  * t is the number of classes the student is enrolled in, n is the number of lines in classes_per_uc.csv, l is the number of slots of the first class and
  * r is the number of slots of the second class
  */
-void ScheduleManager::processChangingRequest(const Request &request) {
-    if(requestHasCollision(request)){ //O(t*log n + t*lr)
-        rejectedRequests.emplace_back(request, "Collision in the students' schedule");
+void ScheduleManager::processChangingRequest(const Request &request, ostream &out) {
+    STATS_TIMER("request.changing");
+    Student* current = findStudent(request.getStudent().getId()); //O(1)
+    if(current == nullptr || !current->isEnrolled(request.getDesiredUcClass().getUcId())){ //removed by an earlier request
+        STATS_COUNT("request.changing.rejected.notEnrolled");
+        rejectedRequests.emplace_back(request, NOT_ENROLLED);
+    }
+    else if(requestHasCollision(request)){ //O(t*log n + t*lr)
+        STATS_COUNT("request.changing.rejected.collision");
+        rejectedRequests.emplace_back(request, COLLISION);
     }
     else if(requestExceedsCap(request)){ //O(nlog n) where n is the number of schedules (lines in the classes_per_uc.csv file)
-        rejectedRequests.emplace_back(request, "Exceeds maximum number of students allowed in the class");
+        STATS_COUNT("request.changing.rejected.cap");
+        rejectedRequests.emplace_back(request, EXCEEDS_CAP);
     }
     else if(requestProvokesDisequilibrium(request)){ //O(log n)
-        rejectedRequests.emplace_back(request, "Change provokes disequilibrium between classes");
+        STATS_COUNT("request.changing.rejected.disequilibrium");
+        rejectedRequests.emplace_back(request, DISEQUILIBRIUM);
     }
     else{
-        Student* student = findStudent(request.getStudent().getId()); //O(log n)
-        UcClass ucClass = findSchedule(request.getDesiredUcClass())->getUcClass(); //O(log n)
-        UcClass oldClass = student->changeClass(ucClass);
-        findSchedule(request.getDesiredUcClass())->addStudent(*student);
-        findSchedule(oldClass)->removeStudent(*student);
-        cout << "   "; request.printHeader();
+        STATS_COUNT("request.changing.accepted");
+        Student* student = changeStudent(current);
+        unsigned long desired = binarySearchSchedules(request.getDesiredUcClass()); //O(log n)
+        UcClass oldClass = student->changeClass(schedules[desired].getUcClass());
+        addToClass(desired, *student);
+        removeFromClass(binarySearchSchedules(oldClass), *student);
+        out << "   "; request.printHeader(out);
+    }
+}
+
+/**
+ * @brief Moves a student to another class of the same uc, without the cap and disequilibrium checks of a request
+ * @details Used to apply the moves planned by the Rebalancer. The move is refused if the student is not in the former
+ * class or the new class collides with another class of the student. The change is logged in the open checkpoint.\n
+ * Time complexity: O(t log n) + O(log q) where t is the number of classes of the student, n the number of schedules
+ * and q the number of students of a class
+ * @return false if the move was refused
+ */
+bool ScheduleManager::moveStudent(const string &studentId, const UcClass &from, const UcClass &to) {
+    Student *student = findStudent(studentId);
+    if(student == nullptr || !from.sameUcId(to) || !(student->findUcClass(from.getUcId()) == from)) return false;
+    unsigned long former = binarySearchSchedules(from), desired = binarySearchSchedules(to);
+    if(former == ScheduleIndex::NOT_FOUND || desired == ScheduleIndex::NOT_FOUND) return false;
+    for(const UcClass &ucClass : student->getClasses()){
+        if(ucClass.sameUcId(to)) continue;
+        unsigned long index = binarySearchSchedules(ucClass);
+        if(index != ScheduleIndex::NOT_FOUND && classesOverlap(index, desired)) return false;
     }
+    student = changeStudent(student);
+    student->changeClass(schedules[desired].getUcClass());
+    addToClass(desired, *student);
+    removeFromClass(former, *student);
+    return true;
 }
 
 /**
  * @brief Function that processes the removalRequests in the queue
- * @details A Removal request is always accepted\n
+ * @details A Removal request is accepted unless its student doesn't exist\n
  * Time complexity: O(h) + O(log n * log n) + O(log p) where n is the number of schedules (lines in the classes_per_uc.csv file),
  * p is the number of lines in the students.csv file and h is the number of classes of the student submitting the request
  */
-void ScheduleManager::processRemovalRequest(const Request &request) {
-    Student* student = findStudent(request.getStudent().getId()); // O(log p)
-    UcClass ucClass = findSchedule(request.getDesiredUcClass())->getUcClass(); //O(log n)
-    student->removeUc(ucClass.getUcId()); //O(h)
-    findSchedule(ucClass)->removeStudent(*student); //O(log n * log n)
-    cout << "   "; request.printHeader(); cout << endl;
+void ScheduleManager::processRemovalRequest(const Request &request, ostream &out) {
+    STATS_TIMER("request.removal");
+    Student* current = findStudent(request.getStudent().getId()); // O(1)
+    if(current == nullptr){
+        STATS_COUNT("request.removal.rejected.notFound");
+        rejectedRequests.emplace_back(request, STUDENT_NOT_FOUND);
+        return;
+    }
+    STATS_COUNT("request.removal.accepted");
+    Student* student = changeStudent(current);
+    unsigned long index = binarySearchSchedules(request.getDesiredUcClass()); //O(log n)
+    student->removeUc(schedules[index].getUcClass().getUcId()); //O(h)
+    removeFromClass(index, *student); //O(log q)
+    out << "   "; request.printHeader(out); out << endl;
 }
 
 /**
@@ -382,21 +1041,30 @@ void ScheduleManager::processRemovalRequest(const Request &request) {
  * p is the number of lines in the students.csv file, t is the number of classes the student is enrolled in, n is the number of lines in classes_per_uc.csv,
  * l is the number of slots of the first class and r is the number of slots of the second class
  */
-void ScheduleManager::processEnrollmentRequest(const Request &request) {
-    if(requestHasCollision(request)){ //O(t*log n + t*lr)
-        rejectedRequests.emplace_back(request, "Collision in the students' schedule");
+void ScheduleManager::processEnrollmentRequest(const Request &request, ostream &out) {
+    STATS_TIMER("request.enrollment");
+    Student* current = findStudent(request.getStudent().getId()); //O(1)
+    if(current == nullptr){
+        STATS_COUNT("request.enrollment.rejected.notFound");
+        rejectedRequests.emplace_back(request, STUDENT_NOT_FOUND);
+    }
+    else if(requestHasCollision(request)){ //O(t*log n + t*lr)
+        STATS_COUNT("request.enrollment.rejected.collision");
+        rejectedRequests.emplace_back(request, COLLISION);
     }
     else if(requestExceedsCap(request)){ //O(nlog n)
-        rejectedRequests.emplace_back(request, "Exceeds maximum number of students allowed in the class. Choose another class");
+        STATS_COUNT("request.enrollment.rejected.cap");
+        rejectedRequests.emplace_back(request, EXCEEDS_CAP_ENROLLMENT);
     }
     else{
-        Student* student = findStudent(request.getStudent().getId()); //O(log p)
-        UcClass ucClass = findSchedule(request.getDesiredUcClass())->getUcClass(); //O(log n)
-        student->addUc(ucClass);
-        findSchedule(ucClass)->addStudent(*student); //O(log n * log q)
-        cout << "   "; request.printHeader();
+        STATS_COUNT("request.enrollment.accepted");
+        Student* student = changeStudent(current);
+        unsigned long index = binarySearchSchedules(request.getDesiredUcClass()); //O(log n)
+        student->addUc(schedules[index].getUcClass());
+        addToClass(index, *student); //O(log q)
+        out << "   "; request.printHeader(out);
     }
-    cout << endl;
+    out << endl;
 }
 
 /**
@@ -405,74 +1073,168 @@ void ScheduleManager::processEnrollmentRequest(const Request &request) {
  * p is the number of lines in the students.csv file, h is the number of classes of the student submitting the request, t is the number of classes the student is enrolled in,
  * n is the number of lines in classes_per_uc.csv, l is the number of slots of the first class and r is the number of slots of the second class
  */
-void ScheduleManager::processRequests() {
-    cout << ">> Accepted removal requests:" << endl;
+void ScheduleManager::processRequests(ostream &out) {
+    STATS_TIMER("request.processRequests");
+    if(trace) trace->record("Process", "", UcClass());
+    out << ">> Accepted removal requests:" << endl;
     while(!removalRequests.empty()){
-        Request request = removalRequests.front();
+        Request request = move(removalRequests.front());
         removalRequests.pop();
-        processRemovalRequest(request); // O(h) + O(log n * log n) + O(log p)
+        processRemovalRequest(request, out); // O(h) + O(log n * log n) + O(log p)
     }
-    cout <<endl<< ">> Accepted changing requests:" << endl;
+    out <<endl<< ">> Accepted changing requests:" << endl;
     while(!changingRequests.empty()){
-        Request request = changingRequests.front();
+        Request request = move(changingRequests.front());
         changingRequests.pop();
-        processChangingRequest(request); //O(t*log n + t*lr) + O(nlog n)
+        processChangingRequest(request, out); //O(t*log n + t*lr) + O(nlog n)
     }
-    cout <<endl<< ">> Accepted enrollment requests:" << endl;
+    out <<endl<< ">> Accepted enrollment requests:" << endl;
     while(!enrollmentRequests.empty()){
-        Request request = enrollmentRequests.front();
+        Request request = move(enrollmentRequests.front());
         enrollmentRequests.pop();
-        processEnrollmentRequest(request); //O(t*log n + t*lr) + O(nlog n) + O(log p)
+        processEnrollmentRequest(request, out); //O(t*log n + t*lr) + O(nlog n) + O(log p)
     }
     if(!rejectedRequests.empty()){
-        printRejectedRequests();
+        printRejectedRequests(out);
     }else{
-        cout <<endl<< ">> All Requests were accepted!" << endl;
+        out <<endl<< ">> All Requests were accepted!" << endl;
     }
-    string q;
-    cout << endl << "Insert any key to continue: ";
-    cin >> q;
-    cout << endl;
 }
 
 /**
- * @brief Function that writes all information to the files
- * @details Time complexity: O(st) where s is the number of students in the set and t is the number of classes of each student
- */
-void ScheduleManager::writeFiles() const {
-    ofstream file;
-    file.open("../data/students_classes.csv");
-    file << "StudentCode,StudentName,UcCode,ClassCode" << endl;
-    for (const Student &s: students) {
-        for (const UcClass &c: s.getClasses()) {
-            file << s.getId() << "," << s.getName() << "," << c.getUcId() << "," << c.getClassId() << endl;
+ * @brief Evaluates the pending requests as processRequests() would, without changing anything
+ * @details The requests are checked in the same order and with the same rules, but the students they accept are
+ * moved in a RequestOverlay instead of the students and schedules, so the later requests see the earlier ones. The
+ * requests stay pending. Prints how many of each type would be accepted and why the others would be rejected.\n
+ * Time complexity: the same as processRequests(), plus O(log c) per change where c is the number of changes
+ * @return number of requests that would be accepted
+ */
+size_t ScheduleManager::simulateRequests(ostream &out) const {
+    STATS_TIMER("request.simulateRequests");
+    RequestOverlay overlay(schedules);
+    vector<pair<const Request*, const char*>> rejected;
+    size_t removals = 0, changes = 0, enrollments = 0;
+    for(const Request &request : requestsOf(removalRequests)){
+        Student *student = findStudent(request.getStudent().getId());
+        if(student == nullptr){ rejected.emplace_back(&request, STUDENT_NOT_FOUND); continue; }
+        unsigned long index = binarySearchSchedules(request.getDesiredUcClass());
+        UcClassList &classes = overlay.classesOf(*student);
+        for(auto it = classes.begin(); it != classes.end(); it++){
+            if(it->sameUcId(request.getDesiredUcClass())){ classes.erase(it); break; }
+        }
+        overlay.removeFromClass(index, *student);
+        removals++;
+    }
+    for(const Request &request : requestsOf(changingRequests)){
+        Student *student = findStudent(request.getStudent().getId());
+        if(student == nullptr) rejected.emplace_back(&request, NOT_ENROLLED);
+        else if(!isEnrolled(overlay.classesOf(*student), request.getDesiredUcClass())) rejected.emplace_back(&request, NOT_ENROLLED);
+        else if(requestHasCollision(request)) rejected.emplace_back(&request, COLLISION);
+        else if(requestExceedsCap(request, &overlay)) rejected.emplace_back(&request, EXCEEDS_CAP);
+        else if(requestProvokesDisequilibrium(request, &overlay)) rejected.emplace_back(&request, DISEQUILIBRIUM);
+        else{
+            unsigned long desired = binarySearchSchedules(request.getDesiredUcClass()), former = ScheduleIndex::NOT_FOUND;
+            for(UcClass &ucClass : overlay.classesOf(*student)){
+                if(!ucClass.sameUcId(request.getDesiredUcClass())) continue;
+                former = binarySearchSchedules(ucClass);
+                ucClass = request.getDesiredUcClass();
+                break;
+            }
+            overlay.addToClass(desired, *student);
+            overlay.removeFromClass(former, *student);
+            changes++;
+        }
+    }
+    for(const Request &request : requestsOf(enrollmentRequests)){
+        Student *student = findStudent(request.getStudent().getId());
+        if(student == nullptr) rejected.emplace_back(&request, STUDENT_NOT_FOUND);
+        else if(requestHasCollision(request)) rejected.emplace_back(&request, COLLISION);
+        else if(requestExceedsCap(request, &overlay)) rejected.emplace_back(&request, EXCEEDS_CAP_ENROLLMENT);
+        else{
+            overlay.classesOf(*student).push_back(request.getDesiredUcClass());
+            overlay.addToClass(binarySearchSchedules(request.getDesiredUcClass()), *student);
+            enrollments++;
         }
     }
-    file.close();
+    size_t accepted = removals + changes + enrollments;
+    out << ">> Dry run: " << accepted << " of " << getNumberOfPendingRequests() << " pending requests would be accepted (nothing was changed)" << endl;
+    out << "   Removal: " << removals << " accepted, " << removalRequests.size() - removals << " rejected" << endl;
+    out << "   Changing: " << changes << " accepted, " << changingRequests.size() - changes << " rejected" << endl;
+    out << "   Enrollment: " << enrollments << " accepted, " << enrollmentRequests.size() - enrollments << " rejected" << endl;
+    if(rejected.empty()) return accepted;
+    map<string, size_t> byReason;
+    for(const pair<const Request*, const char*> &p : rejected) byReason[p.second]++;
+    out << endl << ">> Rejections by reason:" << endl;
+    for(const pair<const string, size_t> &p : byReason) out << "   " << p.second << " - " << p.first << endl;
+    out << endl << ">> Requests that would be rejected:" << endl;
+    for(const pair<const Request*, const char*> &p : rejected){
+        out << "   >> "; p.first->print(out); out <<  "      Reason: " << p.second << endl;
+    }
+    return accepted;
+}
+
+/**
+ * @brief Function that writes all information to the files
+ * @details The file is replaced atomically (@see Persister::replaceFile()), so a crash while writing leaves the
+ * previous file, and so is students_classes.col when it exists. Use a Persister to write in the background.\n
+ * Time complexity: O(s log s + st) where s is the number of students in the set and t is the number of classes of
+ * each student
+ * @see Persister::writeFiles()
+ * @return false if the file could not be written
+ */
+bool ScheduleManager::writeFiles() const {
+    STATS_TIMER("save.writeFiles");
+    return Persister::writeFiles(dataDir + "students_classes.csv", students);
+}
+
+/**
+ * @brief Index of the slots of every schedule by weekday
+ * @details Time complexity: O(1)
+ */
+const SessionIndex &ScheduleManager::getSessionIndex() const {
+    return *sessionIndex;
+}
+
+/**
+ * @brief Directory of the csv files, ending with '/'
+ * @details Time complexity: O(1)
+ */
+const string &ScheduleManager::getDataDir() const {
+    return dataDir;
+}
+
+/**
+ * @brief Abbreviation of a UC, the one read from the uc_names.csv of this dataset or else the one of the Catalog
+ * @details Time complexity: O(k) expected, where k is the length of the UcId
+ * @return the abbreviation, an empty string if the UC has no name
+ */
+string ScheduleManager::getUcName(const string &ucId) const {
+    auto it = ucNames.find(ucId);
+    return it == ucNames.end() ? Catalog::shared().ucName(ucId) : it->second;
 }
 
 /**
 * @brief Function that prints all changingRequests in the queue
  * @details Time complexity: O(v)+O(w)+O(z) where v is the number of removal request, w is the number of changing requests and z is the number of enrollment requests
 */
-void ScheduleManager::printPendingRequests() const {
-    system("clear");
+void ScheduleManager::printPendingRequests(ostream &out) const {
+    STATS_TIMER("print.pendingRequests");
     queue<Request> pendingRemovalRequests = removalRequests;
-    cout << endl << ">> Removal requests (" << pendingRemovalRequests.size() << "):" << endl;
+    out << endl << ">> Removal requests (" << pendingRemovalRequests.size() << "):" << endl;
     while (!pendingRemovalRequests.empty()) { //O(v)
-        cout << "   "; pendingRemovalRequests.front().printHeader();
+        out << "   "; pendingRemovalRequests.front().printHeader(out);
         pendingRemovalRequests.pop();
     }
     queue<Request> pendingChangingRequests = changingRequests;
-    cout << endl << ">> Changing requests (" << pendingChangingRequests.size() << "):" << endl;
+    out << endl << ">> Changing requests (" << pendingChangingRequests.size() << "):" << endl;
     while (!pendingChangingRequests.empty()) { //O(w)
-        cout << "   "; pendingChangingRequests.front().printHeader();
+        out << "   "; pendingChangingRequests.front().printHeader(out);
         pendingChangingRequests.pop();
     }
     queue<Request> pendingEnrollmentRequests = enrollmentRequests;
-    cout << endl << ">> Enrollment requests (" << pendingEnrollmentRequests.size() << "):" << endl;
+    out << endl << ">> Enrollment requests (" << pendingEnrollmentRequests.size() << "):" << endl;
     while (!pendingEnrollmentRequests.empty()) { //O(z)
-        cout << "   "; pendingEnrollmentRequests.front().printHeader();
+        out << "   "; pendingEnrollmentRequests.front().printHeader(out);
         pendingEnrollmentRequests.pop();
     }
 }
@@ -481,11 +1243,11 @@ void ScheduleManager::printPendingRequests() const {
  * @brief Function that prints all the rejected changingRequests
  * @details Time complexity: O(a) where a is the number of rejected requests
  */
-void ScheduleManager::printRejectedRequests() const {
-    system("clear");
-    cout << endl << ">> Rejected requests:" << endl;
+void ScheduleManager::printRejectedRequests(ostream &out) const {
+    STATS_TIMER("print.rejectedRequests");
+    out << endl << ">> Rejected requests:" << endl;
     for (const pair<Request, string> &p: rejectedRequests) {
-        cout << "   >> "; p.first.print(); cout <<  "      Reason: " << p.second << endl;
+        out << "   >> "; p.first.print(out); out <<  "      Reason: " << p.second << endl;
     }
 }
 
@@ -493,7 +1255,7 @@ void ScheduleManager::printRejectedRequests() const {
  * @brief  Function converts the decimal time to string
  * @details Time complexity: O(1)
  */
-string decimalToHours(int decimal){
+string decimalToHours(double decimal){
     double time = decimal;
     int timeMins = (int)floor( time * 60.0 );
     int hours = timeMins / 60;
@@ -505,16 +1267,6 @@ string decimalToHours(int decimal){
     return hoursStr + ":" + minutesStr;
 }
 
-/**
- * @brief Function that given the ucId returns the uc initials
- * @details Time complexity: O(1)
- */
-string ucIdToString(const string &ucId) {
-    /** Maps ucId to uc abbreviation */
-    map<string, string> name = {{"L.EIC001", "ALGA"}, {"L.EIC002", "AM I"}, {"L.EIC003", "FP"}, {"L.EIC004", "FSC"}, {"L.EIC005", "MD"}, {"L.EIC011", "AED"}, {"L.EIC012", "BD"}, {"L.EIC013", "F II"}, {"L.EIC014", "LDTS"}, {"L.EIC015", "SO"}, {"L.EIC021", "FSI"}, {"L.EIC022", "IPC"}, {"L.EIC023", "LBAW"}, {"L.EIC024", "PFL"}, {"L.EIC025", "RC"}};
-    return name[ucId];
-}
-
 struct compareDayWeek
 {
     bool operator()(const string &d1, const string &d2) const
@@ -533,17 +1285,17 @@ struct compareDayWeek
  *
  * @param studentId
  */
-void ScheduleManager::printStudentSchedule(const std::string &studentId) const {
-    system("clear");
+void ScheduleManager::printStudentSchedule(const std::string &studentId, ostream &out) const {
+    STATS_TIMER("print.studentSchedule");
     Student* student = findStudent(studentId); //O(log p)
     if(student == nullptr) {
-        cout << "Student not found!" << endl;
+        out << "Student not found!" << endl;
         return;
     }
 
     //Maps a weekday to a pair of slot/ucId (weekdays and slots are ordered because of map)
     map<string, map<Slot, vector<string>>, compareDayWeek> weekdaySlot;
-    vector<UcClass> studentClasses = student->getClasses();
+    const UcClassList &studentClasses = student->getClasses();
 
     for (const UcClass &ucClass: studentClasses) { //O(hlog n) + O(hl*log(r*log(c))
         ClassSchedule *cs = findSchedule(ucClass);
@@ -552,35 +1304,35 @@ void ScheduleManager::printStudentSchedule(const std::string &studentId) const {
         }
     }
 
-    cout << endl <<  ">> The student " << student->getName() << " with UP number " << student->getId()
+    out << endl <<  ">> The student " << student->getName() << " with UP number " << student->getId()
     << " is enrolled in the following classes:" << endl << "   ";
-    student->printClasses(); //O(h)
+    student->printClasses(out); //O(h)
 
-    cout << endl << ">> The student's schedule is:" << endl;
+    out << endl << ">> The student's schedule is:" << endl;
 
     for(const auto &weekday: weekdaySlot) { //number of weekdays is constant
-        cout << "   >> " << weekday.first << ": " << endl;
+        out << "   >> " << weekday.first << ": " << endl;
         for (const auto &slot: weekday.second) {//O(c) where c is the number of slots in a weekday
-            cout << "      " << decimalToHours(slot.first.getStartTime()) << " to "
+            out << "      " << decimalToHours(slot.first.getStartTime()) << " to "
                  << decimalToHours(slot.first.getEndTime()) << "\t" << slot.first.getType() << "\t";
             for (const string &classId: slot.second) {//O(d) where d is the number of classes in a slot
-                cout << ucIdToString(classId) << " - "<< classId << " ";
+                out << getUcName(classId) << " - "<< classId << " ";
             }
-            cout << endl;
+            out << endl;
         }
     }
 }
 
 /**
  * @brief Function that prints the schedule of a given class
- * @details Time complexity: O(n*l*log(r*log(c)) + O(cd) where n is the number of schedules,
+ * @details Time complexity: O(log n) + O(j*l*log(r*log(c)) + O(cd) where n is the number of schedules, j the number of schedules of the uc,
  * l is the number of slots in a schedule, c is the number of slots in a weekday,
  * r is the number of weekdays and d is the number of classes in a slot
  * @param classCode
  */
 
-void ScheduleManager::printClassSchedule(const std::string &classCode) const {
-    system("clear");
+void ScheduleManager::printClassSchedule(const std::string &classCode, ostream &out) const {
+    STATS_TIMER("print.classSchedule");
 
     //maps a weekday to a pair Slot/ucId. Because we use a map it automatically sorts the weekdays and slots
 
@@ -594,18 +1346,18 @@ void ScheduleManager::printClassSchedule(const std::string &classCode) const {
         }
     }
 
-    if(weekdaySlot.empty()) {cout<<">> Class not found"<<endl; return;}
+    if(weekdaySlot.empty()) {out<<">> Class not found"<<endl; return;}
 
-    cout << ">> The schedule for the class " << classCode << " is:" << endl;
+    out << ">> The schedule for the class " << classCode << " is:" << endl;
     for(const auto &weekday: weekdaySlot) { //number of weekdays is constant
-        cout << "   >> " << weekday.first << ": " << endl;
+        out << "   >> " << weekday.first << ": " << endl;
         for (const auto &slot: weekday.second) { //O(cd) where c is the number of slots in a given weekday and d is the number of classes in a slot
-            cout << "      " << decimalToHours(slot.first.getStartTime()) << " to "
+            out << "      " << decimalToHours(slot.first.getStartTime()) << " to "
                  << decimalToHours(slot.first.getEndTime()) << "\t" << slot.first.getType() << "\t";
             for (const string &classId: slot.second) {
-                cout << ucIdToString(classId) << " - "<< classId << " ";
+                out << getUcName(classId) << " - "<< classId << " ";
             }
-            cout << endl;
+            out << endl;
         }
     }
 
@@ -613,39 +1365,37 @@ void ScheduleManager::printClassSchedule(const std::string &classCode) const {
 
 /**
  * @brief Function that print the schedule of a given uc
- * @details Time complexity: O(n*l*log(r*log(c)) + O(cd) where n is the number of schedules,
+ * @details Time complexity: O(log n) + O(j*l*log(r*log(c)) + O(cd) where n is the number of schedules, j the number of schedules of the uc,
  * l is the number of slots in a schedule, c is the number of slots in a weekday,
  * r is the number of weekdays and d is the number of classes in a slot
  * @param ucCode
  */
-void ScheduleManager::printUcSchedule(const string &ucCode) const{
-    system("clear");
+void ScheduleManager::printUcSchedule(const string &ucCode, ostream &out) const{
+    STATS_TIMER("print.ucSchedule");
 
     //maps a weekday to a pair Slot/ucId. Because we use a map it automatically sorts the weekdays and slots
     map<string, map<Slot, vector<string>>, compareDayWeek> weekdaySlot;
 
-    for(const ClassSchedule &cs : schedules){ //O(n*l*log(r*log(c)) where n is the number of schedules, l is the number of slots in a schedule, c is the number of slots in a weekday and r is the number of weekdays
-        if(cs.getUcClass().getUcId() == ucCode){
-            for(const Slot &slot : cs.getSlots()){
-                weekdaySlot[slot.getWeekDay()][slot].push_back(cs.getUcClass().getClassId());
-            }
+    for(const ClassSchedule &cs : schedulesOfUc(ucCode)){ //O(log n) + O(j*l*log(r*log(c)) where j is the number of schedules of the uc, l is the number of slots in a schedule, c is the number of slots in a weekday and r is the number of weekdays
+        for(const Slot &slot : cs.getSlots()){
+            weekdaySlot[slot.getWeekDay()][slot].push_back(cs.getUcClass().getClassId());
         }
     }
 
     if(weekdaySlot.empty()){
-        cout << ">> Uc not found" << endl;
+        out << ">> Uc not found" << endl;
         return;
     }
-    cout << ">> The schedule for the Uc " << ucCode << " is:" << endl;
+    out << ">> The schedule for the Uc " << ucCode << " is:" << endl;
     for(const auto &weekday: weekdaySlot) { //number of weekdays is constant
-        cout << "   >> " << weekday.first << ": " << endl;
+        out << "   >> " << weekday.first << ": " << endl;
         for (const auto &slot: weekday.second) { //O(cd) where c is the number of slots in a given weekday and d is the number of classes in a slot
-            cout << "      " << decimalToHours(slot.first.getStartTime()) << " to "
+            out << "      " << decimalToHours(slot.first.getStartTime()) << " to "
                  << decimalToHours(slot.first.getEndTime()) << "\t" << slot.first.getType() << "\t";
             for (const string &classCode: slot.second) {
-                cout << classCode << " ";
+                out << classCode << " ";
             }
-            cout << endl;
+            out << endl;
         }
     }
 }
@@ -655,46 +1405,112 @@ void ScheduleManager::printUcSchedule(const string &ucCode) const{
  * @details Time complexity: O(log n) + O(q log q) where n is the number of schedules(lines classes_per_uc.csv)
  * and q is the number of students in the ClassSchedule
  */
-void ScheduleManager::printClassStudents(const UcClass &ucClass, const string &orderType) const{
+void ScheduleManager::printClassStudents(const UcClass &ucClass, const string &orderType, ostream &out) const{
+    STATS_TIMER("print.classStudents");
     ClassSchedule* cs = findSchedule(ucClass); //O(log n)
     if(cs == nullptr){
-        cout << ">> Class not found" << endl;
+        out << ">> Class not found" << endl;
         return;
     }
-    system("clear");
-    cout<<">> The students of the class "<<ucClass.getClassId()<<" in the uc " << ucClass.getUcId()<<" are:"<<endl;
-    cs->printStudents(orderType); //O(q log q), where q is the number of students in the ClassSchedule
+    out<<">> The students of the class "<<ucClass.getClassId()<<" in the uc " << ucClass.getUcId()<<" are:"<<endl;
+    cs->printStudents(orderType, out); //O(q log q), where q is the number of students in the ClassSchedule
+}
+
+/**
+ * @brief Function that prints the classes in session on a weekday at a time or during a period, with their number of
+ * students and, optionally, the students
+ * @details The slots are found with the SessionIndex, then the students of the classes found are merged (a student
+ * is listed once even if two of his classes are in session).\n
+ * Time complexity: O(log m + k) + O(d log d) where m is the number of slots of the day, k the number of slots found
+ * and d the number of students listed
+ * @param start time, in hours
+ * @param end end of the period, if it is not after start only the time start is checked
+ * @param type type of the slots (T, TP, PL), every type if it is empty
+ * @see SessionIndex
+ */
+void ScheduleManager::printClassesInSession(const string &weekDay, float start, float end, const string &type,
+                                            bool listStudents, ostream &out) const {
+    STATS_TIMER("print.classesInSession");
+    int day = Slot::weekDayIndex(weekDay);
+    if (day < 0) {
+        out << ">> Invalid weekday" << endl;
+        return;
+    }
+    vector<SessionIndex::Session> found;
+    if (end > start) sessionIndex->overlapping(day, start, end, found);
+    else sessionIndex->inSession(day, start, found);
+    if (!type.empty()) {
+        found.erase(remove_if(found.begin(), found.end(), [this, &type](const SessionIndex::Session &session) {
+            return schedules[session.schedule].getSlots()[session.slot].getType() != type;
+        }), found.end());
+    }
+    sort(found.begin(), found.end(), [this](const SessionIndex::Session &a, const SessionIndex::Session &b) {
+        if (a.start != b.start) return a.start < b.start;
+        return schedules[a.schedule].getUcClass() < schedules[b.schedule].getUcClass();
+    });
+
+    out << endl << ">> Classes in session on " << weekDay;
+    if (end > start) out << " from " << decimalToHours(start) << " to " << decimalToHours(end);
+    else out << " at " << decimalToHours(start);
+    out << (type.empty() ? "" : " (" + type + ")") << ":" << endl;
+    vector<unsigned long> classes;
+    for (const SessionIndex::Session &session : found) {
+        const ClassSchedule &cs = schedules[session.schedule];
+        out << "   " << cs.getUcClass().getUcId() << " " << cs.getUcClass().getClassId() << "\t"
+            << decimalToHours(session.start) << " to " << decimalToHours(session.end) << "\t"
+            << cs.getSlots()[session.slot].getType() << "\t" << cs.getNumStudents() << " students" << endl;
+        classes.push_back(session.schedule);
+    }
+    sort(classes.begin(), classes.end());
+    classes.erase(unique(classes.begin(), classes.end()), classes.end());
+    int enrolled = 0;
+    for (unsigned long i : classes) enrolled += schedules[i].getNumStudents();
+    out << ">> " << classes.size() << " classes with " << enrolled << " enrollments" << endl;
+    if (!listStudents) return;
+
+    StudentSort::Roster &roster = StudentSort::roster();
+    for (unsigned long i : classes) {
+        for (const Student &student : schedules[i].getStudents()) roster.push_back(&student);
+    }
+    StudentSort::sort<Numerical>(roster);
+    roster.erase(unique(roster.begin(), roster.end(), [](const Student *a, const Student *b) {
+        return a->getId() == b->getId();
+    }), roster.end());
+    out << ">> Number of students: " << roster.size() << endl;
+    out << ">> Students:" << endl;
+    for (const Student *student : roster) {
+        out << "   "; student->printHeader(out);
+    }
 }
 
 /**
  * @brief Function that prints the students enrolled a given uc
- * @details Time complexity O(n)+ O(jq) + O(d log d) where n is the number of schedules(lines in classes_per_uc.csv file),
+ * @details The students are sorted as pointers with the SortOrder named by sortType @see StudentSort\n
+ * Time complexity O(log n)+ O(jq) + O(d log d) (O(d) numerically) where n is the number of schedules(lines in classes_per_uc.csv file),
  * j the number of ClassSchedules with a given ucId, q the number of students in a given ClassSchedule cs and d is the number of students in a given uc
  * @param ucId
  */
-void ScheduleManager::printUcStudents(const string &ucId, const string &sortType) const {
-    system("clear");
-    vector<Student> studentsVector = studentsOfUc(ucId); //O(n) + O(jq) where n is the number of schedules(lines in classes_per_uc.csv file), j the number of ClassSchedules with a given ucId and q the number of students in a given ClassSchedule cs
-    if(studentsVector.empty()){
-        cout << ">> Uc not found" << endl;
+void ScheduleManager::printUcStudents(const string &ucId, const string &sortType, ostream &out) const {
+    STATS_TIMER("print.ucStudents");
+    StudentSort::Roster &roster = StudentSort::roster();
+    for(const ClassSchedule &cs : schedulesOfUc(ucId)){ //O(log n) + O(jq)
+        for(const Student &student : cs.getStudents()) roster.push_back(&student);
+    }
+    if(roster.empty()){
+        out << ">> Uc not found" << endl;
         return;
     }
-    if (sortType == "alphabetical") {
-        sort(studentsVector.begin(), studentsVector.end(), [](const Student &a, const Student &b) { return a.getName() < b.getName(); });   //O(d log d) where d is the number of students in a given uc
-    } else if (sortType == "reverse alphabetical") {
-        sort(studentsVector.rbegin(), studentsVector.rend(), [](const Student &a, const Student &b) { return a.getName() < b.getName(); }); //O(d log d)
-    } else if (sortType == "numerical") {
-        sort(studentsVector.begin(), studentsVector.end()); //O(d log d)
-    } else if (sortType == "reverse numerical") {
-        sort(studentsVector.rbegin(), studentsVector.rend()); //O(d log d)
-    } else {
-        cout << "Invalid sortType" << endl;
+    bool valid = StudentSort::dispatch(sortType, [&roster](auto order) {
+        StudentSort::sort<decltype(order)>(roster); //O(d log d) or O(d) where d is the number of students in a given uc
+    });
+    if(!valid){
+        out << "Invalid sortType" << endl;
         return;
     }
 
-    cout << endl << ">> Number of students: " << studentsVector.size() << endl;
-    cout << ">> Students:" << endl;
-    for (const Student &student: studentsVector) { //O(d)
-        cout << "   "; student.printHeader();   //O(1)
+    out << endl << ">> Number of students: " << roster.size() << endl;
+    out << ">> Students:" << endl;
+    for (const Student *student: roster) { //O(d)
+        out << "   "; student->printHeader(out);   //O(1)
     }
 }
\ No newline at end of file
@@ -3,9 +3,35 @@
 
 #include <queue>
 #include <set>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
 #include "Student.h"
 #include "ClassSchedule.h"
 #include "Request.h"
+#include "OverlapMatrix.h"
+#include "ScheduleIndex.h"
+#include "StudentIndex.h"
+#include "RequestTrace.h"
+#include "Checkpoint.h"
+#include "RequestOverlay.h"
+#include "EnrollmentColumns.h"
+#include "SessionIndex.h"
+
+class MemoryReport;
+
+/**
+ * @brief Read-only view over a contiguous range of schedules, it can be used in a range-based for without copies
+ */
+struct ScheduleView {
+    vector<ClassSchedule>::const_iterator first;
+    vector<ClassSchedule>::const_iterator last;
+
+    vector<ClassSchedule>::const_iterator begin() const { return first; }
+    vector<ClassSchedule>::const_iterator end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+};
 
 /**
  * @brief Class to store the information about the schedules, changingRequests and students.
@@ -14,48 +40,97 @@
 class ScheduleManager {
     public:
         ScheduleManager();
+        ScheduleManager(const ScheduleManager &other);
+        ScheduleManager(ScheduleManager &&other) = default;
+        ScheduleManager &operator = (const ScheduleManager &other);
+        ScheduleManager &operator = (ScheduleManager &&other) = default;
 
-        void readFiles();
+        void readFiles(const string &dataDir = "../data/");
         void createSchedules();
         void setSchedules();
         void createStudents();
+        void createStudents(const EnrollmentColumns &columns);
+        void addSlot(const UcClass &ucClass, const Slot &slot);
+        bool applyDelta(const string &path, ostream &out = cout);
 
         unsigned long binarySearchSchedules(const UcClass &desiredUcCLass) const;
         Student* findStudent(const string &studentId) const;
+        void findStudents(const vector<const string *> &studentIds, vector<Student *> &found) const;
         ClassSchedule* findSchedule(const UcClass &ucClass) const;
+        ScheduleView schedulesOfUc(const string &ucId) const;
         vector<ClassSchedule> classesOfUc(const string &ucId) const;
         vector<Student> studentsOfUc(const string &ucId) const;
         int getNumberOfStudentsUc(const string &ucId) const;
-        int getNumberOfStudentsUcClass(const UcClass &ucClass) const;
+        int getNumberOfStudentsUcClass(const UcClass &ucClass, const RequestOverlay *overlay = nullptr) const;
         int getNumberOfPendingRequests() const;
+        const vector<ClassSchedule> &getSchedules() const;
+        const StudentSet &getStudents() const;
+        const SessionIndex &getSessionIndex() const;
+        const vector<pair<Request, string>> &getRejectedRequests() const;
+        void clearRejectedRequests();
+        void setTrace(shared_ptr<RequestTrace> trace);
+        void setPool(ThreadPool *pool);
         UcClass getFormerClass(const Request &request) const;
 
         void addChangingRequest(const Student &student, const UcClass &ucClass);
         void addEnrollmentRequest(const Student &student, const UcClass &ucClass);
         void addRemovalRequest(const Student &student, const UcClass &ucClass);
+        bool checkRequest(const string &type, const string &studentId, const string &ucCode, const string &classCode,
+                          ostream &out = cout) const;
+        bool submitRequest(const string &type, const string &studentId, const string &ucCode, const string &classCode,
+                           ostream &out = cout);
         bool classesOverlap(const UcClass &c1, const UcClass &c2) const;
+        bool classesOverlap(unsigned long i1, unsigned long i2) const;
         bool requestHasCollision(const Request &request) const;
-        bool requestExceedsCap(const Request &request) const;
-        bool requestProvokesDisequilibrium(const Request &request) const;
-        void processChangingRequest(const Request &request);
-        void processRemovalRequest(const Request &request);
-        void processEnrollmentRequest(const Request &request);
-        void processRequests();
-        void writeFiles() const;
-        void printPendingRequests() const;
-        void printRejectedRequests() const;
+        bool requestExceedsCap(const Request &request, const RequestOverlay *overlay = nullptr) const;
+        bool requestProvokesDisequilibrium(const Request &request, const RequestOverlay *overlay = nullptr) const;
+        void processChangingRequest(const Request &request, ostream &out = cout);
+        void processRemovalRequest(const Request &request, ostream &out = cout);
+        void processEnrollmentRequest(const Request &request, ostream &out = cout);
+        bool moveStudent(const string &studentId, const UcClass &from, const UcClass &to);
+        void processRequests(ostream &out = cout);
+        size_t simulateRequests(ostream &out = cout) const;
+        void clearPendingRequests();
+        bool beginCheckpoint();
+        bool commitCheckpoint();
+        bool rollbackCheckpoint();
+        bool hasCheckpoint() const;
+        size_t getNumberOfCheckpointChanges() const;
+        bool writeFiles() const;
+        const string &getDataDir() const;
+        string getUcName(const string &ucId) const;
+        void printPendingRequests(ostream &out = cout) const;
+        void accountMemory(MemoryReport &report) const;
+        void printRejectedRequests(ostream &out = cout) const;
 
-        void printStudentSchedule(const string &studentId) const;
-        void printClassSchedule(const string &classCode) const;
-        void printUcSchedule(const string &ucId) const;
-        void printClassStudents(const UcClass &ucClass, const string &orderType) const;
-        void printUcStudents(const string &ucId,  const string &sortType) const;
+        void printStudentSchedule(const string &studentId, ostream &out = cout) const;
+        void printClassSchedule(const string &classCode, ostream &out = cout) const;
+        void printUcSchedule(const string &ucId, ostream &out = cout) const;
+        void printClassStudents(const UcClass &ucClass, const string &orderType, ostream &out = cout) const;
+        void printUcStudents(const string &ucId,  const string &sortType, ostream &out = cout) const;
+        void printClassesInSession(const string &weekDay, float start, float end, const string &type, bool listStudents,
+                                   ostream &out = cout) const;
 
     private:
+        Student *changeStudent(Student *student);
+        void fillRosters(const vector<vector<const Student *>> &members);
+        void addToClass(unsigned long schedule, const Student &student);
+        void removeFromClass(unsigned long schedule, const Student &student);
+
+        /** @brief Directory of the csv files (ending with '/') */
+        string dataDir;
         /** @brief Set that stores all the students */
-        set<Student> students;
+        StudentSet students;
+        /** @brief Index from the UP number of a student to its record in students */
+        StudentIndex studentIndex;
         /** @brief Vector that stores all the schedules */
         vector<ClassSchedule> schedules;
+        /** @brief Search index over the UcClasses of the schedules, shared with the copies (it only changes when they are read) */
+        shared_ptr<const ScheduleIndex> scheduleIndex;
+        /** @brief Precomputed overlaps between every pair of schedules, shared with the copies until a slot is added */
+        shared_ptr<const OverlapMatrix> overlapMatrix;
+        /** @brief Slots of every schedule by weekday, to find the classes in session at a time, shared like the overlaps */
+        shared_ptr<const SessionIndex> sessionIndex;
         /** @brief Queue that stores all the changing requests */
         queue<Request> changingRequests;
         /** @brief Queue that stores all the removal requests */
@@ -64,6 +139,14 @@ class ScheduleManager {
         queue<Request> enrollmentRequests;
         /** @brief Queue that stores all the rejected changingRequests */
         vector<pair<Request, string>> rejectedRequests;
+        /** @brief Trace where the submitted requests are recorded (null if they are not recorded) */
+        shared_ptr<RequestTrace> trace;
+        /** @brief Workers used to load the files, shared with other datasets (null to use a pool of its own) */
+        ThreadPool *pool;
+        /** @brief Undo log since the last checkpoint (null if there is no open checkpoint) */
+        unique_ptr<Checkpoint> checkpoint;
+        /** @brief Abbreviations read from the uc_names.csv of the dataset, they take precedence over the Catalog ones */
+        unordered_map<string, string> ucNames;
 };
 
 
@@ -0,0 +1,432 @@
+#include "Server.h"
+#include "OccupancyHeatmap.h"
+#include "Stats.h"
+#include "TimetableBuilder.h"
+#include "Rebalancer.h"
+#include "IntegrityChecker.h"
+#include "FreeTimeFinder.h"
+#include "MemoryReport.h"
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+/**
+ * @brief Converts the sort order used in the protocol to the one used by ScheduleManager
+ * @details Time complexity: O(1)
+ */
+static string protocolSortType(const string &order) {
+    if(order.empty()) return "alphabetical";
+    if(order == "reverse-alphabetical") return "reverse alphabetical";
+    if(order == "reverse-numerical") return "reverse numerical";
+    return order;
+}
+
+/**
+ * @brief Converts a submission command of the protocol to the type of the Request
+ * @details Time complexity: O(1)
+ */
+static string requestType(const string &command) {
+    if(command == "CHANGE") return "Changing";
+    if(command == "ENROLL") return "Enrollment";
+    return "Removal";
+}
+
+/**
+ * @brief Writes the whole buffer to the socket
+ * @details Time complexity: O(b) where b is the size of the buffer
+ * @return false if the client closed the connection
+ */
+static bool sendAll(int fd, const string &data) {
+    size_t sent = 0;
+    while(sent < data.size()){
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) return false;
+        sent += n;
+    }
+    return true;
+}
+
+/**
+ * @brief Constructor, the server only starts listening when run() is called
+ * @details Time complexity: O(1)
+ * @param datasets datasets to serve, already loaded, the commands are handled by their pool of workers
+ * @param socketPath path of the Unix domain socket
+ */
+Server::Server(DatasetRegistry &datasets, const string &socketPath) : datasets(datasets), pool(datasets.getPool()) {
+    this->socketPath = socketPath;
+    this->listenFd = -1;
+    this->wakePipe[0] = this->wakePipe[1] = -1;
+    this->running = false;
+}
+
+/**
+ * @brief Opens the socket and runs the event loop until stop() is called
+ * @details The event loop only waits for data, the commands of a connection are handled by a worker. A connection
+ * is not polled while one of its commands is being handled, so the responses keep the order of the commands.
+ * @return 0 if the server was stopped successfully, 1 if the socket could not be opened
+ */
+int Server::run() {
+    sockaddr_un address{};
+    if(socketPath.size() >= sizeof(address.sun_path)){
+        cerr << ">> Socket path too long: " << socketPath << endl;
+        return 1;
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socketPath.c_str());
+    if(listenFd < 0 || ::bind(listenFd, (sockaddr*) &address, sizeof(address)) < 0 || listen(listenFd, 128) < 0 || pipe(wakePipe) < 0){
+        cerr << ">> Could not listen on " << socketPath << ": " << strerror(errno) << endl;
+        if(listenFd >= 0) close(listenFd);
+        return 1;
+    }
+    fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+    fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+    running = true;
+    cout << ">> Listening on " << socketPath << " with " << pool.size() << " workers" << endl;
+
+    vector<pollfd> fds;
+    vector<shared_ptr<Connection>> polled;
+    char buffer[4096];
+    while(running){
+        fds.clear(); polled.clear();
+        fds.push_back({listenFd, POLLIN, 0});
+        fds.push_back({wakePipe[0], POLLIN, 0});
+        for(auto it = connections.begin(); it != connections.end();){
+            shared_ptr<Connection> connection = it->second;
+            if(connection->busy) { ++it; continue; }
+            if(connection->closed){
+                close(connection->fd);
+                it = connections.erase(it);
+                continue;
+            }
+            fds.push_back({connection->fd, POLLIN, 0});
+            polled.push_back(connection);
+            ++it;
+        }
+        if(poll(fds.data(), fds.size(), -1) < 0){
+            if(errno == EINTR) continue;
+            break;
+        }
+        if(fds[1].revents & POLLIN){
+            while(read(wakePipe[0], buffer, sizeof(buffer)) > 0);
+        }
+        if(fds[0].revents & POLLIN){
+            int clientFd = accept(listenFd, nullptr, nullptr);
+            if(clientFd >= 0) connections[clientFd] = make_shared<Connection>(clientFd, datasets.getDefaultName());
+        }
+        for(size_t i = 0; i < polled.size(); i++){
+            if(!(fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+            shared_ptr<Connection> connection = polled[i];
+            ssize_t n = recv(connection->fd, buffer, sizeof(buffer), 0);
+            if(n <= 0){
+                connection->closed = true;
+                continue;
+            }
+            connection->buffer.append(buffer, n);
+            size_t lineEnd = connection->buffer.rfind('\n');
+            size_t partial = lineEnd == string::npos ? connection->buffer.size() : connection->buffer.size() - lineEnd - 1;
+            if(partial > MAX_LINE){ // a line that never ends would grow the buffer without limit
+                connection->closed = true;
+                continue;
+            }
+            if(lineEnd != string::npos){
+                connection->busy = true;
+                pool.submit([this, connection]{ serveConnection(connection); });
+            }
+        }
+    }
+
+    pool.wait();
+    for(auto &connection : connections) close(connection.first);
+    connections.clear();
+    close(listenFd);
+    close(wakePipe[0]);
+    close(wakePipe[1]);
+    unlink(socketPath.c_str());
+    return 0;
+}
+
+/**
+ * @brief Asks the event loop to stop, it can be called from any thread
+ * @details Time complexity: O(1)
+ */
+void Server::stop() {
+    running = false;
+    wakeUp();
+}
+
+/**
+ * @brief Wakes up the event loop so that it polls again
+ * @details Time complexity: O(1)
+ */
+void Server::wakeUp() {
+    if(wakePipe[1] >= 0){
+        char c = 0;
+        ssize_t ignored = write(wakePipe[1], &c, 1);
+        (void) ignored;
+    }
+}
+
+/**
+ * @brief Handles every complete line received in a connection. Executed by a worker
+ * @details Time complexity: O(c) times the cost of each command, where c is the number of complete lines
+ */
+void Server::serveConnection(const shared_ptr<Connection> &connection) {
+    size_t end;
+    while((end = connection->buffer.find('\n')) != string::npos){
+        string line = connection->buffer.substr(0, end);
+        connection->buffer.erase(0, end + 1);
+        if(!line.empty() && line[line.size() - 1] == '\r') line.resize(line.size() - 1);
+        if(line == "QUIT"){
+            connection->closed = true;
+            break;
+        }
+        string response = handleCommand(line, connection->dataset);
+        if(!response.empty() && response[response.size() - 1] != '\n') response += '\n';
+        if(!sendAll(connection->fd, response + "END\n")){
+            connection->closed = true;
+            break;
+        }
+    }
+    connection->busy = false;
+    wakeUp();
+}
+
+/**
+ * @brief Executes a command and returns its response (without the END line)
+ * @details Read commands: STUDENT id, CLASS classCode, UC ucId, CLASS_STUDENTS ucId classCode [order],
+ * UC_STUDENTS ucId [order], HEATMAP [all] (CSV, T slots are only counted with "all"), TIMETABLE id ucId... (best
+ * timetables without collisions with one class of each UC), REBALANCE [ucId...] (moves that even out the classes of
+ * the UCs, every UC if none is given), CHECK (divergences between the classes of the students and the students of the
+ * classes), IN_SESSION weekDay time [endTime] [type] [students] (classes in session at the time or during the period,
+ * with their students if "students" is given), FREE_TIME id... and FREE_TIME_CLASS ucId classCode (periods from Monday to
+ * Friday, between 08:00 and 20:00 and of at least an hour, in which every student is free), MEMORY (memory taken by each
+ * structure of the last published version), STATS, VERSION and PING. Write commands: CHANGE id ucId classCode, ENROLL id ucId classCode,
+ * REMOVE id ucId, PENDING, DRYRUN (what PROCESS would accept and reject, without changing anything), PROCESS, DELTA file (enrollment changes in the students_classes.csv format, applied and published at once; only a
+ * file name is accepted, it is read from the data directory of the dataset)
+ * and REBALANCE_APPLY [ucId...] (plans the moves on the latest state, applies and publishes them). With --intake, CHANGE,
+ * ENROLL and REMOVE are checked on the last published version and submitted to the intake without the writer lock
+ * (">> Busy" when it is full) and INTAKE prints its state. Reads never wait for the writer, they see the last published version. The order can be alphabetical, reverse-alphabetical, numerical or reverse-numerical.
+ * FLUSH waits until the last published version is saved (with --persist every published version is saved in the
+ * background). DATASETS lists the datasets (name, version and number of students), USE name selects the dataset of the following commands
+ * and a command can be prefixed with "@name" to run it on another dataset.
+ * @param line command received
+ * @param dataset dataset selected by the connection, changed by USE
+ * @return text of the response
+ */
+string Server::handleCommand(const string &line, string &dataset) {
+    istringstream args(line);
+    string command, name = dataset;
+    args >> command;
+    if(!command.empty() && command[0] == '@'){
+        name = command.substr(1);
+        command.clear();
+        args >> command;
+    }
+    if(command == "DATASETS"){
+        ostringstream out;
+        for(const string &other : datasets.getNames()){
+            VersionedSchedule *versions = datasets.find(other);
+            out << other << ' ' << versions->getVersion() << ' ' << versions->current()->getStudents().size() << endl;
+        }
+        return out.str();
+    }
+    if(command == "USE") args >> name;
+    VersionedSchedule *versions = datasets.find(name);
+    if(versions == nullptr) return ">> Unknown dataset: " + name + "\n";
+    if(command == "USE"){
+        dataset = name;
+        return ">> Using dataset " + name + "\n";
+    }
+    if(command == "FLUSH"){
+        STATS_TIMER("server.flush");
+        if(versions->flush()) return ">> Saved.\n";
+        return ">> Not saved (the server was started without --persist or the write failed).\n";
+    }
+    if(command == "INTAKE"){
+        ostringstream out;
+        versions->printIntake(out);
+        return out.str();
+    }
+    if((command == "CHANGE" || command == "ENROLL" || command == "REMOVE") && versions->hasIntake()){
+        STATS_TIMER("server.submit");
+        return submitToIntake(*versions, command, args);
+    }
+    if(command == "CHANGE" || command == "ENROLL" || command == "REMOVE" || command == "PENDING" || command == "DRYRUN" || command == "PROCESS" || command == "DELTA" || command == "REBALANCE_APPLY"){
+        STATS_TIMER("server.write");
+        unique_lock<mutex> lock = versions->lockWriter();
+        return handleWrite(*versions, command, args);
+    }
+    STATS_TIMER("server.read");
+    return handleRead(*versions, command, args);
+}
+
+/**
+ * @brief Executes a read command on an immutable snapshot of a dataset
+ */
+string Server::handleRead(const VersionedSchedule &versions, const string &command, istringstream &args) const {
+    shared_ptr<const ScheduleManager> current = versions.current();
+    const ScheduleManager &snapshot = *current;
+    ostringstream out;
+    string first, second, third;
+    args >> first >> second >> third;
+    if(command == "PING") out << "PONG" << endl;
+    else if(command == "VERSION") out << versions.getVersion() << endl;
+    else if(command == "STATS") Stats::print(out);
+    else if(command == "MEMORY"){
+        MemoryReport report;
+        snapshot.accountMemory(report);
+        report.print(out);
+    }
+    else if(command == "STUDENT") snapshot.printStudentSchedule(first, out);
+    else if(command == "CLASS") snapshot.printClassSchedule(first, out);
+    else if(command == "UC") snapshot.printUcSchedule(first, out);
+    else if(command == "CLASS_STUDENTS") snapshot.printClassStudents(UcClass::lookup(first, second), protocolSortType(third), out);
+    else if(command == "UC_STUDENTS") snapshot.printUcStudents(first, protocolSortType(second), out);
+    else if(command == "TIMETABLE"){
+        Student *student = snapshot.findStudent(first);
+        if(student == nullptr) out << ">> Student not found." << endl;
+        else {
+            vector<string> ucIds = {second, third};
+            for(string ucId; args >> ucId;) ucIds.push_back(ucId);
+            ucIds.erase(remove(ucIds.begin(), ucIds.end(), string()), ucIds.end());
+            TimetableBuilder builder(snapshot); // one worker, the connections already run in parallel
+            if(builder.build(*student, ucIds, out, 1)) builder.printResults(out);
+        }
+    }
+    else if(command == "REBALANCE"){
+        vector<string> ucIds = {first, second, third};
+        for(string ucId; args >> ucId;) ucIds.push_back(ucId);
+        ucIds.erase(remove(ucIds.begin(), ucIds.end(), string()), ucIds.end());
+        Rebalancer rebalancer(snapshot);
+        rebalancer.plan(ucIds, 1); // one worker, the connections already run in parallel
+        rebalancer.printPlan(out, true);
+    }
+    else if(command == "CHECK"){
+        IntegrityChecker checker(snapshot);
+        checker.check(1); // one worker, the connections already run in parallel
+        checker.printReport(out);
+    }
+    else if(command == "IN_SESSION"){
+        float start = SessionIndex::parseTime(second), end = -1;
+        string type;
+        bool listStudents = false;
+        vector<string> tokens = {third};
+        for(string token; args >> token;) tokens.push_back(token);
+        for(const string &token : tokens){
+            if(token.empty()) continue;
+            if(token == "students") listStudents = true;
+            else if(end < 0 && SessionIndex::parseTime(token) >= 0) end = SessionIndex::parseTime(token);
+            else type = token;
+        }
+        if(start < 0 || (end >= 0 && end <= start)) out << ">> Invalid time." << endl;
+        else snapshot.printClassesInSession(first, start, end, type, listStudents, out);
+    }
+    else if(command == "FREE_TIME" || command == "FREE_TIME_CLASS"){
+        FreeTimeFinder finder(snapshot);
+        if(command == "FREE_TIME_CLASS" && snapshot.findSchedule(UcClass::lookup(first, second)) == nullptr) out << ">> Class not found." << endl;
+        else {
+            if(command == "FREE_TIME_CLASS") finder.findForClass(UcClass::lookup(first, second));
+            else {
+                vector<string> ids = {first, second, third};
+                for(string id; args >> id;) ids.push_back(id);
+                ids.erase(remove(ids.begin(), ids.end(), string()), ids.end());
+                finder.find(ids);
+            }
+            finder.printWindows(out);
+        }
+    }
+    else if(command == "HEATMAP"){
+        OccupancyHeatmap heatmap(first == "all");
+        heatmap.compute(snapshot.getSchedules());
+        heatmap.writeCsv(out);
+    }
+    else out << ">> Unknown command: " << command << endl;
+    return out.str();
+}
+
+/**
+ * @brief Executes a write command on the staging copy, the caller must hold the writer lock
+ * @details The requests are validated in the same way as in App before being queued. Queued requests are only
+ * visible to the writer path, PROCESS applies them and publishes the result as a new version.
+ */
+string Server::handleWrite(VersionedSchedule &versions, const string &command, istringstream &args) {
+    ostringstream out;
+    ScheduleManager &manager = versions.staging();
+    versions.drainIntake(); // the requests submitted before this command are seen by it
+    if(command == "PENDING"){
+        manager.printPendingRequests(out);
+        return out.str();
+    }
+    if(command == "DRYRUN"){
+        manager.simulateRequests(out);
+        return out.str();
+    }
+    if(command == "PROCESS"){
+        if(manager.getNumberOfPendingRequests() == 0){
+            out << ">> There are no pending requests." << endl;
+            return out.str();
+        }
+        manager.processRequests(out);
+        versions.publish();
+        out << ">> Published version " << versions.getVersion() << endl;
+        return out.str();
+    }
+    if(command == "DELTA"){
+        string file;
+        getline(args >> ws, file);
+        if(file.empty() || file == "." || file == ".." || file.find_first_of("/\\") != string::npos){
+            out << ">> The delta must be the name of a file in the data directory of the dataset." << endl;
+            return out.str();
+        }
+        if(manager.applyDelta(manager.getDataDir() + file, out)){
+            versions.publish();
+            out << ">> Published version " << versions.getVersion() << endl;
+        }
+        return out.str();
+    }
+    if(command == "REBALANCE_APPLY"){
+        vector<string> ucIds;
+        for(string ucId; args >> ucId;) ucIds.push_back(ucId);
+        Rebalancer rebalancer(manager);
+        rebalancer.plan(ucIds, 1); // on this worker: the shared pool can't be waited on from inside it
+        rebalancer.printPlan(out);
+        if(rebalancer.apply(manager, out) > 0){
+            versions.publish();
+            out << ">> Published version " << versions.getVersion() << endl;
+        }
+        return out.str();
+    }
+    string studentId, ucCode, classCode;
+    args >> studentId >> ucCode >> classCode;
+    if(manager.submitRequest(requestType(command), studentId, ucCode, classCode, out)) out << ">> Request submitted successfully." << endl;
+    return out.str();
+}
+
+/**
+ * @brief Submits a request through the intake of a dataset, without taking the writer lock
+ * @details The request is checked against the last published version, so the client gets the same answers as with the
+ * writer path for requests that are not valid, and checked again when it is drained. When the intake is full the
+ * client is told to retry (backpressure) instead of waiting.
+ */
+string Server::submitToIntake(VersionedSchedule &versions, const string &command, istringstream &args) const {
+    ostringstream out;
+    RequestIntake::Submission submission;
+    submission.type = requestType(command);
+    args >> submission.studentId >> submission.ucCode >> submission.classCode;
+    shared_ptr<const ScheduleManager> current = versions.current();
+    if(!current->checkRequest(submission.type, submission.studentId, submission.ucCode, submission.classCode, out)) return out.str();
+    if(versions.submit(move(submission))) out << ">> Request submitted successfully." << endl;
+    else out << ">> Busy: too many requests waiting, try again later." << endl;
+    return out.str();
+}
@@ -0,0 +1,70 @@
+#ifndef TRABALHO_SERVER_H
+#define TRABALHO_SERVER_H
+
+#include <string>
+#include <sstream>
+#include <map>
+#include <memory>
+#include <atomic>
+#include "DatasetRegistry.h"
+
+/**
+ * @brief Query server that shares the loaded datasets between many clients.
+ * @details Listens on a Unix domain socket and speaks a line based protocol: every command is one line (of at most
+ * MAX_LINE bytes, a client that sends a longer one is disconnected) and every response ends with a line containing
+ * only "END". Read queries (schedules and rosters) run concurrently on a pool of workers against the last published
+ * version, request submission and processing go through the serialized
+ * writer path of the VersionedSchedule and publish a new version when a batch is processed. When the datasets have an
+ * intake (@see VersionedSchedule::startIntake()) the requests are submitted to it without the writer lock.
+ * Each command goes to the dataset selected by the connection (USE name), or to the one named by an "@name" prefix.
+ */
+class Server {
+    public:
+        Server(DatasetRegistry &datasets, const string &socketPath);
+
+        int run();
+        void stop();
+        string handleCommand(const string &line, string &dataset);
+
+    private:
+        /** @brief State of a client connection */
+        struct Connection {
+            /** @brief Socket of the client */
+            int fd;
+            /** @brief Bytes received that were not yet handled */
+            string buffer;
+            /** @brief True while a worker is handling the commands of the connection */
+            atomic<bool> busy;
+            /** @brief True when the connection must be closed */
+            atomic<bool> closed;
+            /** @brief Dataset selected with USE, only accessed by the worker handling the connection */
+            string dataset;
+            Connection(int fd, const string &dataset) : fd(fd), busy(false), closed(false), dataset(dataset) {}
+        };
+
+        /** @brief Longest line accepted, a client that sends a longer one is disconnected */
+        static const size_t MAX_LINE = 64 * 1024;
+
+        void serveConnection(const shared_ptr<Connection> &connection);
+        void wakeUp();
+        string handleRead(const VersionedSchedule &versions, const string &command, istringstream &args) const;
+        string handleWrite(VersionedSchedule &versions, const string &command, istringstream &args);
+        string submitToIntake(VersionedSchedule &versions, const string &command, istringstream &args) const;
+
+        /** @brief Datasets being served */
+        DatasetRegistry &datasets;
+        /** @brief Path of the Unix domain socket */
+        string socketPath;
+        /** @brief Workers that handle the commands, shared with the datasets */
+        ThreadPool &pool;
+        /** @brief Open connections, indexed by socket */
+        map<int, shared_ptr<Connection>> connections;
+        /** @brief Socket where the clients connect */
+        int listenFd;
+        /** @brief Pipe used by the workers to wake up the event loop */
+        int wakePipe[2];
+        /** @brief False when the server was asked to stop */
+        atomic<bool> running;
+};
+
+#endif //TRABALHO_SERVER_H
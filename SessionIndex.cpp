@@ -0,0 +1,203 @@
+#include "SessionIndex.h"
+#include "MemoryReport.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+const int SessionIndex::DAYS;
+
+/**
+ * @brief Constructor, creates an empty index
+ * @details Time complexity: O(1)
+ */
+SessionIndex::SessionIndex() {
+    for (int day = 0; day < DAYS; day++) roots[day] = -1;
+    this->numSessions = 0;
+}
+
+/**
+ * @brief Indexes the slots of every schedule, the slots of an unknown weekday are ignored
+ * @details Time complexity: O(m log m) where m is the number of slots
+ * @param schedules schedules whose slots are indexed, a Session refers to them by position
+ */
+void SessionIndex::build(const vector<ClassSchedule> &schedules) {
+    vector<Session> sessions[DAYS];
+    numSessions = 0;
+    for (unsigned long i = 0; i < schedules.size(); i++) {
+        const SlotList &slots = schedules[i].getSlots();
+        for (unsigned s = 0; s < slots.size(); s++) {
+            int day = slots[s].getWeekDayIndex();
+            if (day < 0) continue;
+            sessions[day].push_back({i, s, slots[s].getStartTime(), slots[s].getEndTime()});
+            numSessions++;
+        }
+    }
+    for (int day = 0; day < DAYS; day++) {
+        nodes[day].clear();
+        byStart[day].clear();
+        byEnd[day].clear();
+        roots[day] = buildNode(day, sessions[day]);
+    }
+}
+
+/**
+ * @brief Builds the subtree of some slots of a day
+ * @details The center is the start of the median slot by start, so that slot stays in the node and each subtree
+ * gets at most half of the slots.\n
+ * Time complexity: O(m log m) where m is the number of slots
+ * @return position of the node in nodes[day], -1 if there are no slots
+ */
+int SessionIndex::buildNode(int day, vector<Session> &sessions) {
+    if (sessions.empty()) return -1;
+    sort(sessions.begin(), sessions.end(), [](const Session &a, const Session &b) { return a.start < b.start; });
+    float center = sessions[sessions.size() / 2].start;
+    vector<Session> left, right, here;
+    for (const Session &session : sessions) {
+        if (session.end <= center && session.start < center) left.push_back(session);
+        else if (session.start > center) right.push_back(session);
+        else here.push_back(session); // start <= center < end (or an empty slot at the center)
+    }
+    int position = (int) nodes[day].size();
+    nodes[day].push_back({center, (uint32_t) byStart[day].size(), (uint32_t) here.size(), -1, -1});
+    byStart[day].insert(byStart[day].end(), here.begin(), here.end()); // already sorted by start
+    sort(here.begin(), here.end(), [](const Session &a, const Session &b) { return a.end > b.end; });
+    byEnd[day].insert(byEnd[day].end(), here.begin(), here.end());
+    int leftChild = buildNode(day, left);
+    int rightChild = buildNode(day, right);
+    nodes[day][position].left = leftChild;
+    nodes[day][position].right = rightChild;
+    return position;
+}
+
+/**
+ * @brief Finds the slots in session at a time: the ones with start <= time < end
+ * @details Time complexity: O(log m + k) where m is the number of slots of the day and k the number found
+ * @param day index of the weekday (@see Slot::weekDayIndex())
+ * @param time hours, e.g. 14.5 for 14:30
+ * @param found vector where the slots found are appended
+ */
+void SessionIndex::inSession(int day, float time, vector<Session> &found) const {
+    if (day < 0 || day >= DAYS) return;
+    inSession(day, roots[day], time, found);
+}
+
+/**
+ * @brief Recursive step of inSession()
+ * @details The slots of the node contain its center: before the center they are in session if they already
+ * started, after it if they haven't ended yet.
+ */
+void SessionIndex::inSession(int day, int node, float time, vector<Session> &found) const {
+    while (node != -1) {
+        const Node &current = nodes[day][node];
+        if (time < current.center) {
+            for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                const Session &session = byStart[day][i];
+                if (session.start > time) break;
+                if (session.end > time) found.push_back(session);
+            }
+            node = current.left;
+        } else {
+            for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                const Session &session = byEnd[day][i];
+                if (session.end <= time) break;
+                found.push_back(session);
+            }
+            node = current.right;
+        }
+    }
+}
+
+/**
+ * @brief Finds the slots in session at some point of a period: the ones with start < end of the period and
+ * end > start of the period
+ * @details Time complexity: O(log m + k) where m is the number of slots of the day and k the number found
+ * @param day index of the weekday (@see Slot::weekDayIndex())
+ * @param start,end period, in hours
+ * @param found vector where the slots found are appended
+ */
+void SessionIndex::overlapping(int day, float start, float end, vector<Session> &found) const {
+    if (day < 0 || day >= DAYS || start >= end) return;
+    overlapping(day, roots[day], start, end, found);
+}
+
+/**
+ * @brief Recursive step of overlapping()
+ * @details A period before the center only meets the slots of the node that start before it ends and the left
+ * subtree, one after the center only the slots that end after it starts and the right subtree, and one that contains
+ * the center meets every slot of the node and both subtrees.
+ */
+void SessionIndex::overlapping(int day, int node, float start, float end, vector<Session> &found) const {
+    while (node != -1) {
+        const Node &current = nodes[day][node];
+        if (end <= current.center) {
+            for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                const Session &session = byStart[day][i];
+                if (session.start >= end) break;
+                if (session.end > start) found.push_back(session);
+            }
+            node = current.left;
+        } else if (start >= current.center) {
+            for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                const Session &session = byEnd[day][i];
+                if (session.end <= start) break;
+                if (session.start < end) found.push_back(session);
+            }
+            node = current.right;
+        } else {
+            for (uint32_t i = current.first; i < current.first + current.count; i++) {
+                const Session &session = byStart[day][i];
+                if (session.end > start) found.push_back(session); // only an empty slot at the center doesn't
+            }
+            overlapping(day, current.left, start, end, found);
+            node = current.right;
+        }
+    }
+}
+
+/**
+ * @brief Number of slots indexed
+ * @details Time complexity: O(1)
+ */
+size_t SessionIndex::size() const {
+    return numSessions;
+}
+
+/**
+ * @brief Parses a time given as hours and minutes ("14:30") or as decimal hours ("14.5")
+ * @details Time complexity: O(n) where n is the length of the text
+ * @return hours, -1 if the text is not a time of the day
+ */
+float SessionIndex::parseTime(const string &text) {
+    size_t colon = text.find(':');
+    try {
+        size_t used;
+        if (colon == string::npos) {
+            float hours = stof(text, &used);
+            return used == text.size() && hours >= 0 && hours <= 24 ? hours : -1;
+        }
+        int hours = stoi(text.substr(0, colon), &used);
+        if (used != colon || colon == 0) return -1;
+        string minutesText = text.substr(colon + 1);
+        int minutes = stoi(minutesText, &used);
+        if (used != minutesText.size() || minutesText.size() != 2) return -1;
+        if (hours < 0 || minutes < 0 || minutes >= 60 || hours * 60 + minutes > 24 * 60) return -1;
+        return hours + minutes / 60.0f;
+    } catch (const logic_error &) {
+        return -1;
+    }
+}
+
+/**
+ * @brief Adds the trees of every day to a memory report
+ * @details Time complexity: O(1)
+ */
+void SessionIndex::accountMemory(MemoryReport &report) const {
+    size_t bytes = 0, allocations = 0;
+    for (int day = 0; day < DAYS; day++) {
+        MemoryReport::addVector(nodes[day], bytes, allocations);
+        MemoryReport::addVector(byStart[day], bytes, allocations);
+        MemoryReport::addVector(byEnd[day], bytes, allocations);
+    }
+    report.add("session index", bytes, numSessions, allocations);
+}
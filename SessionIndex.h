@@ -0,0 +1,73 @@
+#ifndef TRABALHO_SESSIONINDEX_H
+#define TRABALHO_SESSIONINDEX_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "ClassSchedule.h"
+
+class MemoryReport;
+
+/**
+ * @brief Interval index over the slots of every class, one per weekday, to find the classes in session at a time or
+ * during a period
+ * @details Each weekday has a centered interval tree stored in flat arrays: a node keeps the slots that contain its
+ * center twice, sorted by start and by end, and the slots that end before the center go to the left subtree and the
+ * ones that start after it to the right. A query walks one path of the tree (two where the period contains a center)
+ * and only reads the slots of a node while they match, so it takes O(log m + k) for m slots and k results.
+ * The index only holds the times of the slots and the position of their class in the schedules, so it stays valid
+ * for every copy of the ScheduleManager that has the same schedules, and the students of a class are read from the
+ * schedules when a query is answered.
+ */
+class SessionIndex {
+    public:
+        /** @brief Slot found by a query */
+        struct Session {
+            /** @brief Index of the class in ScheduleManager::getSchedules() */
+            unsigned long schedule;
+            /** @brief Position of the slot in the slots of the class */
+            unsigned slot;
+            float start;
+            float end;
+        };
+
+        SessionIndex();
+
+        void build(const vector<ClassSchedule> &schedules);
+        void inSession(int day, float time, vector<Session> &found) const;
+        void overlapping(int day, float start, float end, vector<Session> &found) const;
+        size_t size() const;
+        void accountMemory(MemoryReport &report) const;
+
+        static float parseTime(const string &text);
+
+    private:
+        static const int DAYS = 7;
+
+        /** @brief Node of a tree, its slots are byStart[first, first + count) and byEnd[first, first + count) */
+        struct Node {
+            float center;
+            uint32_t first;
+            uint32_t count;
+            /** @brief Children, -1 if there is none */
+            int left;
+            int right;
+        };
+
+        int buildNode(int day, vector<Session> &sessions);
+        void inSession(int day, int node, float time, vector<Session> &found) const;
+        void overlapping(int day, int node, float start, float end, vector<Session> &found) const;
+
+        /** @brief Nodes of the tree of each day */
+        vector<Node> nodes[DAYS];
+        /** @brief Root of the tree of each day, -1 if the day has no slots */
+        int roots[DAYS];
+        /** @brief Slots of the nodes of each day, the slots of a node sorted by start */
+        vector<Session> byStart[DAYS];
+        /** @brief Slots of the nodes of each day, the slots of a node sorted by end, latest first */
+        vector<Session> byEnd[DAYS];
+        /** @brief Number of slots indexed */
+        size_t numSessions;
+};
+
+#endif //TRABALHO_SESSIONINDEX_H
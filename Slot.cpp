@@ -1,6 +1,7 @@
 #include "Slot.h"
 #include <string>
 #include <map>
+#include <utility>
 
 using namespace std;
 
@@ -15,26 +16,53 @@ Slot::Slot(){
  * @brief Class constructor that sets weekDay, startTime, endtime(startTime+duration) and type
  * @details Time complexity: O(1)
  */
-Slot::Slot(const string &weekDay, const float &startTime, const float &duration, const string &type) {
-    this->weekDay = weekDay;
+Slot::Slot(string weekDay, float startTime, float duration, string type) : weekDay(move(weekDay)), type(move(type)) {
     this->startTime = startTime;
     this->endTime = startTime + duration;
-    this->type = type;
 }
 
 /** @brief Returns the weekDay of the slot
  * @details Time complexity: O(1)
  * @return weekDay
  */
-string Slot::getWeekDay() const {
+const string &Slot::getWeekDay() const {
     return weekDay;
 }
 
+/** @brief Returns the position of the weekDay of the slot in the week (Monday is 0, Sunday is 6)
+ * @details Time complexity: O(1)
+ * @return index of the weekDay, -1 if the weekDay is not valid
+ */
+int Slot::getWeekDayIndex() const {
+    return weekDayIndex(weekDay);
+}
+
+/** @brief Returns the position of a weekDay in the week (Monday is 0, Sunday is 6)
+ * @details The candidate day is picked by the first two letters, so the name is compared only once.\n
+ * Time complexity: O(1)
+ * @param weekDay name of the day in English
+ * @return index of the weekDay, -1 if the weekDay is not valid
+ */
+int Slot::weekDayIndex(const string &weekDay) {
+    static const string days[] = {"Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday"};
+    if (weekDay.size() < 2) return -1;
+    int i;
+    switch (weekDay[0]) {
+        case 'M': i = 0; break;
+        case 'T': i = weekDay[1] == 'h' ? 3 : 1; break;
+        case 'W': i = 2; break;
+        case 'F': i = 4; break;
+        case 'S': i = weekDay[1] == 'a' ? 5 : 6; break;
+        default: return -1;
+    }
+    return weekDay == days[i] ? i : -1;
+}
+
 /** @brief Returns the type(T, P, PL) of the slot
  * @details Time complexity: O(1)
  * @return type
  */
-string Slot::getType() const {
+const string &Slot::getType() const {
     return type;
 }
 
@@ -12,9 +12,10 @@ using namespace std;
 class Slot {
     public:
         Slot();
-        Slot(const string &weekDay, const float &beginTime, const float &duration, const string &type);
-        string getWeekDay() const;
-        string getType() const;
+        Slot(string weekDay, float beginTime, float duration, string type);
+        const string &getWeekDay() const;
+        int getWeekDayIndex() const;
+        const string &getType() const;
         float getStartTime() const;
         float getEndTime() const;
         bool overlaps(const Slot &other) const;
@@ -22,6 +23,8 @@ class Slot {
         bool operator ==(const Slot &other) const;
         bool operator < (const Slot &other) const;
 
+        static int weekDayIndex(const string &weekDay);
+
     private:
         string weekDay;
         float startTime;
@@ -0,0 +1,205 @@
+#include "Stats.h"
+#include <map>
+#include <memory>
+#include <fstream>
+#include <iomanip>
+#include <cstdio>
+
+using namespace std;
+
+const int Metric::BUCKETS;
+
+/**
+ * @brief Constructor, every counter starts at 0
+ * @details Time complexity: O(b) where b is the number of buckets of the histogram
+ */
+Metric::Metric(const string &name) : name(name) {
+    reset();
+}
+
+/**
+ * @brief Increments the count of events
+ * @details Time complexity: O(1)
+ */
+void Metric::add(uint64_t count) {
+    this->count.fetch_add(count, memory_order_relaxed);
+}
+
+/**
+ * @brief Records a timed call
+ * @details Time complexity: O(1)
+ * @param nanoseconds duration of the call
+ */
+void Metric::record(uint64_t nanoseconds) {
+    count.fetch_add(1, memory_order_relaxed);
+    timed.fetch_add(1, memory_order_relaxed);
+    totalNs.fetch_add(nanoseconds, memory_order_relaxed);
+    uint64_t previous = maxNs.load(memory_order_relaxed);
+    while (nanoseconds > previous && !maxNs.compare_exchange_weak(previous, nanoseconds, memory_order_relaxed));
+    int bucket = nanoseconds == 0 ? 0 : 64 - __builtin_clzll(nanoseconds);
+    histogram[bucket < BUCKETS ? bucket : BUCKETS - 1].fetch_add(1, memory_order_relaxed);
+}
+
+/**
+ * @brief Sets every counter to 0
+ * @details Time complexity: O(b) where b is the number of buckets of the histogram
+ */
+void Metric::reset() {
+    count = 0; timed = 0; totalNs = 0; maxNs = 0;
+    for (atomic<uint64_t> &bucket : histogram) bucket = 0;
+}
+
+/**
+ * @brief Returns the upper bound of the bucket where the given percentile of the timed calls is
+ * @details Time complexity: O(b) where b is the number of buckets of the histogram
+ * @param p percentile between 0 and 1
+ * @return duration in nanoseconds, 0 if there are no timed calls
+ */
+uint64_t Metric::percentile(double p) const {
+    uint64_t total = timed.load(memory_order_relaxed), seen = 0;
+    if (total == 0) return 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += histogram[i].load(memory_order_relaxed);
+        if (seen >= p * total) return min<uint64_t>(uint64_t(1) << i, maxNs.load(memory_order_relaxed));
+    }
+    return maxNs.load(memory_order_relaxed);
+}
+
+/**
+ * @brief Prints the count and, if the metric was timed, the mean, percentiles, max and the non empty buckets
+ * @details Time complexity: O(b) where b is the number of buckets of the histogram
+ */
+void Metric::print(ostream &out) const {
+    uint64_t calls = timed.load(memory_order_relaxed);
+    out << "   " << left << setw(44) << name << right << setw(10) << count.load(memory_order_relaxed);
+    if (calls > 0) {
+        out << "   mean " << totalNs.load(memory_order_relaxed) / calls << " ns   p50 " << percentile(0.5)
+            << " ns   p99 " << percentile(0.99) << " ns   max " << maxNs.load(memory_order_relaxed) << " ns" << endl;
+        out << "      histogram:";
+        for (int i = 0; i < BUCKETS; i++) {
+            uint64_t n = histogram[i].load(memory_order_relaxed);
+            if (n > 0) out << " <" << (uint64_t(1) << i) << "ns:" << n;
+        }
+    }
+    out << endl;
+}
+
+/**
+ * @brief Returns the name of the metric
+ * @details Time complexity: O(1)
+ */
+const string &Metric::getName() const {
+    return name;
+}
+
+/**
+ * @brief Returns the number of events
+ * @details Time complexity: O(1)
+ */
+uint64_t Metric::getCount() const {
+    return count.load(memory_order_relaxed);
+}
+
+/** @brief Metrics of the process, ordered by name */
+static map<string, unique_ptr<Metric>> &metrics() {
+    static map<string, unique_ptr<Metric>> registry;
+    return registry;
+}
+
+/** @brief Protects the registry (not the metrics, that are atomic) */
+static mutex &metricsMutex() {
+    static mutex registryMutex;
+    return registryMutex;
+}
+
+/**
+ * @brief Returns the metric with the given name, creating it if it doesn't exist
+ * @details The reference stays valid until the end of the program.\n
+ * Time complexity: O(log k) where k is the number of metrics
+ */
+Metric &Stats::get(const string &name) {
+    lock_guard<mutex> lock(metricsMutex());
+    unique_ptr<Metric> &metric = metrics()[name];
+    if (!metric) metric.reset(new Metric(name));
+    return *metric;
+}
+
+/**
+ * @brief Prints every metric that was used at least once
+ * @details Time complexity: O(k*b) where k is the number of metrics and b is the number of buckets
+ */
+void Stats::print(ostream &out) {
+    if (!enabled()) {
+        out << ">> Statistics are disabled in this build (configure with -DSCHEDULER_STATS=ON)" << endl;
+        return;
+    }
+    lock_guard<mutex> lock(metricsMutex());
+    out << ">> Statistics:" << endl;
+    for (const auto &metric : metrics()) {
+        if (metric.second->getCount() > 0) metric.second->print(out);
+    }
+}
+
+/**
+ * @brief Sets every metric to 0
+ * @details Time complexity: O(k*b) where k is the number of metrics and b is the number of buckets
+ */
+void Stats::reset() {
+    lock_guard<mutex> lock(metricsMutex());
+    for (auto &metric : metrics()) metric.second->reset();
+}
+
+/**
+ * @brief Returns true if the program was compiled with the instrumentation
+ * @details Time complexity: O(1)
+ */
+bool Stats::enabled() {
+#ifdef SCHEDULER_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Constructor, starts the thread that writes the statistics every intervalSeconds
+ * @details Time complexity: O(1)
+ */
+PeriodicStatsDump::PeriodicStatsDump(const string &path, unsigned intervalSeconds) : path(path) {
+    this->intervalSeconds = intervalSeconds == 0 ? 1 : intervalSeconds;
+    this->stopping = false;
+    this->worker = thread([this] {
+        unique_lock<mutex> lock(stopMutex);
+        while (!stopSignal.wait_for(lock, chrono::seconds(this->intervalSeconds), [this] { return stopping; })) {
+            dump();
+        }
+    });
+}
+
+/**
+ * @brief Destructor, stops the thread and writes the statistics one last time
+ */
+PeriodicStatsDump::~PeriodicStatsDump() {
+    {
+        lock_guard<mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopSignal.notify_all();
+    worker.join();
+    dump();
+}
+
+/**
+ * @brief Writes the statistics to the file
+ * @details Time complexity: O(k*b) where k is the number of metrics and b is the number of buckets
+ */
+void PeriodicStatsDump::dump() const {
+    string temporary = path + ".tmp";
+    {
+        ofstream file(temporary);
+        if (!file) return;
+        file << ">> Dumped at " << chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count() << endl;
+        Stats::print(file);
+    }
+    rename(temporary.c_str(), path.c_str());
+}
@@ -0,0 +1,121 @@
+#ifndef TRABALHO_STATS_H
+#define TRABALHO_STATS_H
+
+#include <string>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iostream>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief Counter with a latency histogram, updated with relaxed atomics so that it can be shared between threads.
+ * @details The histogram has one bucket per power of two of nanoseconds.
+ */
+class Metric {
+    public:
+        static const int BUCKETS = 40;
+
+        explicit Metric(const string &name);
+
+        void add(uint64_t count = 1);
+        void record(uint64_t nanoseconds);
+        void reset();
+        void print(ostream &out) const;
+
+        const string &getName() const;
+        uint64_t getCount() const;
+        uint64_t percentile(double p) const;
+
+    private:
+        /** @brief Name of the metric, the prefix before the first '.' is its group */
+        string name;
+        /** @brief Number of events (or timed calls) */
+        atomic<uint64_t> count;
+        /** @brief Number of timed calls */
+        atomic<uint64_t> timed;
+        /** @brief Sum of the durations of the timed calls */
+        atomic<uint64_t> totalNs;
+        /** @brief Longest timed call */
+        atomic<uint64_t> maxNs;
+        /** @brief Bucket i counts the calls that took [2^(i-1), 2^i) nanoseconds */
+        array<atomic<uint64_t>, BUCKETS> histogram;
+};
+
+/**
+ * @brief Registry of all the metrics of the process.
+ * @details Metrics are created on first use and never destroyed, so the instrumentation macros keep a reference
+ * to them in a static local variable and only pay for the atomic updates afterwards.
+ */
+class Stats {
+    public:
+        static Metric &get(const string &name);
+        static void print(ostream &out = cout);
+        static void reset();
+        static bool enabled();
+};
+
+/**
+ * @brief Records the time between its construction and its destruction in a Metric
+ */
+class ScopedTimer {
+    public:
+        explicit ScopedTimer(Metric &metric) : metric(metric), start(chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            metric.record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        }
+        ScopedTimer(const ScopedTimer &other) = delete;
+        ScopedTimer &operator = (const ScopedTimer &other) = delete;
+
+    private:
+        Metric &metric;
+        chrono::steady_clock::time_point start;
+};
+
+/**
+ * @brief Background thread that periodically writes Stats::print() to a file (written to a temporary file and
+ * renamed, so readers never see it half written)
+ */
+class PeriodicStatsDump {
+    public:
+        PeriodicStatsDump(const string &path, unsigned intervalSeconds);
+        ~PeriodicStatsDump();
+        PeriodicStatsDump(const PeriodicStatsDump &other) = delete;
+        PeriodicStatsDump &operator = (const PeriodicStatsDump &other) = delete;
+
+        void dump() const;
+
+    private:
+        /** @brief File where the statistics are written */
+        string path;
+        /** @brief Seconds between two dumps */
+        unsigned intervalSeconds;
+        /** @brief True when the object is being destroyed */
+        bool stopping;
+        mutex stopMutex;
+        condition_variable stopSignal;
+        thread worker;
+};
+
+#define STATS_CONCAT_INNER(a, b) a##b
+#define STATS_CONCAT(a, b) STATS_CONCAT_INNER(a, b)
+
+#ifdef SCHEDULER_STATS
+/** @brief Times the rest of the enclosing scope in the metric with the given name */
+#define STATS_TIMER(name) \
+    static Metric &STATS_CONCAT(statsMetric, __LINE__) = Stats::get(name); \
+    ScopedTimer STATS_CONCAT(statsTimer, __LINE__)(STATS_CONCAT(statsMetric, __LINE__))
+/** @brief Increments the counter with the given name */
+#define STATS_COUNT(name) \
+    do { static Metric &statsCounter = Stats::get(name); statsCounter.add(); } while (0)
+#else
+#define STATS_TIMER(name) do {} while (0)
+#define STATS_COUNT(name) do {} while (0)
+#endif
+
+#endif //TRABALHO_STATS_H
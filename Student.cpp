@@ -2,6 +2,7 @@
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <utility>
 
 using namespace std;
 /**
@@ -10,17 +11,33 @@ using namespace std;
  */
 Student::Student() {
     this->id = "";
+    this->key = NO_KEY;
     this->name = "";
-    this->classes = vector<UcClass>();
+    this->classes = UcClassList();
 }
 /**
  * @brief Class constructor that receives the id and name of the student. Vector of classes is empty
- * @details Time complexity: O(1)
+ * @details The id is parsed once into the integer key. Time complexity: O(1)
  */
-Student::Student(const string &id, const string &name) {
-    this->id = id;
-    this->name = name;
-    this->classes = vector<UcClass>();
+Student::Student(string id, string name) : id(move(id)), name(move(name)) {
+    this->key = parseKey(this->id);
+}
+
+const uint64_t Student::NO_KEY;
+
+/**
+ * @brief Parses a student id (UP number) into its integer key
+ * @details Time complexity: O(1), ids with more than 18 digits are not parsed
+ * @return value of the id, NO_KEY if the id is empty, has more than 18 characters or a character that is not a digit
+ */
+uint64_t Student::parseKey(const string &id) {
+    if (id.empty() || id.size() > 18) return NO_KEY;
+    uint64_t value = 0;
+    for (char c : id) {
+        if (c < '0' || c > '9') return NO_KEY;
+        value = value * 10 + (c - '0');
+    }
+    return value;
 }
 /** @brief Adds a class to the student.
  *  @details Time complexity: O(1)
@@ -63,6 +80,13 @@ void Student::addUc(const UcClass &newClass) {
     sort(classes.begin(), classes.end());
 }
 
+/** @brief Replaces the classes of the student, used to restore a saved state
+ *  @details Time complexity: O(1)
+ */
+void Student::setClasses(UcClassList newClasses) {
+    classes = move(newClasses);
+}
+
 /** @brief Checks if the student is enrolled in a given UC
  * @details Time complexity: O(h) where h is the number of classes the student is currently enrolled in
  * @param ucCode UcCode to check
@@ -94,49 +118,60 @@ UcClass Student::findUcClass(const string &ucCode) const {
 /** @brief Prints the header of the student (Name and ID)
  * @details Time complexity: O(1)
  */
-void Student::printHeader() const {
-    cout << name << " - " << id << endl;
+void Student::printHeader(ostream &out) const {
+    out << name << " - " << id << endl;
 }
 
 /** @brief Prints the classes of the student
  * @details Time complexity: O(h) where h is the number of classes the student is currently enrolled in
  */
-void Student::printClasses() const {
+void Student::printClasses(ostream &out) const {
+    if(classes.empty()){
+        out << endl;
+        return;
+    }
     int i = 0;
     while(i < classes.size()-1){
-        cout << classes[i].getUcId() << " " << classes[i].getClassId() << "  |  ";
+        out << classes[i].getUcId() << " " << classes[i].getClassId() << "  |  ";
         i++;
     }
-    cout << classes[i].getUcId() << " " << classes[i].getClassId() << endl;
+    out << classes[i].getUcId() << " " << classes[i].getClassId() << endl;
 }
 
 /** @brief Prints the name of the student and the classes he's enrolled in (calls printHeader and printClasses)
  * @details Time complexity: O(h) where h is the number of classes the student is currently enrolled in
  */
-void Student::print() const {
-    cout << "Student: "; printHeader();
-    cout << "Classes: "; printClasses();
+void Student::print(ostream &out) const {
+    out << "Student: "; printHeader(out);
+    out << "Classes: "; printClasses(out);
 }
 
 /** @brief Returns the id of the student
  * @details Time complexity: O(1)
  * @return The id of the student
  */
-string Student::getId() const {
+const string &Student::getId() const {
     return id;
 }
 /** @brief Returns the name of the student
  * @details Time complexity: O(1)
  * @return The name of the student
  */
-string Student::getName() const {
+const string &Student::getName() const {
     return name;
 }
-/** @brief Returns the vector of classes of the student
+/** @brief Returns the integer key of the student (the value of its id)
+ * @details Time complexity: O(1)
+ * @return The key, NO_KEY if the id is not a number
+ */
+uint64_t Student::getKey() const {
+    return key;
+}
+/** @brief Returns a reference to the vector of classes of the student
  * @details Time complexity: O(1)
  * @return classes
  */
-vector <UcClass> Student::getClasses() const {
+const UcClassList &Student::getClasses() const {
     return classes;
 }
 
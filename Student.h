@@ -3,17 +3,30 @@
 
 #include <string>
 #include <vector>
+#include <iostream>
+#include <set>
+#include <cstdint>
 #include "UcClass.h"
+#include "Arena.h"
 
 using namespace std;
 
+class Student;
+/** @brief Vector of the classes of a student, allocated in the Arena while the files are read */
+typedef vector<UcClass, ArenaAllocator<UcClass>> UcClassList;
+/** @brief Set of students, allocated in the Arena while the files are read */
+typedef set<Student, less<Student>, ArenaAllocator<Student>> StudentSet;
+
 /**
  * @brief Class to store the information about a given student.
  */
 class Student {
     public:
+        /** @brief Key of the students whose id is not a number */
+        static const uint64_t NO_KEY = UINT64_MAX;
+
         Student();
-        Student(const string &id, const string &name);
+        Student(string id, string name);
 
         void addClass(const UcClass &newClass);
         UcClass changeClass(const UcClass &newClass);
@@ -21,23 +34,31 @@ class Student {
         void addUc(const UcClass &newClass);
         bool isEnrolled(const string &ucCode) const;
         UcClass findUcClass(const string &ucCode) const;
+        void setClasses(UcClassList newClasses);
 
-        void printHeader() const;
-        void printClasses() const;
-        void print() const;
+        void printHeader(ostream &out = cout) const;
+        void printClasses(ostream &out = cout) const;
+        void print(ostream &out = cout) const;
 
-        string getId() const;
-        string getName() const;
-        vector<UcClass> getClasses() const;
+        const string &getId() const;
+        const string &getName() const;
+        uint64_t getKey() const;
+        static uint64_t parseKey(const string &id);
+        const UcClassList &getClasses() const;
 
         bool operator == (const Student &other) const;
         bool operator < (const Student &other) const;
         bool operator > (const Student &other) const;
 
     private:
+        /** @brief UP number of the student */
         string id;
+        /** @brief Integer value of the id, NO_KEY if it is not a number */
+        uint64_t key;
+        /** @brief Name of the student */
         string name;
-        vector<UcClass> classes;
+        /** @brief Classes the student is enrolled in */
+        UcClassList classes;
 };
 
 
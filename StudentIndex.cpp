@@ -0,0 +1,159 @@
+#include "StudentIndex.h"
+#include "MemoryReport.h"
+
+using namespace std;
+
+/**
+ * @brief Constructor, creates an empty index
+ * @details Time complexity: O(1)
+ */
+StudentIndex::StudentIndex() {
+    this->bits = 4;
+    this->count = 0;
+    this->table.assign(size_t(1) << bits, Entry{0, nullptr});
+}
+
+/**
+ * @brief Slot where the search for a key starts (Fibonacci hashing)
+ * @details Time complexity: O(1)
+ */
+size_t StudentIndex::home(uint64_t key) const {
+    return (key * 11400714819323198485ULL) >> (64 - bits);
+}
+
+/**
+ * @brief Moves the entries to a table with the given number of slots
+ * @details Time complexity: O(c) where c is the capacity
+ * @param capacity power of two
+ */
+void StudentIndex::rehash(size_t capacity) {
+    vector<Entry> old;
+    old.swap(table);
+    bits = 0;
+    while ((size_t(1) << bits) < capacity) bits++;
+    table.assign(size_t(1) << bits, Entry{0, nullptr});
+    count = 0;
+    for (const Entry &entry : old) {
+        if (entry.student != nullptr) insert(*entry.student);
+    }
+}
+
+/**
+ * @brief Indexes every student of the set whose id is a number
+ * @details Time complexity: O(p) where p is the number of students
+ */
+void StudentIndex::build(const StudentSet &students) {
+    count = 0;
+    bits = 4;
+    while ((size_t(1) << bits) < 2 * students.size()) bits++;
+    table.assign(size_t(1) << bits, Entry{0, nullptr});
+    for (const Student &student : students) insert(student);
+}
+
+/**
+ * @brief Indexes a student, it must not be in the index yet and must stay at the same address while indexed
+ * @details Students whose id is not a number are ignored. Time complexity: O(1) amortized
+ */
+void StudentIndex::insert(const Student &student) {
+    if (student.getKey() == Student::NO_KEY) return;
+    if (2 * (count + 1) > table.size()) rehash(2 * table.size());
+    size_t mask = table.size() - 1, slot = home(student.getKey());
+    while (table[slot].student != nullptr) slot = (slot + 1) & mask;
+    table[slot] = {student.getKey(), const_cast<Student*>(&student)};
+    count++;
+}
+
+/**
+ * @brief Removes a student from the index
+ * @details The entries after it in the same run are shifted back when the removed slot is between their home slot
+ * and their slot, so that no search is interrupted by the empty slot (no tombstones are needed).\n
+ * Time complexity: O(1) expected
+ */
+void StudentIndex::erase(const Student &student) {
+    if (student.getKey() == Student::NO_KEY) return;
+    size_t mask = table.size() - 1, hole = home(student.getKey());
+    while (table[hole].student != &student) {
+        if (table[hole].student == nullptr) return;
+        hole = (hole + 1) & mask;
+    }
+    for (size_t slot = (hole + 1) & mask; table[slot].student != nullptr; slot = (slot + 1) & mask) {
+        size_t start = home(table[slot].key);
+        bool stays = hole < slot ? (hole < start && start <= slot) : (hole < start || start <= slot);
+        if (!stays) {
+            table[hole] = table[slot];
+            hole = slot;
+        }
+    }
+    table[hole] = {0, nullptr};
+    count--;
+}
+
+/**
+ * @brief Finds the student with the given id
+ * @details Time complexity: O(1) expected, no memory is allocated
+ * @return pointer to the student, nullptr if it is not indexed
+ */
+Student *StudentIndex::find(const string &studentId) const {
+    uint64_t key = Student::parseKey(studentId);
+    if (key == Student::NO_KEY) return nullptr;
+    return probe(key, studentId);
+}
+
+/**
+ * @brief Searches the table for the student with the given key and id
+ * @details Time complexity: O(1) expected
+ */
+Student *StudentIndex::probe(uint64_t key, const string &studentId) const {
+    size_t mask = table.size() - 1, slot = home(key);
+    while (table[slot].student != nullptr) {
+        if (table[slot].key == key && table[slot].student->getId() == studentId) return table[slot].student;
+        slot = (slot + 1) & mask;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Finds the students with the given ids, for many ids at once
+ * @details A lookup of a big index is two cache misses in a row: the slot and then the student, to confirm the id.
+ * The lookups are pipelined so those misses overlap: the slot of an id is prefetched 2 * AHEAD ids before it is
+ * probed and the student it points to AHEAD ids before.\n
+ * Time complexity: O(k) expected where k is the number of ids
+ * @param found vector that gets, at the position of each id, the student or nullptr if it is not indexed
+ */
+void StudentIndex::findAll(const vector<const string *> &studentIds, vector<Student *> &found) const {
+    static const size_t AHEAD = 16;
+    size_t n = studentIds.size();
+    vector<uint64_t> keys(n);
+    found.assign(n, nullptr);
+    for (size_t i = 0; i < n + 2 * AHEAD; i++) {
+        if (i < n) {
+            keys[i] = Student::parseKey(*studentIds[i]);
+            if (keys[i] != Student::NO_KEY) __builtin_prefetch(&table[home(keys[i])]);
+        }
+        if (i >= AHEAD && i - AHEAD < n && keys[i - AHEAD] != Student::NO_KEY) {
+            const Student *student = table[home(keys[i - AHEAD])].student;
+            if (student != nullptr) __builtin_prefetch(student);
+        }
+        if (i >= 2 * AHEAD && keys[i - 2 * AHEAD] != Student::NO_KEY) {
+            found[i - 2 * AHEAD] = probe(keys[i - 2 * AHEAD], *studentIds[i - 2 * AHEAD]);
+        }
+    }
+}
+
+/**
+ * @brief Number of indexed students
+ * @details Time complexity: O(1)
+ */
+size_t StudentIndex::size() const {
+    return count;
+}
+
+/**
+ * @brief Adds the table to a memory report
+ * @details Time complexity: O(1)
+ */
+void StudentIndex::accountMemory(MemoryReport &report) const {
+    size_t bytes = 0, allocations = 0;
+    MemoryReport::addVector(table, bytes, allocations);
+    report.add("student index", bytes, count, allocations);
+}
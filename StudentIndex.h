@@ -0,0 +1,48 @@
+#ifndef TRABALHO_STUDENTINDEX_H
+#define TRABALHO_STUDENTINDEX_H
+
+#include <vector>
+#include <cstdint>
+#include "Student.h"
+
+class MemoryReport;
+
+/**
+ * @brief Flat hash index from the integer key of a student (Student::getKey()) to its record in the set of students
+ * @details Open addressing with linear probing in a power of two table that is kept at most half full, so a
+ * lookup is a multiplication, a shift and usually a single probe, without allocating anything.
+ * Different ids can have the same key (ids with leading zeros), so a match is confirmed with the id.
+ * The index points into the set it was built from: it has to be rebuilt when the set is copied.
+ */
+class StudentIndex {
+    public:
+        StudentIndex();
+
+        void build(const StudentSet &students);
+        void insert(const Student &student);
+        void erase(const Student &student);
+        Student *find(const string &studentId) const;
+        void findAll(const vector<const string *> &studentIds, vector<Student *> &found) const;
+        size_t size() const;
+        void accountMemory(MemoryReport &report) const;
+
+    private:
+        /** @brief Slot of the table */
+        struct Entry {
+            uint64_t key;
+            Student *student;
+        };
+
+        size_t home(uint64_t key) const;
+        Student *probe(uint64_t key, const string &studentId) const;
+        void rehash(size_t capacity);
+
+        /** @brief Table of 2^bits slots, a slot with a null student is empty */
+        vector<Entry> table;
+        /** @brief log2 of the size of the table */
+        unsigned bits;
+        /** @brief Number of indexed students */
+        size_t count;
+};
+
+#endif //TRABALHO_STUDENTINDEX_H
@@ -0,0 +1,57 @@
+#include "StudentSort.h"
+
+using namespace std;
+
+/**
+ * @brief Empty roster of the current thread, its capacity is kept between uses
+ * @details Time complexity: O(1)
+ */
+StudentSort::Roster &StudentSort::roster() {
+    thread_local Roster students;
+    students.clear();
+    return students;
+}
+
+/**
+ * @brief Sorts the students by name
+ * @details Time complexity: O(q log q) where q is the number of students
+ */
+void StudentSort::sortBy(Roster &students, ByName) {
+    std::sort(students.begin(), students.end(), [](const Student *a, const Student *b) { return a->getName() < b->getName(); });
+}
+
+/**
+ * @brief Sorts the students by UP number with an LSD radix sort of 3 passes of 10 bits (10^9 < 2^30)
+ * @details A pass is skipped when all the students have the same digit. If an id is not a 9-digit number the
+ * students are sorted by comparison of the ids instead.\n
+ * Time complexity: O(q) where q is the number of students
+ */
+void StudentSort::sortBy(Roster &students, ByNumber) {
+    typedef pair<uint32_t, const Student*> Entry;
+    static const int BITS = 10, RADIX = 1 << BITS;
+    thread_local vector<Entry> entries, scratch;
+    entries.clear();
+    for (const Student *student : students) {
+        if (student->getId().size() != 9 || student->getKey() == Student::NO_KEY) {
+            std::sort(students.begin(), students.end(), [](const Student *a, const Student *b) { return *a < *b; });
+            return;
+        }
+        entries.emplace_back((uint32_t) student->getKey(), student);
+    }
+    scratch.resize(entries.size());
+    size_t counts[RADIX];
+    for (int shift = 0; shift < 3 * BITS; shift += BITS) {
+        fill(counts, counts + RADIX, 0);
+        for (const Entry &entry : entries) counts[(entry.first >> shift) & (RADIX - 1)]++;
+        if (!entries.empty() && counts[(entries[0].first >> shift) & (RADIX - 1)] == entries.size()) continue;
+        size_t position = 0;
+        for (size_t &count : counts) {
+            size_t digits = count;
+            count = position;
+            position += digits;
+        }
+        for (const Entry &entry : entries) scratch[counts[(entry.first >> shift) & (RADIX - 1)]++] = entry;
+        entries.swap(scratch);
+    }
+    for (size_t i = 0; i < entries.size(); i++) students[i] = entries[i].second;
+}
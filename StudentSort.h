@@ -0,0 +1,78 @@
+#ifndef TRABALHO_STUDENTSORT_H
+#define TRABALHO_STUDENTSORT_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include "Student.h"
+
+using namespace std;
+
+/** @brief Sort field: name of the student */
+struct ByName {};
+/** @brief Sort field: UP number of the student */
+struct ByNumber {};
+
+/**
+ * @brief Compile-time sort policy of a list of students, a field and a direction
+ */
+template <class SortField, bool Descending>
+struct SortOrder {
+    typedef SortField Field;
+    static const bool DESCENDING = Descending;
+};
+
+typedef SortOrder<ByName, false> Alphabetical;
+typedef SortOrder<ByName, true> ReverseAlphabetical;
+typedef SortOrder<ByNumber, false> Numerical;
+typedef SortOrder<ByNumber, true> ReverseNumerical;
+
+/**
+ * @brief Sorts lists of students by a SortOrder chosen at compile time
+ * @details The students are sorted as pointers, without copying them. Names are compared through references and
+ * UP numbers (fixed-width 9-digit values) are sorted with an LSD radix sort on their integer key (Student::getKey()).
+ * The buffers are kept per thread and reused, so after the first sorts of a given size no memory is allocated.
+ */
+class StudentSort {
+    public:
+        /** @brief List of students to sort */
+        typedef vector<const Student*> Roster;
+
+        static Roster &roster();
+        template <class Order> static void sort(Roster &students);
+        template <class Function> static bool dispatch(const string &sortType, Function function);
+
+    private:
+        static void sortBy(Roster &students, ByName);
+        static void sortBy(Roster &students, ByNumber);
+};
+
+/**
+ * @brief Sorts the students in the given order
+ * @details Time complexity: O(q log q) by name, O(q) by number, where q is the number of students
+ */
+template <class Order>
+void StudentSort::sort(Roster &students) {
+    sortBy(students, typename Order::Field());
+    if (Order::DESCENDING) reverse(students.begin(), students.end());
+}
+
+/**
+ * @brief Calls function with the SortOrder named by sortType ("alphabetical", "reverse alphabetical",
+ * "numerical" or "reverse numerical"), the only place where the order is chosen at run time
+ * @details Time complexity: O(1) plus the call
+ * @param function generic callable, called as function(Order())
+ * @return false if the sortType is not valid (function is not called)
+ */
+template <class Function>
+bool StudentSort::dispatch(const string &sortType, Function function) {
+    if (sortType == "alphabetical") function(Alphabetical());
+    else if (sortType == "reverse alphabetical") function(ReverseAlphabetical());
+    else if (sortType == "numerical") function(Numerical());
+    else if (sortType == "reverse numerical") function(ReverseNumerical());
+    else return false;
+    return true;
+}
+
+#endif //TRABALHO_STUDENTSORT_H
@@ -0,0 +1,85 @@
+#include "ThreadPool.h"
+
+/**
+ * @brief Constructor, starts the worker threads
+ * @details If numThreads is 0 the number of hardware threads is used.\n
+ * Time complexity: O(w) where w is the number of workers
+ * @param numThreads number of workers
+ */
+ThreadPool::ThreadPool(unsigned numThreads) {
+    this->active = 0;
+    this->stopping = false;
+    if(numThreads == 0) numThreads = thread::hardware_concurrency();
+    if(numThreads == 0) numThreads = 1;
+    for(unsigned i = 0; i < numThreads; i++){
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+/**
+ * @brief Destructor, finishes the pending tasks and joins the workers
+ * @details Time complexity: O(w) where w is the number of workers
+ */
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+    for(thread &worker : workers){
+        worker.join();
+    }
+}
+
+/**
+ * @brief Adds a task to the queue, it will be executed by the first free worker
+ * @details Time complexity: O(1)
+ * @param task function to execute
+ */
+void ThreadPool::submit(function<void()> task) {
+    {
+        lock_guard<mutex> lock(tasksMutex);
+        tasks.push(move(task));
+    }
+    taskAvailable.notify_one();
+}
+
+/**
+ * @brief Blocks until every submitted task has finished
+ * @details Time complexity: O(1) (excluding the time spent waiting)
+ */
+void ThreadPool::wait() {
+    unique_lock<mutex> lock(tasksMutex);
+    allDone.wait(lock, [this]{ return tasks.empty() && active == 0; });
+}
+
+/**
+ * @brief Returns the number of workers
+ * @details Time complexity: O(1)
+ */
+unsigned ThreadPool::size() const {
+    return workers.size();
+}
+
+/**
+ * @brief Loop executed by each worker: takes tasks from the queue until the pool is stopped
+ */
+void ThreadPool::workerLoop() {
+    while(true){
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(tasksMutex);
+            taskAvailable.wait(lock, [this]{ return stopping || !tasks.empty(); });
+            if(tasks.empty()) return;
+            task = move(tasks.front());
+            tasks.pop();
+            active++;
+        }
+        task();
+        {
+            lock_guard<mutex> lock(tasksMutex);
+            active--;
+            if(tasks.empty() && active == 0) allDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef TRABALHO_THREADPOOL_H
+#define TRABALHO_THREADPOOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+/**
+ * @brief Fixed-size pool of worker threads that execute submitted tasks in FIFO order.
+ */
+class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned numThreads = 0);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool &other) = delete;
+        ThreadPool &operator = (const ThreadPool &other) = delete;
+
+        void submit(function<void()> task);
+        void wait();
+        unsigned size() const;
+
+    private:
+        void workerLoop();
+
+        /** @brief Threads that execute the tasks */
+        vector<thread> workers;
+        /** @brief Tasks waiting for a free worker */
+        queue<function<void()>> tasks;
+        /** @brief Protects tasks, active and stopping */
+        mutex tasksMutex;
+        /** @brief Signals the workers that there is a new task (or that the pool is stopping) */
+        condition_variable taskAvailable;
+        /** @brief Signals wait() that every task has finished */
+        condition_variable allDone;
+        /** @brief Number of tasks currently being executed */
+        unsigned active;
+        /** @brief True when the pool is being destroyed */
+        bool stopping;
+};
+
+#endif //TRABALHO_THREADPOOL_H
@@ -0,0 +1,417 @@
+#include "TimetableBuilder.h"
+#include "ThreadPool.h"
+#include "Stats.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <mutex>
+
+/** @brief State of the search of one worker */
+struct TimetableBuilder::Search {
+    /** @brief Candidates that don't collide with the classes chosen before each level (words per level) */
+    vector<uint64_t> allowed;
+    /** @brief Half hours taken by the kept classes and the classes chosen before each level (DAYS per level) */
+    vector<uint64_t> days;
+    /** @brief Seats left in the fullest class chosen before each level */
+    vector<int> freeSeats;
+    /** @brief Candidate chosen at each level */
+    vector<unsigned> chosen;
+    /** @brief Best combinations found by the worker, best first */
+    vector<Found> best;
+    /** @brief Nodes visited that were not yet added to the shared counter */
+    size_t nodes;
+};
+
+/**
+ * @brief Finds the first bit set in [begin, end)
+ * @details Time complexity: O((end - begin) / 64)
+ * @return position of the bit, end if no bit is set
+ */
+static size_t firstInRange(const uint64_t *bits, size_t begin, size_t end) {
+    if (begin >= end) return end;
+    size_t first = begin / 64, last = (end - 1) / 64;
+    for (size_t w = first; w <= last; w++) {
+        uint64_t word = bits[w];
+        if (w == first) word &= ~uint64_t(0) << (begin % 64);
+        if (w == last && end % 64 != 0) word &= ~(~uint64_t(0) << (end % 64));
+        if (word != 0) return w * 64 + __builtin_ctzll(word);
+    }
+    return end;
+}
+
+/**
+ * @brief Constructor
+ * @details Time complexity: O(1)
+ * @param manager ScheduleManager with the files already read, it must not change while the builder is used
+ * @param maxResults number of timetables kept
+ * @param maxNodes nodes of the search after which it stops (and the results may not be the best ones)
+ */
+TimetableBuilder::TimetableBuilder(const ScheduleManager &manager, size_t maxResults, size_t maxNodes)
+    : manager(manager), maxResults(max<size_t>(maxResults, 1)), maxNodes(maxNodes), words(0), threshold(LLONG_MIN),
+      nodes(0), stopped(false) {
+    fill(keptDays, keptDays + DAYS, 0);
+}
+
+/**
+ * @brief Marks the half hours taken by the slots of a class
+ * @details Time complexity: O(l) where l is the number of slots of the class
+ */
+void TimetableBuilder::addSlots(const ClassSchedule &schedule, uint64_t *days) {
+    for (const Slot &slot : schedule.getSlots()) {
+        int day = slot.getWeekDayIndex();
+        if (day < 0) continue;
+        int begin = max(0, (int) floor(slot.getStartTime() * 2)), end = min(48, (int) ceil(slot.getEndTime() * 2));
+        if (begin < end) days[day] |= ((uint64_t(1) << (end - begin)) - 1) << begin;
+    }
+}
+
+/**
+ * @brief Order of the results: more seats left in the fullest class, then fewer gaps, then the classes
+ * @details Time complexity: O(u) where u is the number of desired UCs
+ */
+bool TimetableBuilder::better(const Found &a, const Found &b) const {
+    if (a.freeSeats != b.freeSeats) return a.freeSeats > b.freeSeats;
+    if (a.gaps != b.gaps) return a.gaps < b.gaps;
+    for (size_t level = 0; level < a.chosen.size(); level++) {
+        unsigned long x = candidates[a.chosen[level]].schedule, y = candidates[b.chosen[level]].schedule;
+        if (x != y) return x < y;
+    }
+    return false;
+}
+
+/**
+ * @brief Seats and gaps of a timetable in a single number, a better timetable has a greater score
+ * @details Time complexity: O(1)
+ */
+long long TimetableBuilder::score(int freeSeats, int gaps) {
+    return (long long) freeSeats * (1LL << 32) - gaps;
+}
+
+/**
+ * @brief Half hours between the first and the last class of a day that are not taken
+ * @details Time complexity: O(1)
+ */
+int TimetableBuilder::gapsOf(uint64_t day) {
+    if (day == 0) return 0;
+    return 64 - __builtin_clzll(day) - __builtin_ctzll(day) - __builtin_popcountll(day);
+}
+
+/**
+ * @brief Raises the score needed to enter the results, once a worker has maxResults timetables with that score
+ * @details Time complexity: O(1) expected
+ */
+void TimetableBuilder::raiseThreshold(long long minimum) const {
+    long long current = threshold.load(memory_order_relaxed);
+    while (current < minimum && !threshold.compare_exchange_weak(current, minimum, memory_order_relaxed));
+}
+
+/**
+ * @brief Keeps a complete combination if it is one of the best found by the worker
+ * @details The gaps of a day are the half hours between its first and last class that are not taken.\n
+ * Time complexity: O(k + u) where k is the number of results kept and u the number of desired UCs
+ */
+void TimetableBuilder::found(Search &state) const {
+    size_t depth = levels.size() - 1;
+    const uint64_t *days = &state.days[depth * DAYS];
+    int gaps = 0;
+    for (int day = 0; day < DAYS; day++) gaps += gapsOf(days[day]);
+    if (state.best.size() == maxResults && score(state.freeSeats[depth], gaps) < score(state.best.back().freeSeats, state.best.back().gaps)) return;
+    Found combination{state.chosen, state.freeSeats[depth], gaps};
+    if (state.best.size() == maxResults && !better(combination, state.best.back())) return;
+    auto position = upper_bound(state.best.begin(), state.best.end(), combination,
+                                [this](const Found &a, const Found &b) { return better(a, b); });
+    state.best.insert(position, combination);
+    if (state.best.size() > maxResults) state.best.pop_back();
+    if (state.best.size() == maxResults) raiseThreshold(score(state.best.back().freeSeats, state.best.back().gaps));
+}
+
+/**
+ * @brief Tries every candidate of a level that doesn't collide with the classes already chosen
+ * @details The candidates of a level are ordered by seats left, so the loop stops at the first one that can't reach
+ * the results. A candidate is skipped when a later level has no candidate left that doesn't collide with it, or
+ * when a bound of its score can't reach the results: the seats are bounded by the best candidate left of each later
+ * level and the gaps by the free half hours that no later class can take.\n
+ * Time complexity: O(c^u * u * c / 64) in the worst case, where c is the number of candidates of a UC and u the
+ * number of levels left, but most branches are cut by the bitmasks
+ */
+void TimetableBuilder::search(Search &state, size_t level) const {
+    size_t depth = levels.size() - 1;
+    if (level == depth) {
+        found(state);
+        return;
+    }
+    const uint64_t *allowed = &state.allowed[level * words];
+    uint64_t *next = &state.allowed[(level + 1) * words];
+    const uint64_t *days = &state.days[level * DAYS];
+    uint64_t *nextDays = &state.days[(level + 1) * DAYS];
+    size_t begin = levels[level], end = levels[level + 1];
+    for (size_t w = begin / 64; w <= (end - 1) / 64; w++) {
+        uint64_t word = allowed[w];
+        if (w == begin / 64) word &= ~uint64_t(0) << (begin % 64);
+        if (w == (end - 1) / 64 && end % 64 != 0) word &= ~(~uint64_t(0) << (end % 64));
+        while (word != 0) {
+            unsigned c = (unsigned) (w * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+            const Candidate &candidate = candidates[c];
+            int freeSeats = min(state.freeSeats[level], candidate.freeSeats);
+            if (score(freeSeats, 0) < threshold.load(memory_order_relaxed)) return;
+            if (++state.nodes == 1024) {
+                state.nodes = 0;
+                if (nodes.fetch_add(1024, memory_order_relaxed) + 1024 >= maxNodes) stopped = true;
+            }
+            if (stopped.load(memory_order_relaxed)) return;
+
+            const uint64_t *mask = &compatible[c * words];
+            for (size_t i = 0; i < words; i++) next[i] = allowed[i] & mask[i];
+            // every later level needs a class left, and the best one left bounds the seats of the combination
+            int bound = freeSeats;
+            bool dead = false;
+            for (size_t later = level + 1; later < depth && !dead; later++) {
+                size_t best = firstInRange(next, levels[later], levels[later + 1]);
+                dead = best == levels[later + 1];
+                if (!dead) bound = min(bound, candidates[best].freeSeats);
+            }
+            if (dead || score(bound, 0) < threshold.load(memory_order_relaxed)) continue;
+            // the gaps of a day that no class left can touch are final
+            int gaps = 0;
+            size_t laterBegin = levels[level + 1];
+            for (int day = 0; day < DAYS; day++) {
+                nextDays[day] = days[day] | candidate.days[day];
+                const uint64_t *onDay = &dayCandidates[day * words];
+                bool touched = false;
+                for (size_t i = laterBegin / 64; i < words && !touched; i++) {
+                    uint64_t later = next[i] & onDay[i];
+                    if (i == laterBegin / 64) later &= ~uint64_t(0) << (laterBegin % 64);
+                    touched = later != 0;
+                }
+                if (!touched) gaps += gapsOf(nextDays[day]);
+                else if (nextDays[day] != 0) {
+                    // half hours inside the span of the day that no class of a later UC can take stay free
+                    uint64_t span = (~uint64_t(0) >> __builtin_clzll(nextDays[day])) & (~uint64_t(0) << __builtin_ctzll(nextDays[day]));
+                    gaps += __builtin_popcountll(span & ~nextDays[day] & ~laterDays[(level + 1) * DAYS + day]);
+                }
+            }
+            if (score(bound, gaps) < threshold.load(memory_order_relaxed)) continue;
+            state.freeSeats[level + 1] = freeSeats;
+            state.chosen[level] = c;
+            search(state, level + 1);
+        }
+    }
+}
+
+/**
+ * @brief Searches the best timetables of a student with one class of each of the given UCs
+ * @details The classes of the other UCs of the student are kept. The combinations of the first levels are split
+ * between the workers, each one keeps its best timetables and they are merged at the end.\n
+ * Time complexity: O(c^2) to build the bitmasks, where c is the number of candidates, plus the search
+ * (@see search())
+ * @param student student whose timetable is built
+ * @param ucIds desired UCs
+ * @param out stream where the errors are written
+ * @param numThreads number of workers (0 uses the number of hardware threads)
+ * @return false if a UC doesn't exist or no UC was given
+ */
+bool TimetableBuilder::build(const Student &student, const vector<string> &ucIds, ostream &out, unsigned numThreads) {
+    STATS_TIMER("timetable.build");
+    results.clear();
+    candidates.clear();
+    levels.assign(1, 0);
+    ucOfLevel.clear();
+    fill(keptDays, keptDays + DAYS, 0);
+    threshold = LLONG_MIN;
+    nodes = 0;
+    stopped = false;
+
+    vector<string> desired;
+    for (const string &ucId : ucIds) {
+        if (find(desired.begin(), desired.end(), ucId) == desired.end()) desired.push_back(ucId);
+    }
+    if (desired.empty()) {
+        out << ">> No UC was given." << endl;
+        return false;
+    }
+    const vector<ClassSchedule> &schedules = manager.getSchedules();
+    vector<unsigned long> kept;
+    for (const UcClass &ucClass : student.getClasses()) {
+        if (find(desired.begin(), desired.end(), ucClass.getUcId()) != desired.end()) continue;
+        unsigned long index = manager.binarySearchSchedules(ucClass);
+        if (index == ScheduleIndex::NOT_FOUND) continue;
+        kept.push_back(index);
+        addSlots(schedules[index], keptDays);
+    }
+
+    // candidates of each UC, with the same cap as requestExceedsCap()
+    vector<vector<Candidate>> perUc(desired.size());
+    for (size_t u = 0; u < desired.size(); u++) {
+        ScheduleView classesUc = manager.schedulesOfUc(desired[u]);
+        if (classesUc.empty()) {
+            out << ">> UC " << desired[u] << " not found." << endl;
+            return false;
+        }
+        int cap = 0, smallest = classesUc.begin()->getNumStudents();
+        for (const ClassSchedule &cs : classesUc) {
+            cap = max(cap, cs.getNumStudents());
+            smallest = min(smallest, cs.getNumStudents());
+        }
+        if (smallest == cap) cap++;
+        UcClass current = student.isEnrolled(desired[u]) ? student.findUcClass(desired[u]) : UcClass();
+        for (auto it = classesUc.begin(); it != classesUc.end(); ++it) {
+            Candidate candidate{(unsigned long) (it - schedules.begin()), 0, {}};
+            candidate.freeSeats = cap - it->getNumStudents() - (it->getUcClass() == current ? 0 : 1);
+            if (candidate.freeSeats < 0) continue;
+            bool collides = false;
+            for (unsigned long k : kept) {
+                if (manager.classesOverlap(candidate.schedule, k)) { collides = true; break; }
+            }
+            if (collides) continue;
+            addSlots(*it, candidate.days);
+            perUc[u].push_back(candidate);
+        }
+        stable_sort(perUc[u].begin(), perUc[u].end(),
+                    [](const Candidate &a, const Candidate &b) { return a.freeSeats > b.freeSeats; });
+    }
+    vector<size_t> order(desired.size());
+    for (size_t u = 0; u < order.size(); u++) order[u] = u;
+    stable_sort(order.begin(), order.end(), [&perUc](size_t a, size_t b) { return perUc[a].size() < perUc[b].size(); });
+    for (size_t u : order) {
+        if (perUc[u].empty()) return true; // every class of this UC collides or is full
+        candidates.insert(candidates.end(), perUc[u].begin(), perUc[u].end());
+        levels.push_back((unsigned) candidates.size());
+        ucOfLevel.push_back(u);
+    }
+
+    size_t n = candidates.size(), depth = ucOfLevel.size();
+    words = (n + 63) / 64;
+    compatible.assign(n * words, 0);
+    for (size_t level = 0; level < depth; level++) {
+        for (size_t i = levels[level]; i < levels[level + 1]; i++) {
+            for (size_t j = levels[level + 1]; j < n; j++) {
+                if (manager.classesOverlap(candidates[i].schedule, candidates[j].schedule)) continue;
+                compatible[i * words + j / 64] |= uint64_t(1) << (j % 64);
+                compatible[j * words + i / 64] |= uint64_t(1) << (i % 64);
+            }
+        }
+    }
+
+    laterDays.assign((depth + 1) * DAYS, 0);
+    for (size_t level = depth; level-- > 0;) {
+        for (int day = 0; day < DAYS; day++) {
+            uint64_t taken = laterDays[(level + 1) * DAYS + day];
+            for (size_t i = levels[level]; i < levels[level + 1]; i++) taken |= candidates[i].days[day];
+            laterDays[level * DAYS + day] = taken;
+        }
+    }
+    dayCandidates.assign(DAYS * words, 0);
+    for (size_t i = 0; i < n; i++) {
+        for (int day = 0; day < DAYS; day++) {
+            if (candidates[i].days[day] != 0) dayCandidates[day * words + i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+
+    // split the first levels between the workers
+    ThreadPool pool(numThreads);
+    vector<vector<unsigned>> prefixes(1);
+    size_t prefixDepth = 0;
+    while (prefixDepth < depth && prefixes.size() < 4 * pool.size()) {
+        vector<vector<unsigned>> longer;
+        for (const vector<unsigned> &prefix : prefixes) {
+            for (unsigned c = levels[prefixDepth]; c < levels[prefixDepth + 1]; c++) {
+                bool fits = true;
+                for (unsigned p : prefix) fits = fits && (compatible[p * words + c / 64] >> (c % 64) & 1);
+                if (!fits) continue;
+                longer.push_back(prefix);
+                longer.back().push_back(c);
+            }
+        }
+        prefixes.swap(longer);
+        prefixDepth++;
+    }
+
+    vector<Found> merged;
+    mutex mergedMutex;
+    for (const vector<unsigned> &prefix : prefixes) {
+        pool.submit([this, &prefix, &merged, &mergedMutex, depth, prefixDepth] {
+            Search state;
+            state.allowed.assign((depth + 1) * words, ~uint64_t(0));
+            state.days.assign((depth + 1) * DAYS, 0);
+            state.freeSeats.assign(depth + 1, INT_MAX);
+            state.chosen.assign(depth, 0);
+            state.nodes = 0;
+            copy(keptDays, keptDays + DAYS, state.days.begin());
+            for (size_t level = 0; level < prefixDepth; level++) {
+                unsigned c = prefix[level];
+                for (size_t i = 0; i < words; i++) {
+                    state.allowed[(level + 1) * words + i] = state.allowed[level * words + i] & compatible[c * words + i];
+                }
+                for (int day = 0; day < DAYS; day++) {
+                    state.days[(level + 1) * DAYS + day] = state.days[level * DAYS + day] | candidates[c].days[day];
+                }
+                state.freeSeats[level + 1] = min(state.freeSeats[level], candidates[c].freeSeats);
+                state.chosen[level] = c;
+            }
+            search(state, prefixDepth);
+            nodes.fetch_add(state.nodes, memory_order_relaxed);
+            lock_guard<mutex> lock(mergedMutex);
+            merged.insert(merged.end(), state.best.begin(), state.best.end());
+        });
+    }
+    pool.wait();
+
+    sort(merged.begin(), merged.end(), [this](const Found &a, const Found &b) { return better(a, b); });
+    if (merged.size() > maxResults) merged.resize(maxResults);
+    for (const Found &combination : merged) {
+        Timetable timetable{vector<UcClass>(desired.size()), combination.freeSeats, combination.gaps * 0.5f};
+        for (size_t level = 0; level < depth; level++) {
+            timetable.classes[ucOfLevel[level]] = schedules[candidates[combination.chosen[level]].schedule].getUcClass();
+        }
+        results.push_back(timetable);
+    }
+    if (stopped) STATS_COUNT("timetable.stopped");
+    return true;
+}
+
+/**
+ * @brief Best timetables found by the last build(), best first
+ * @details Time complexity: O(1)
+ */
+const vector<TimetableBuilder::Timetable> &TimetableBuilder::getResults() const {
+    return results;
+}
+
+/**
+ * @brief Checks if the last search tried every combination (it stops after maxNodes nodes)
+ * @details Time complexity: O(1)
+ */
+bool TimetableBuilder::isExhaustive() const {
+    return !stopped;
+}
+
+/**
+ * @brief Number of nodes visited by the last search
+ * @details Time complexity: O(1)
+ */
+size_t TimetableBuilder::getNumberOfNodes() const {
+    return nodes;
+}
+
+/**
+ * @brief Prints the timetables found by the last build()
+ * @details Time complexity: O(k * u) where k is the number of results and u the number of desired UCs
+ */
+void TimetableBuilder::printResults(ostream &out) const {
+    if (results.empty()) {
+        out << ">> There is no timetable without collisions and within the cap for these UCs." << endl;
+        return;
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+        const Timetable &timetable = results[i];
+        out << ">> Timetable " << i + 1 << ": " << timetable.freeSeats << " seats left in the fullest class, "
+            << timetable.gapHours << " hours of gaps" << endl << "   ";
+        for (size_t j = 0; j < timetable.classes.size(); j++) {
+            if (j > 0) out << "  |  ";
+            out << timetable.classes[j].getUcId() << " " << timetable.classes[j].getClassId();
+        }
+        out << endl;
+    }
+    if (!isExhaustive()) out << ">> The search stopped after " << getNumberOfNodes() << " combinations, better timetables may exist." << endl;
+}
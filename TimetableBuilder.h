@@ -0,0 +1,106 @@
+#ifndef TRABALHO_TIMETABLEBUILDER_H
+#define TRABALHO_TIMETABLEBUILDER_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include "ScheduleManager.h"
+
+/**
+ * @brief Finds the best combinations of classes (one per desired UC) that a student can have without collisions
+ * @details The classes the student keeps (of the UCs that are not desired) stay fixed. A class is a candidate if it
+ * doesn't collide with a kept class and has a seat left under the cap used by ScheduleManager::requestExceedsCap().
+ * The candidates are numbered by UC (the UCs with fewer candidates first), and each one has a bitmask of the
+ * candidates it doesn't collide with (from the OverlapMatrix), so the depth-first search only has to AND bitmasks to
+ * know the classes still available and backtracks as soon as a later UC has none left.
+ * The best timetables have the most seats left in their fullest class and, between those, the fewest hours of gaps
+ * between classes in the same day. The first levels of the search are split between the workers of a pool.
+ */
+class TimetableBuilder {
+    public:
+        /** @brief Combination of classes found */
+        struct Timetable {
+            /** @brief One class per desired UC, in the order the UCs were given */
+            vector<UcClass> classes;
+            /** @brief Seats left in the fullest class of the combination */
+            int freeSeats;
+            /** @brief Idle time between classes in the same day (including the kept classes), in hours */
+            float gapHours;
+        };
+
+        explicit TimetableBuilder(const ScheduleManager &manager, size_t maxResults = 5, size_t maxNodes = 2000000);
+
+        bool build(const Student &student, const vector<string> &ucIds, ostream &out = cout, unsigned numThreads = 0);
+        const vector<Timetable> &getResults() const;
+        bool isExhaustive() const;
+        size_t getNumberOfNodes() const;
+        void printResults(ostream &out = cout) const;
+
+    private:
+        static const int DAYS = 7;
+
+        /** @brief Class that can be chosen for a desired UC */
+        struct Candidate {
+            /** @brief Index of the class in ScheduleManager::getSchedules() */
+            unsigned long schedule;
+            /** @brief Seats left if the student is in the class */
+            int freeSeats;
+            /** @brief Half hours of each day taken by the class */
+            uint64_t days[DAYS];
+        };
+
+        /** @brief Combination found by the search, with the candidate chosen at each level */
+        struct Found {
+            vector<unsigned> chosen;
+            int freeSeats;
+            int gaps;
+        };
+
+        struct Search;
+
+        static void addSlots(const ClassSchedule &schedule, uint64_t *days);
+        bool better(const Found &a, const Found &b) const;
+        void search(Search &state, size_t level) const;
+        void found(Search &state) const;
+        void raiseThreshold(long long minimum) const;
+        static long long score(int freeSeats, int gaps);
+        static int gapsOf(uint64_t day);
+
+        /** @brief ScheduleManager whose classes are combined */
+        const ScheduleManager &manager;
+        /** @brief Number of timetables kept */
+        size_t maxResults;
+        /** @brief Nodes of the search after which it stops */
+        size_t maxNodes;
+
+        /** @brief Candidates, grouped by level (levels[l] to levels[l + 1]) and by most seats left in each level */
+        vector<Candidate> candidates;
+        /** @brief First candidate of each level, with one more element for the end */
+        vector<unsigned> levels;
+        /** @brief Position in the desired UCs of the UC of each level */
+        vector<size_t> ucOfLevel;
+        /** @brief words bits per candidate: bit j is set if candidates j and i don't collide */
+        vector<uint64_t> compatible;
+        /** @brief words bits per day: bit i is set if candidate i has a class that day */
+        vector<uint64_t> dayCandidates;
+        /** @brief DAYS masks per level: half hours taken by any candidate of that level or of a later one */
+        vector<uint64_t> laterDays;
+        /** @brief Number of 64 bit words of a bitmask of candidates */
+        size_t words;
+        /** @brief Half hours of each day taken by the kept classes */
+        uint64_t keptDays[DAYS];
+
+        /** @brief Smallest score (@see score()) that can still enter the results */
+        mutable atomic<long long> threshold;
+        /** @brief Nodes visited by every worker */
+        mutable atomic<size_t> nodes;
+        /** @brief Set when maxNodes is reached */
+        mutable atomic<bool> stopped;
+
+        /** @brief Best timetables, best first */
+        vector<Timetable> results;
+};
+
+#endif //TRABALHO_TIMETABLEBUILDER_H
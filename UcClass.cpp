@@ -1,28 +1,53 @@
-#include <map>
 #include "UcClass.h"
+#include "Catalog.h"
+#include <functional>
 
 /** @brief Standard constructor of the UcClass class. ucId and classId are set to empty strings
  * @details Time complexity: O(1)
  */
 UcClass::UcClass() {
-    this->ucId = "";
-    this->classId = "";
+    static const string *empty = Catalog::shared().intern("");
+    this->ucId = empty;
+    this->classId = empty;
 }
 
 /**
  * @brief Constructor of the UcClass class. ucId and classId are set to the given values
- * @details Time complexity: O(1)
+ * @details Both codes are interned in the Catalog.\n
+ * Time complexity: O(k) expected, where k is the length of the codes
  * @param ucId Id of the UC
  * @param classId Id of the class
  */
 UcClass::UcClass(const string &ucId, const string &classId) {
-    this->ucId = ucId;
-    this->classId = classId;
+    Catalog &catalog = Catalog::shared();
+    this->ucId = catalog.intern(ucId);
+    this->classId = catalog.intern(classId);
+}
+
+/**
+ * @brief Finds the UcClass with the given codes without interning them
+ * @details A code that was never interned is not in any dataset, so the result is the empty UcClass, which no
+ * schedule has and every search reports as not found.\n
+ * Time complexity: O(k) expected, where k is the length of the codes
+ * @param ucId Id of the UC
+ * @param classId Id of the class
+ * @return the UcClass, or the empty UcClass if one of the codes is unknown
+ */
+UcClass UcClass::lookup(const string &ucId, const string &classId) {
+    Catalog &catalog = Catalog::shared();
+    UcClass ucClass;
+    const string *foundUc = catalog.find(ucId), *foundClass = catalog.find(classId);
+    if (foundUc != nullptr && foundClass != nullptr) {
+        ucClass.ucId = foundUc;
+        ucClass.classId = foundClass;
+    }
+    return ucClass;
 }
 
 /**
  * @brief Checks if two classes have the same UcId
- * @details Time complexity: O(1)
+ * @details The codes are interned, so only the pointers are compared.\n
+ * Time complexity: O(1)
  * @param other Class to compare
  * @return true if they have the same UcId, false otherwise
  */
@@ -35,16 +60,25 @@ bool UcClass::sameUcId(const UcClass &other) const {
  * @details Time complexity: O(1)
  * @return The UcId of the UcClass
  */
-string UcClass::getUcId() const {
-    return ucId;
+const string &UcClass::getUcId() const {
+    return *ucId;
 }
 /**
  * @brief Returns the classId of the class
  * @details Time complexity: O(1)
  * @return classId
  */
-string UcClass::getClassId() const {
-    return classId;
+const string &UcClass::getClassId() const {
+    return *classId;
+}
+
+/**
+ * @brief Returns the abbreviation of the UC
+ * @details Time complexity: O(k) expected, where k is the length of the UcId
+ * @see Catalog::ucName()
+ */
+string UcClass::ucIdToString() const {
+    return Catalog::shared().ucName(*ucId);
 }
 
 /**
@@ -63,8 +97,8 @@ bool UcClass::operator == (const UcClass &other) const {
  * @return true if it is less than, false otherwise
  */
 bool UcClass::operator < (const UcClass &other) const {
-    if(this->ucId == other.ucId) return this->classId < other.classId;
-    return this->ucId < other.ucId;
+    if(this->ucId == other.ucId) return *this->classId < *other.classId;
+    return *this->ucId < *other.ucId;
 }
 /**
  * @brief Checks if a UcId is greater than another. If they have the same UcId, it compares the ClassId.
@@ -73,6 +107,14 @@ bool UcClass::operator < (const UcClass &other) const {
  * @return true if it is greater than, false otherwise
  */
 bool UcClass::operator > (const UcClass &other) const {
-    if(this->ucId == other.ucId) return this->classId > other.classId;
-    return this->ucId > other.ucId;
+    if(this->ucId == other.ucId) return *this->classId > *other.classId;
+    return *this->ucId > *other.ucId;
+}
+
+/**
+ * @brief Hashes the addresses of the interned codes
+ * @details Time complexity: O(1)
+ */
+size_t UcClassHash::operator()(const UcClass &ucClass) const {
+    return hash<const void*>()(&ucClass.getUcId()) * 31 + hash<const void*>()(&ucClass.getClassId());
 }
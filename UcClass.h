@@ -7,24 +7,33 @@ using namespace std;
 
 /**
  * @brief Class to store the information about a given class in a UC
+ * @details The codes are interned in the Catalog, so a UcClass is two pointers and comparing two codes for equality
+ * compares the pointers. The constructor interns the codes, so it is used for the codes read from the files; the codes
+ * given by users go through lookup(), which doesn't add them.
  */
 class UcClass{
     public:
         UcClass();
         UcClass(const string &ucId, const string &classId);
+        static UcClass lookup(const string &ucId, const string &classId);
         bool sameUcId(const UcClass &other) const;
-        string getUcId() const;
-        string getClassId() const;
+        const string &getUcId() const;
+        const string &getClassId() const;
         string ucIdToString() const;
         bool operator ==(const UcClass &other) const;
         bool operator < (const UcClass &other) const;
         bool operator > (const UcClass &other) const;
 
     private:
-        /** @brief Id of the UC */
-        string ucId;
-        /** @brief Id of the class */
-        string classId;
+        /** @brief Id of the UC, interned in the Catalog */
+        const string *ucId;
+        /** @brief Id of the class, interned in the Catalog */
+        const string *classId;
+};
+
+/** @brief Hash of a UcClass, its codes are interned so their addresses identify them */
+struct UcClassHash {
+    size_t operator()(const UcClass &ucClass) const;
 };
 
 #endif //TRABALHO_UCCLASS_H
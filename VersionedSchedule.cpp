@@ -0,0 +1,244 @@
+#include "VersionedSchedule.h"
+#include "Stats.h"
+#include <sstream>
+#include <chrono>
+
+atomic<unsigned long> VersionedSchedule::nextId(1);
+
+/**
+ * @brief Constructor, publishes the initial state as version 1
+ * @details Time complexity: O(s) where s is the size of the state (it is copied once for the staging area)
+ * @param initial ScheduleManager with the files already read
+ */
+VersionedSchedule::VersionedSchedule(const ScheduleManager &initial) : id(nextId++), working(initial) {
+    this->published = make_shared<const ScheduleManager>(initial);
+    this->version = 1;
+    this->autoProcess = false;
+    this->invalid = 0;
+    this->drainerIdle = false;
+    this->stopping = false;
+}
+
+/**
+ * @brief Constructor, takes the state as the staging area and publishes a copy of it as version 1
+ * @details The structures built while reading the files (in the Arena) are moved into the staging area instead of
+ * being copied, so only the published version is a copy.\n
+ * Time complexity: O(s) where s is the size of the state (it is copied once for the published version)
+ * @param initial ScheduleManager with the files already read, it is left empty
+ */
+VersionedSchedule::VersionedSchedule(ScheduleManager &&initial) : id(nextId++), working(move(initial)) {
+    this->published = make_shared<const ScheduleManager>(working);
+    this->version = 1;
+    this->autoProcess = false;
+    this->invalid = 0;
+    this->drainerIdle = false;
+    this->stopping = false;
+}
+
+/**
+ * @brief Destructor, stops the drainer after it drains the requests that are left in the intake
+ * @details Time complexity: the time of the batch being drained
+ */
+VersionedSchedule::~VersionedSchedule() {
+    if(!drainer.joinable()) return;
+    {
+        lock_guard<mutex> lock(drainerMutex);
+        stopping = true;
+    }
+    wakeDrainer.notify_one();
+    drainer.join();
+}
+
+/**
+ * @brief Returns the last published version
+ * @details Each thread remembers the snapshot it got last time and only reloads the shared pointer when the version
+ * number changed, so the common case is an atomic load of an integer and the lock of a weak pointer. The cache is
+ * keyed on the id of the object, which is never reused, and only holds a weak pointer, so a thread that stays idle
+ * doesn't keep an old version (or the version of a destroyed object) alive.\n
+ * Time complexity: O(1)
+ * @return immutable snapshot, it stays valid while the caller holds it
+ */
+shared_ptr<const ScheduleManager> VersionedSchedule::current() const {
+    struct Cache {
+        unsigned long owner = 0;
+        unsigned long version = 0;
+        weak_ptr<const ScheduleManager> snapshot;
+    };
+    thread_local Cache cache;
+    unsigned long latest = version.load(memory_order_acquire);
+    if(cache.owner == id && cache.version == latest){
+        shared_ptr<const ScheduleManager> snapshot = cache.snapshot.lock();
+        if(snapshot) return snapshot;
+    }
+    shared_ptr<const ScheduleManager> snapshot = atomic_load(&published);
+    cache.snapshot = snapshot;
+    cache.owner = id;
+    cache.version = latest;
+    return snapshot;
+}
+
+/**
+ * @brief Returns the number of the last published version
+ * @details Time complexity: O(1)
+ */
+unsigned long VersionedSchedule::getVersion() const {
+    return version.load(memory_order_acquire);
+}
+
+/**
+ * @brief Locks the writer path, staging() and publish() must only be called while holding the returned lock
+ * @details Time complexity: O(1)
+ */
+unique_lock<mutex> VersionedSchedule::lockWriter() {
+    return unique_lock<mutex>(writerMutex);
+}
+
+/**
+ * @brief Returns the staging copy, that is not visible to the readers until publish() is called
+ * @details Time complexity: O(1)
+ */
+ScheduleManager &VersionedSchedule::staging() {
+    return working;
+}
+
+/**
+ * @brief Publishes a copy of the staging area as the new version
+ * @details The copy is made by the writer before the atomic store, readers keep using the previous version meanwhile.
+ * Only what a batch can change is copied: the students, their index and the schedules with their rosters and slots.
+ * The ScheduleIndex, the overlaps and the SessionIndex are shared between the versions (@see ScheduleManager), so the
+ * O(n^2) overlaps are never copied. Each call is a full copy of the students, so the callers publish once per batch
+ * (a PROCESS, a delta, a rebalance or a batch drained from the intake), never once per request.
+ * The rejected requests of the staging area were already reported by the batch that rejected them, so they are
+ * cleared before the copy: otherwise they would pile up with every batch (with autoProcess nobody reads them) and be
+ * copied again each time.
+ * The previous version is freed when its last reader drops it. With persistTo() the new version is also handed to the
+ * Persister, which writes it without blocking the writer.\n
+ * Time complexity: O(s + p) where s is the number of students and p the number of enrollments
+ */
+void VersionedSchedule::publish() {
+    STATS_TIMER("versions.publish");
+    working.clearRejectedRequests();
+    shared_ptr<const ScheduleManager> next = make_shared<const ScheduleManager>(working);
+    atomic_store(&published, next);
+    version.fetch_add(1, memory_order_release);
+    if(persister) persister->save(shared_ptr<const StudentSet>(next, &next->getStudents()));
+}
+
+/**
+ * @brief Saves every version published from now on to a file, in the background
+ * @details The published versions are immutable, so the Persister writes the students of the version itself without
+ * copying them. Must be called before the versions are shared with other threads.\n
+ * Time complexity: O(1)
+ * @param path file where the students are saved (students_classes.csv of the data directory)
+ */
+void VersionedSchedule::persistTo(const string &path) {
+    persister.reset(new Persister(path));
+}
+
+/**
+ * @brief Waits until the last published version is on disk
+ * @details Time complexity: the time of the writes in progress
+ * @return false if the versions are not saved or the last write failed
+ */
+bool VersionedSchedule::flush() {
+    return persister && persister->flush();
+}
+
+/**
+ * @brief Creates the intake and starts the thread that drains it. Must be called before the versions are shared with
+ * other threads
+ * @details Time complexity: O(c) where c is the capacity
+ * @param capacity maximum number of requests waiting to be drained, submit() fails when they are exceeded
+ * @param autoProcess if true, each batch drained is processed and published at once instead of waiting for a PROCESS
+ */
+void VersionedSchedule::startIntake(size_t capacity, bool autoProcess) {
+    if(intake) return;
+    this->intake.reset(new RequestIntake(capacity));
+    this->autoProcess = autoProcess;
+    this->drainer = thread(&VersionedSchedule::drainerLoop, this);
+}
+
+/**
+ * @brief Checks if the requests are submitted through the intake
+ * @details Time complexity: O(1)
+ */
+bool VersionedSchedule::hasIntake() const {
+    return intake != nullptr;
+}
+
+/**
+ * @brief Submits a request from any thread, without taking the writer lock
+ * @details The request is only checked when it is drained, against the state of the staging copy at that time.
+ * The drainer is only woken up if it is sleeping, so under load a submission doesn't make any system call.\n
+ * Time complexity: O(1), lock-free
+ * @return false if the intake is full (backpressure: the request is not queued and should be submitted again later)
+ */
+bool VersionedSchedule::submit(RequestIntake::Submission submission) {
+    STATS_COUNT("intake.submit");
+    if(!intake->submit(move(submission))) return false;
+    if(drainerIdle.load(memory_order_relaxed) && drainerIdle.exchange(false)) wakeDrainer.notify_one();
+    return true;
+}
+
+/**
+ * @brief Moves the requests of the intake to the queues of the staging copy, the caller must hold the writer lock
+ * @details The writer lock makes the caller the only consumer of the intake. The requests that are no longer valid
+ * (e.g. the student was removed from the uc since) are dropped and counted.\n
+ * Time complexity: O(k log n) where k is the number of requests drained and n the number of schedules
+ * @return number of requests queued
+ */
+size_t VersionedSchedule::drainIntake() {
+    if(!intake) return 0;
+    STATS_TIMER("intake.drain");
+    ostringstream reasons;
+    RequestIntake::Submission submission;
+    size_t queued = 0;
+    while(intake->take(submission)){
+        if(working.submitRequest(submission.type, submission.studentId, submission.ucCode, submission.classCode, reasons)) queued++;
+        else invalid++;
+        reasons.str("");
+    }
+    return queued;
+}
+
+/**
+ * @brief Prints the state of the intake: requests waiting, capacity and counters
+ * @details Time complexity: O(1)
+ */
+void VersionedSchedule::printIntake(ostream &out) const {
+    if(!intake){
+        out << ">> The requests are not submitted through an intake (start the server with --intake)." << endl;
+        return;
+    }
+    out << ">> Intake: " << intake->size() << " waiting of " << intake->getCapacity() << ", "
+        << intake->getNumberOfSubmitted() << " submitted, " << intake->getNumberOfRefused() << " refused (full), "
+        << invalid << " invalid when drained" << (autoProcess ? ", processed automatically" : "") << endl;
+}
+
+/**
+ * @brief Loop of the drainer: sleeps until there are requests, then drains them in a batch with the writer lock
+ * @details The thread marks itself idle before sleeping so that the next submitter wakes it up. A wake up can be lost
+ * between the check and the wait, so the sleep is also bounded to 10 ms. With autoProcess the batch is processed and
+ * published while the lock is held, the requests submitted meanwhile form the next batch.
+ */
+void VersionedSchedule::drainerLoop() {
+    while(true){
+        {
+            unique_lock<mutex> lock(drainerMutex);
+            drainerIdle = true;
+            wakeDrainer.wait_for(lock, chrono::milliseconds(10), [this] { return stopping || intake->size() > 0; });
+            drainerIdle = false;
+        }
+        bool last = stopping;
+        if(intake->size() > 0){
+            unique_lock<mutex> writer = lockWriter();
+            if(drainIntake() > 0 && autoProcess){
+                STATS_TIMER("intake.process");
+                ostringstream discarded;
+                working.processRequests(discarded);
+                publish();
+            }
+        }
+        if(last) return;
+    }
+}
@@ -0,0 +1,80 @@
+#ifndef TRABALHO_VERSIONEDSCHEDULE_H
+#define TRABALHO_VERSIONEDSCHEDULE_H
+
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include "ScheduleManager.h"
+#include "Persister.h"
+#include "RequestIntake.h"
+
+/**
+ * @brief Publishes immutable versions of a ScheduleManager so that readers never see a batch half applied.
+ * @details The writer works on a private staging copy (submissions and processRequests) and, when a batch is finished,
+ * publishes a new immutable version with a single atomic store. Readers keep using the version they got until they
+ * ask again, so they never wait for the writer.
+ * With startIntake() the requests can also be submitted without the writer lock: they go to a lock-free RequestIntake
+ * and a background thread drains them into the queues of the staging copy (and, with autoProcess, processes and
+ * publishes them), so many submitters never wait for each other or for a batch being processed.
+ */
+class VersionedSchedule {
+    public:
+        explicit VersionedSchedule(const ScheduleManager &initial);
+        explicit VersionedSchedule(ScheduleManager &&initial);
+        ~VersionedSchedule();
+        VersionedSchedule(const VersionedSchedule &other) = delete;
+        VersionedSchedule &operator = (const VersionedSchedule &other) = delete;
+
+        shared_ptr<const ScheduleManager> current() const;
+        unsigned long getVersion() const;
+
+        unique_lock<mutex> lockWriter();
+        ScheduleManager &staging();
+        void publish();
+        void persistTo(const string &path);
+        bool flush();
+
+        void startIntake(size_t capacity, bool autoProcess = false);
+        bool hasIntake() const;
+        bool submit(RequestIntake::Submission submission);
+        size_t drainIntake();
+        void printIntake(ostream &out = cout) const;
+
+    private:
+        void drainerLoop();
+
+        /** @brief Source of the ids, never reused so a cached snapshot can't be mistaken for one of another object */
+        static atomic<unsigned long> nextId;
+        /** @brief Identifies this object in the per thread cache of current() */
+        const unsigned long id;
+        /** @brief Last published version, only accessed with atomic_load / atomic_store */
+        shared_ptr<const ScheduleManager> published;
+        /** @brief Number of the last published version, readers check it before reloading the pointer */
+        atomic<unsigned long> version;
+        /** @brief Copy of the state that is modified by the writer */
+        ScheduleManager working;
+        /** @brief Serializes the writers */
+        mutex writerMutex;
+        /** @brief Saves each published version in the background (null if the versions are not saved) */
+        unique_ptr<Persister> persister;
+        /** @brief Requests submitted without the writer lock (null if startIntake() wasn't called) */
+        unique_ptr<RequestIntake> intake;
+        /** @brief True if the drainer processes and publishes the requests it drains */
+        bool autoProcess;
+        /** @brief Number of requests drained that were not valid anymore */
+        atomic<unsigned long> invalid;
+        /** @brief True while the drainer sleeps, a submitter that finds it set wakes the drainer up */
+        atomic<bool> drainerIdle;
+        /** @brief Set by the destructor, the drainer drains what is left and exits */
+        atomic<bool> stopping;
+        /** @brief Used by the drainer to sleep */
+        mutex drainerMutex;
+        /** @brief Signals the drainer that there are requests to drain (or that it must stop) */
+        condition_variable wakeDrainer;
+        /** @brief Thread that drains the intake */
+        thread drainer;
+};
+
+#endif //TRABALHO_VERSIONEDSCHEDULE_H
@@ -0,0 +1,91 @@
+#include "WeekMask.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+const int WeekMask::DAYS;
+const int WeekMask::WORDS;
+const int WeekMask::BUCKETS_PER_DAY;
+
+/**
+ * @brief Constructor, creates an empty week
+ * @details Time complexity: O(1)
+ */
+WeekMask::WeekMask() {
+    clear();
+}
+
+/**
+ * @brief Frees every half hour
+ * @details Time complexity: O(1)
+ */
+void WeekMask::clear() {
+    for (int w = 0; w < WORDS; w++) days[w] = 0;
+}
+
+/**
+ * @brief Takes the half hours of a slot, a half hour is taken if the slot is in session during any part of it
+ * @details Slots of an unknown weekday are ignored. Time complexity: O(1)
+ */
+void WeekMask::addSlot(const Slot &slot) {
+    int day = slot.getWeekDayIndex();
+    if (day < 0) return;
+    days[day] |= hoursMask(slot.getStartTime(), slot.getEndTime());
+}
+
+/**
+ * @brief Checks if no half hour is taken
+ * @details Time complexity: O(1)
+ */
+bool WeekMask::isEmpty() const {
+    uint64_t any = 0;
+    for (int w = 0; w < WORDS; w++) any |= days[w];
+    return any == 0;
+}
+
+/**
+ * @brief Half hour of the day in which a period that starts at the given hour begins, clamped to the day
+ * @details Time complexity: O(1)
+ */
+int WeekMask::firstBucket(float start) {
+    return max(0, (int) floor(start * 2));
+}
+
+/**
+ * @brief Half hour of the day after the last one met by a period that ends at the given hour, clamped to the day
+ * @details Time complexity: O(1)
+ */
+int WeekMask::endBucket(float end) {
+    return min(BUCKETS_PER_DAY, (int) ceil(end * 2));
+}
+
+/**
+ * @brief Bits of the half hours of a day that meet the period [start, end)
+ * @details Time complexity: O(1)
+ * @param start,end hours, clamped to the day
+ */
+uint64_t WeekMask::hoursMask(float start, float end) {
+    int begin = firstBucket(start), last = endBucket(end);
+    if (begin >= last) return 0;
+    return ((uint64_t(1) << (last - begin)) - 1) << begin;
+}
+
+/**
+ * @brief Time at which a half hour of the day starts, as hh:mm
+ * @details Time complexity: O(1)
+ */
+string WeekMask::bucketToHours(int bucket) {
+    string hours = to_string(bucket / 2);
+    if (hours.size() < 2) hours = "0" + hours;
+    return hours + (bucket % 2 ? ":30" : ":00");
+}
+
+/**
+ * @brief Name of a weekday (Monday is 0)
+ * @details Time complexity: O(1)
+ */
+const char *WeekMask::dayName(int day) {
+    static const char *names[DAYS] = {"Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday", "Sunday"};
+    return names[day];
+}
@@ -0,0 +1,52 @@
+#ifndef TRABALHO_WEEKMASK_H
+#define TRABALHO_WEEKMASK_H
+
+#include <cstdint>
+#include <string>
+#include "Slot.h"
+
+/**
+ * @brief Bitmap of the half hours of a week: bit b of word d is set if the half hour starting at b/2 hours of
+ * weekday d (Monday is 0) is taken
+ * @details The week is padded to 8 words, so combining two masks is a fixed loop of 8 independent ORs or ANDs that
+ * the compiler turns into a couple of vector instructions.
+ */
+struct WeekMask {
+    static const int DAYS = 7;
+    static const int WORDS = 8;
+    static const int BUCKETS_PER_DAY = 48;
+
+    uint64_t days[WORDS];
+
+    WeekMask();
+
+    void clear();
+    void addSlot(const Slot &slot);
+    bool isEmpty() const;
+
+    /**
+     * @brief Adds the half hours taken in another mask
+     * @details Time complexity: O(1)
+     */
+    WeekMask &operator |= (const WeekMask &other) {
+        for (int w = 0; w < WORDS; w++) days[w] |= other.days[w];
+        return *this;
+    }
+
+    /**
+     * @brief Keeps only the half hours also taken in another mask
+     * @details Time complexity: O(1)
+     */
+    WeekMask &operator &= (const WeekMask &other) {
+        for (int w = 0; w < WORDS; w++) days[w] &= other.days[w];
+        return *this;
+    }
+
+    static int firstBucket(float start);
+    static int endBucket(float end);
+    static uint64_t hoursMask(float start, float end);
+    static string bucketToHours(int bucket);
+    static const char *dayName(int day);
+};
+
+#endif //TRABALHO_WEEKMASK_H
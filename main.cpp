@@ -1,12 +1,111 @@
 #include "ScheduleManager.h"
 #include "App.h"
+#include "Server.h"
+#include "DatasetRegistry.h"
+#include "Stats.h"
+#include "RequestTrace.h"
+#include <memory>
+#include <csignal>
 
 using namespace std;
 
-int main()
+/** @brief Server stopped by SIGINT and SIGTERM (null when no server is running) */
+static Server *runningServer = nullptr;
+
+/**
+ * @brief Signal handler, asks the server to stop so that the datasets are saved before exiting
+ */
+static void stopServer(int) {
+    if(runningServer != nullptr) runningServer->stop();
+}
+
+/**
+ * @brief Without arguments runs the interactive application.
+ * With --serve [socket] [--threads n] loads the files and serves the queries on a Unix domain socket.
+ * With --dataset name=dir (repeatable) the server hosts several named datasets, each read from its own directory.
+ * With --stats-file path [--stats-interval seconds] the statistics are periodically written to a file.
+ * With --trace path the submitted requests are recorded in a trace that can be replayed with the replay tool.
+ * With --persist the server saves every published version to the students_classes.csv of its dataset in the
+ * background, and waits for the last one to be saved when it is stopped (SIGINT or SIGTERM).
+ * With --intake [capacity] the requests are submitted to a lock-free intake of each dataset, drained in the background,
+ * and with --auto-process every batch drained is also processed and published.
+ */
+int main(int argc, char **argv)
 {
-    system("clear");
+    string socketPath, statsFile, tracePath;
+    vector<pair<string, string>> datasets;
+    unsigned threads = 0, statsInterval = 10, intakeCapacity = 0;
+    bool serve = false, persist = false, autoProcess = false;
+    for(int i = 1; i < argc; i++){
+        string option = argv[i];
+        if(option == "--serve"){
+            serve = true;
+            socketPath = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "/tmp/trabalho.sock";
+        }
+        else if(option == "--threads" && i + 1 < argc) threads = stoi(argv[++i]);
+        else if(option == "--persist") persist = true;
+        else if(option == "--intake") intakeCapacity = (i + 1 < argc && argv[i + 1][0] != '-') ? stoi(argv[++i]) : 4096;
+        else if(option == "--auto-process") autoProcess = true;
+        else if(option == "--stats-file" && i + 1 < argc) statsFile = argv[++i];
+        else if(option == "--stats-interval" && i + 1 < argc) statsInterval = stoi(argv[++i]);
+        else if(option == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if(option == "--dataset" && i + 1 < argc && string(argv[i + 1]).find('=') != string::npos){
+            string dataset = argv[++i];
+            size_t equals = dataset.find('=');
+            string dir = dataset.substr(equals + 1);
+            if(!dir.empty() && dir[dir.size() - 1] != '/') dir += '/';
+            datasets.emplace_back(dataset.substr(0, equals), dir);
+        }
+        else {
+            cerr << "Usage: " << argv[0] << " [--serve [socket]] [--threads n] [--dataset name=dir]... [--stats-file path] [--stats-interval seconds] [--trace path] [--persist] [--intake [capacity]] [--auto-process]" << endl;
+            return 1;
+        }
+    }
+    unique_ptr<PeriodicStatsDump> statsDump;
+    if(!statsFile.empty()) statsDump.reset(new PeriodicStatsDump(statsFile, statsInterval));
+
+    if(serve){
+        if(datasets.empty()) datasets.emplace_back("default", "../data/");
+        DatasetRegistry registry(threads);
+        for(const pair<string, string> &dataset : datasets){
+            shared_ptr<RequestTrace> trace;
+            if(!tracePath.empty()){
+                // with several datasets each one has its own trace, so that it can be replayed on its own files
+                trace = make_shared<RequestTrace>(datasets.size() == 1 ? tracePath : tracePath + "." + dataset.first);
+                if(!trace->isOpen()){
+                    cerr << "Could not create the trace " << tracePath << endl;
+                    return 1;
+                }
+            }
+            if(!registry.add(dataset.first, dataset.second, trace)){
+                cerr << "Could not load the dataset " << dataset.first << " from " << dataset.second << endl;
+                return 1;
+            }
+            if(persist) registry.find(dataset.first)->persistTo(dataset.second + "students_classes.csv");
+            if(intakeCapacity > 0 || autoProcess) registry.find(dataset.first)->startIntake(intakeCapacity > 0 ? intakeCapacity : 4096, autoProcess);
+        }
+        Server server(registry, socketPath);
+        runningServer = &server;
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        int status = server.run();
+        runningServer = nullptr;
+        for(const string &name : registry.getNames()){
+            VersionedSchedule *versions = registry.find(name);
+            if(persist && !versions->flush()) cerr << "Could not save the dataset " << name << endl;
+        }
+        return status;
+    }
     ScheduleManager manager;
+    if(!tracePath.empty()){
+        shared_ptr<RequestTrace> trace = make_shared<RequestTrace>(tracePath);
+        if(!trace->isOpen()){
+            cerr << "Could not create the trace " << tracePath << endl;
+            return 1;
+        }
+        manager.setTrace(trace);
+    }
+    system("clear");
     App app(manager);
     app.run();
     return 0;
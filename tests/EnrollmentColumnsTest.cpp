@@ -0,0 +1,77 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <random>
+#include <cstdio>
+#include "EnrollmentColumns.h"
+
+using namespace std;
+
+/**
+ * @brief Checks that a students_classes.csv survives the trip to a .col file and back byte for byte: the csv of the
+ * data directory and a generated one with long names, gaps between the numbers and students with many classes.\n
+ * Usage: EnrollmentColumnsTest students_classes.csv workDir
+ */
+
+static int failures = 0;
+
+/** @brief Contents of a file, empty if it can't be read */
+static string readFile(const string &path) {
+    ifstream file(path, ios::binary);
+    ostringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+/** @brief Converts the csv to a .col file, loads it back and compares the csv it writes with the original */
+static void checkRoundTrip(const string &csvPath, const string &colPath) {
+    EnrollmentColumns written, loaded;
+    bool ok = written.readCsv(csvPath) && written.save(colPath) && loaded.load(colPath);
+    ostringstream csv;
+    if (ok) loaded.writeCsv(csv);
+    string original = readFile(csvPath);
+    if (!ok || csv.str() != original) {
+        cerr << "FAILED: " << csvPath << (ok ? " changed in the round trip" : " couldn't be converted") << endl;
+        failures++;
+        return;
+    }
+    cout << ">> " << csvPath << ": " << loaded.size() << " students, " << loaded.getNumberOfEnrollments()
+         << " enrollments, " << original.size() << " bytes identical" << endl;
+    remove(colPath.c_str());
+}
+
+/** @brief Writes a csv sorted by number, as the application saves it */
+static void generateCsv(const string &path) {
+    mt19937 rng(11);
+    ofstream file(path, ios::binary);
+    file << "StudentCode,StudentName,UcCode,ClassCode\n";
+    long number = 201900000;
+    for (int s = 0; s < 3000; s++) {
+        number += 1 + rng() % 500;
+        string name = "Student" + to_string(s);
+        if (s % 7 == 0) name += " With A Name Longer Than The Short String Buffer";
+        int classes = 1 + rng() % 7;
+        for (int c = 0; c < classes; c++) {
+            file << number << ',' << name << ",L.EIC0" << 10 + (s + c) % 15 << ',' << 1 + rng() % 3 << "LEIC"
+                 << (rng() % 16 < 9 ? "0" : "") << 1 + rng() % 16 << '\n';
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 3) {
+        cerr << "Usage: " << argv[0] << " students_classes.csv workDir" << endl;
+        return 1;
+    }
+    string workDir = string(argv[2]) + "/";
+    checkRoundTrip(argv[1], workDir + "data_round_trip.col");
+    string generated = workDir + "generated_students_classes.csv";
+    generateCsv(generated);
+    checkRoundTrip(generated, workDir + "generated_round_trip.col");
+    remove(generated.c_str());
+
+    if (failures > 0) return 1;
+    cout << ">> EnrollmentColumns checks passed" << endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include "RequestIntake.h"
+
+using namespace std;
+
+/**
+ * @brief Checks the RequestIntake: a full ring refuses at once and accepts again after a take, and with many producers
+ * submitting while the consumer takes, every request arrives exactly once and in the order of its producer.\n
+ * Usage: RequestIntakeTest [producers] [requests per producer]
+ */
+
+static int failures = 0;
+
+/** @brief Reports a failed check */
+static void check(bool condition, const string &what) {
+    if (condition) return;
+    cerr << "FAILED: " << what << endl;
+    failures++;
+}
+
+/** @brief A full ring refuses the next request without blocking, and a take frees a cell for it */
+static void checkFullRing() {
+    RequestIntake intake(3);
+    check(intake.getCapacity() == 4, "the capacity is rounded up to a power of two");
+    RequestIntake::Submission submission{"Changing", "202020897", "L.EIC001", "1LEIC01"}, taken;
+    for (int i = 0; i < 4; i++) check(intake.submit(submission), "a request is accepted while the ring has room");
+    check(!intake.submit(submission), "a request is refused when the ring is full");
+    check(intake.getNumberOfRefused() == 1 && intake.getNumberOfSubmitted() == 4, "the refusal is counted");
+    check(intake.size() == 4, "the ring holds the accepted requests");
+    check(intake.take(taken) && taken.studentId == "202020897", "the consumer takes the oldest request");
+    check(intake.submit(submission), "a request is accepted again after a take");
+    for (int i = 0; i < 4; i++) check(intake.take(taken), "every accepted request is taken");
+    check(!intake.take(taken), "nothing is taken from an empty ring");
+}
+
+/** @brief Producers submit numbered requests, retrying when refused, while the consumer takes them */
+static void checkContention(int producers, int requests) {
+    RequestIntake intake(64);
+    vector<thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&intake, p, requests]() {
+            for (int i = 0; i < requests; i++) {
+                RequestIntake::Submission submission{"Enrollment", to_string(p), to_string(i), ""};
+                while (!intake.submit(submission)) this_thread::yield();
+            }
+        });
+    }
+    vector<int> last(producers, -1);
+    long received = 0, total = (long) producers * requests;
+    bool ordered = true;
+    RequestIntake::Submission taken;
+    while (received < total) {
+        if (!intake.take(taken)) {
+            this_thread::yield();
+            continue;
+        }
+        int producer = stoi(taken.studentId), number = stoi(taken.ucCode);
+        if (number != last[producer] + 1) ordered = false;
+        last[producer] = number;
+        received++;
+    }
+    for (thread &producer : threads) producer.join();
+    check(ordered, "the requests of each producer arrive in the order they were submitted, without losses or copies");
+    check(!intake.take(taken), "nothing is left after every request was taken");
+    check(intake.getNumberOfSubmitted() == (unsigned long) total, "every request is accepted once");
+    cout << ">> " << total << " requests from " << producers << " producers, " << intake.getNumberOfRefused()
+         << " refusals retried" << endl;
+}
+
+int main(int argc, char **argv) {
+    int producers = argc > 1 ? stoi(argv[1]) : 4;
+    int requests = argc > 2 ? stoi(argv[2]) : 100000;
+    checkFullRing();
+    checkContention(producers, requests);
+    if (failures > 0) return 1;
+    cout << ">> RequestIntake checks passed" << endl;
+    return 0;
+}
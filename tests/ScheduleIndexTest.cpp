@@ -0,0 +1,83 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "ScheduleManager.h"
+#include "ScheduleIndex.h"
+
+using namespace std;
+
+/**
+ * @brief Checks the ScheduleIndex against a linear search of the schedules: every class of the data directory, classes
+ * that don't exist and synthetic schedules with codes longer than 8 characters (which share packed keys).\n
+ * Usage: ScheduleIndexTest dataDir
+ */
+
+static int failures = 0;
+
+/** @brief Position of the class in the schedules, ScheduleIndex::NOT_FOUND if it isn't there */
+static unsigned long linearFind(const UcClass &ucClass, const vector<ClassSchedule> &schedules) {
+    for (size_t i = 0; i < schedules.size(); i++) {
+        if (schedules[i].getUcClass() == ucClass) return i;
+    }
+    return ScheduleIndex::NOT_FOUND;
+}
+
+/** @brief Compares the index with the linear search for every probe */
+static void checkProbes(const string &what, const vector<ClassSchedule> &schedules, const vector<UcClass> &probes) {
+    ScheduleIndex index;
+    index.build(schedules);
+    if (index.size() != schedules.size()) {
+        cerr << "FAILED: " << what << ": the index has " << index.size() << " keys" << endl;
+        failures++;
+    }
+    size_t wrong = 0;
+    for (const UcClass &probe : probes) {
+        if (index.find(probe, schedules) != linearFind(probe, schedules)) {
+            if (wrong++ == 0) cerr << "FAILED: " << what << ": " << probe.getUcId() << ' ' << probe.getClassId() << endl;
+        }
+    }
+    failures += wrong > 0;
+    cout << ">> " << what << ": " << schedules.size() << " schedules, " << probes.size() << " probes, " << wrong
+         << " wrong" << endl;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        cerr << "Usage: " << argv[0] << " dataDir" << endl;
+        return 1;
+    }
+    ScheduleManager manager;
+    manager.readFiles(argv[1]);
+    const vector<ClassSchedule> &schedules = manager.getSchedules();
+    vector<UcClass> probes;
+    for (const ClassSchedule &schedule : schedules) {
+        const UcClass &ucClass = schedule.getUcClass();
+        probes.push_back(ucClass);
+        probes.emplace_back(ucClass.getUcId(), ucClass.getClassId() + "X");
+        probes.emplace_back(ucClass.getUcId() + "9", ucClass.getClassId());
+    }
+    probes.emplace_back();
+    probes.emplace_back("L.EIC999", "1LEIC01");
+    checkProbes("data", schedules, probes);
+
+    // codes that only differ after the 8th character, in a shuffled order
+    mt19937 rng(7);
+    vector<ClassSchedule> synthetic;
+    vector<UcClass> syntheticProbes;
+    for (int uc = 0; uc < 40; uc++) {
+        for (int cls = 0; cls < 25; cls++) {
+            UcClass ucClass("COURSE.UNIT." + to_string(uc), "CLASSGROUP" + to_string(cls));
+            if (rng() % 4 != 0) synthetic.emplace_back(ucClass);
+            syntheticProbes.push_back(ucClass);
+        }
+    }
+    shuffle(synthetic.begin(), synthetic.end(), rng);
+    checkProbes("long codes", synthetic, syntheticProbes);
+    checkProbes("empty", vector<ClassSchedule>(), syntheticProbes);
+
+    if (failures > 0) return 1;
+    cout << ">> ScheduleIndex checks passed" << endl;
+    return 0;
+}
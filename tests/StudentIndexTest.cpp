@@ -0,0 +1,122 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <set>
+#include <random>
+#include "Student.h"
+#include "StudentIndex.h"
+
+using namespace std;
+
+/**
+ * @brief Checks the StudentIndex against a std::set of the ids indexed: inserts, erases and finds, with keys that
+ * collide at the end of the table and wrap around to its start (where the backward shift of erase() must stop and
+ * restart correctly), ids with the same key (leading zeros) and random operations on a table that stays small.\n
+ * Usage: StudentIndexTest [operations]
+ */
+
+static int failures = 0;
+
+/** @brief Reports a failed check */
+static void check(bool condition, const string &what) {
+    if (condition) return;
+    cerr << "FAILED: " << what << endl;
+    failures++;
+}
+
+/** @brief Slot where the search for a key starts in a table of 2^bits slots, the hashing of StudentIndex::home() */
+static size_t homeSlot(uint64_t key, unsigned bits) {
+    return (key * 11400714819323198485ULL) >> (64 - bits);
+}
+
+/** @brief Students indexed and the reference set of their ids */
+struct Fixture {
+    StudentSet students;
+    StudentIndex index;
+    set<string> reference;
+
+    void insert(const string &id) {
+        if (reference.count(id)) return;
+        index.insert(*students.insert(Student(id, "Name " + id)).first);
+        reference.insert(id);
+    }
+
+    void erase(const string &id) {
+        auto it = students.find(Student(id, ""));
+        if (it == students.end()) return;
+        index.erase(*it);
+        students.erase(it);
+        reference.erase(id);
+    }
+
+    /** @brief Every id of the pool is found exactly when it is in the reference */
+    bool agrees(const vector<string> &pool) const {
+        if (index.size() != reference.size()) return false;
+        for (const string &id : pool) {
+            Student *found = index.find(id);
+            if (reference.count(id) ? found == nullptr || found->getId() != id : found != nullptr) return false;
+        }
+        return true;
+    }
+};
+
+/** @brief Keys whose home is one of the last two slots of the initial table of 16, erased from the front of the run */
+static void checkWrappedRun() {
+    vector<string> ids;
+    for (uint64_t key = 202000000; ids.size() < 6; key++) {
+        if (homeSlot(key, 4) >= 14) ids.push_back(to_string(key));
+    }
+    vector<string> pool = ids;
+    pool.push_back("0" + ids[0]); // same key, different id
+    for (size_t first = 0; first < ids.size(); first++) {
+        Fixture fixture;
+        for (const string &id : ids) fixture.insert(id);
+        fixture.insert("0" + ids[0]);
+        check(fixture.agrees(pool), "a run that wraps around the end of the table is found");
+        fixture.erase(ids[first]);
+        check(fixture.agrees(pool), "the run is found after erasing its element " + to_string(first));
+        fixture.erase("0" + ids[0]);
+        fixture.insert(ids[first]);
+        check(fixture.agrees(pool), "an erased key is found again after it is inserted back");
+        for (const string &id : ids) fixture.erase(id);
+        check(fixture.agrees(pool) && fixture.index.size() == 0, "the index is empty after erasing everything");
+    }
+}
+
+/** @brief Random inserts and erases of a few hundred ids, the table grows and shrinks its runs */
+static void checkRandomOperations(int operations) {
+    mt19937 rng(3);
+    vector<string> pool;
+    for (int i = 0; i < 300; i++) pool.push_back(to_string(202000000 + rng() % 100000));
+    Fixture fixture;
+    bool agreed = true;
+    for (int i = 0; i < operations && agreed; i++) {
+        const string &id = pool[rng() % pool.size()];
+        if (rng() % 5 < 3) fixture.insert(id);
+        else fixture.erase(id);
+        if (i % 64 == 0) agreed = fixture.agrees(pool);
+    }
+    check(agreed && fixture.agrees(pool), "random inserts and erases agree with the reference");
+    check(fixture.index.find("not a number") == nullptr && fixture.index.find("") == nullptr,
+          "ids that are not numbers are not found");
+
+    StudentIndex rebuilt;
+    rebuilt.build(fixture.students);
+    vector<const string *> ids;
+    for (const string &id : pool) ids.push_back(&id);
+    vector<Student *> found;
+    rebuilt.findAll(ids, found);
+    bool same = found.size() == pool.size();
+    for (size_t i = 0; same && i < pool.size(); i++) same = found[i] == fixture.index.find(pool[i]);
+    check(same, "a rebuilt index and findAll() agree with find()");
+    cout << ">> " << operations << " random operations, " << fixture.reference.size() << " students left" << endl;
+}
+
+int main(int argc, char **argv) {
+    int operations = argc > 1 ? stoi(argv[1]) : 200000;
+    checkWrappedRun();
+    checkRandomOperations(operations);
+    if (failures > 0) return 1;
+    cout << ">> StudentIndex checks passed" << endl;
+    return 0;
+}